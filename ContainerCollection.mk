@@ -59,7 +59,7 @@ AS       := /usr/bin/as
 ##
 ## User defined environment variables
 ##
-Objects0=$(IntermediateDirectory)/src_test_all.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_main.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_performance_tester.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_test_item.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_container_tester.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_graph.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_test_integrity.cpp$(ObjectSuffix) 
+Objects0=$(IntermediateDirectory)/src_test_all.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_main.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_performance_tester.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_test_item.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_container_tester.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_graph.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_test_integrity.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_new_count.cpp$(ObjectSuffix) 
 
 
 
@@ -142,6 +142,14 @@ $(IntermediateDirectory)/src_test_integrity.cpp$(DependSuffix): src/test_integri
 $(IntermediateDirectory)/src_test_integrity.cpp$(PreprocessSuffix): src/test_integrity.cpp
 	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_test_integrity.cpp$(PreprocessSuffix) "src/test_integrity.cpp"
 
+$(IntermediateDirectory)/src_new_count.cpp$(ObjectSuffix): src/new_count.cpp $(IntermediateDirectory)/src_new_count.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/home/sp2danny/extra/ContainerCollection/src/new_count.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_new_count.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_new_count.cpp$(DependSuffix): src/new_count.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_new_count.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_new_count.cpp$(DependSuffix) -MM "src/new_count.cpp"
+
+$(IntermediateDirectory)/src_new_count.cpp$(PreprocessSuffix): src/new_count.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_new_count.cpp$(PreprocessSuffix) "src/new_count.cpp"
+
 
 -include $(IntermediateDirectory)/*$(DependSuffix)
 ##
@@ -17,7 +17,7 @@
   Free Software Project hosted at:
   http://avl-array.sourceforge.net
 
-  The source code is organized in 28 different header files, of
+  The source code is organized in 30 different header files, of
   which this is the main one. All them have been profusely
   commented. The #include sections at the beginnig and the end of
   this file might serve as an index to the different files.
@@ -40,6 +40,7 @@
 #include <iterator>
 #include <memory>
 #include <utility>
+#include <vector>
 
 //////////////////////////////////////////////////////////////////
 
@@ -98,7 +99,7 @@
                                     // (for internal use only)
 
 #include "detail/empty_number.hpp" // Default W (no NPSV)
-                                   // and P (no stable sort)
+                                   // and P (unused)
 
 #include "detail/exception.hpp" // Exceptions
 
@@ -116,6 +117,9 @@
                                     // guest (T) exceptions
                                     // (for internal use only)
 
+#include "detail/npsv_index.hpp" // Flat (Fenwick tree) index
+                                 // of NPSV widths
+
 // (Other headers, containing avl_array methods implementations
 // are included from the end of this file)
 
@@ -140,6 +144,7 @@ public:
   typedef avl_array_node<T, A, W, P> payload_node_t;
   typedef avl_array<T, A, W, P> my_class;
   typedef rollback_list<T, A, W, P> rollback_list_t;
+  typedef avl_array_batch<T, A, W, P> batch;
 
   typedef typename A::value_type value_type;
   typedef typename A::reference reference;
@@ -157,6 +162,11 @@ public:
   typedef avl_array_rev_iter<T, A, W, P, const_reference, const_pointer>
       const_reverse_iterator;
 
+  typedef avl_array_npsv_cursor<T, A, W, P, iterator> npsv_cursor_t;
+  typedef avl_array_npsv_cursor<T, A, W, P, const_iterator>
+      const_npsv_cursor_t;
+  typedef avl_array_npsv_index<T, A, W, P> npsv_index_t;
+
   typedef typename A::template rebind<payload_node_t>::other allocator_t;
 
 // ---------------------- CONCEPT CHECKS -----------------------
@@ -433,6 +443,7 @@ public:
   // insert_sorted(): insert keeping order* (O(log N))
   // sort(): impose order                          (O(N log N))
   // stable_sort(): idem + keep current order between equals "
+  //                (no per-node storage, P is not required)
   // merge(): mix two containers, keeping order* (O(M+N))
   // unique(): remove duplicates* (O(N))
   // (*) Elements must be previously in order
@@ -484,8 +495,14 @@ public:
   // npsv_set_width(): set an element's width O(log N) or O(1)**
   // npsv_pos_of(): get an element's position O(log N) or O(N)*
   // npsv_at_pos(): get elem. of a position O(log N) or O(N)*
+  // npsv_at_pos_range(): get elems. of sorted positions
+  //                      O(k + log N) or O(N)*
+  // npsv_cursor(): get a cursor for forward seeks O(log N) or O(N)*
   // (*) width sums need to be updated
   // (**) don't update width sums (lazy mode)
+  //
+  // An npsv_index_t object built from an array (see npsv_index.hpp)
+  // keeps a flat copy of the widths for faster position queries
 
   void npsv_update_sums() const;
 
@@ -503,6 +520,23 @@ public:
 
   template <class CMP> const_iterator npsv_at_pos(W pos, CMP cmp) const;
 
+  template <class IT, class OUT>
+  OUT npsv_at_pos_range(IT first_pos, IT last_pos, OUT out);
+  template <class IT, class OUT>
+  OUT npsv_at_pos_range(IT first_pos, IT last_pos, OUT out) const;
+
+  npsv_cursor_t npsv_cursor(W pos = W(0));
+  const_npsv_cursor_t npsv_cursor(W pos = W(0)) const;
+
+  // Transactional batch of inserts/erases
+  // See batch.hpp
+  //
+  // begin_batch(): get an empty batch; its commit() applies all
+  //                edits at once (O(min{N, n log N})) and its
+  //                abort() discards them (O(n))
+
+  batch begin_batch();
+
   // ------------------------- FRIENDS ---------------------------
 
 private:
@@ -513,6 +547,12 @@ private:
   friend class avl_array_rev_iter<T, A, W, P, const_reference, const_pointer>;
 
   friend class rollback_list<T, A, W, P>;
+  friend class avl_array_batch<T, A, W, P>;
+
+  friend class avl_array_npsv_cursor<T, A, W, P, iterator>;
+  friend class avl_array_npsv_cursor<T, A, W, P, const_iterator>;
+
+  friend class avl_array_npsv_index<T, A, W, P>;
 
   // ----------------------- PRIVATE DATA ------------------------
 
@@ -523,6 +563,10 @@ private:
   mutable bool m_sums_out_of_date; // If true: NPSV sums must
                                    // be recalculated
 
+  // Edits counter, for the flat NPSV index (npsv_index.hpp)
+  std::size_t m_version; // Changed by every change of the
+                         // sequence or of a width
+
   // ------------------ PRIVATE HELPER METHODS -------------------
 
 private:
@@ -546,6 +590,7 @@ private:
   // iterator_pointer(): get the node refered by an it. (O(1))
   // make_const_iterator(): get const it. referring a node (O(1))
   // make_const_rev_iter(): get const reverse it...       (O(1))
+  // make_iterator(): get any it. type referring a node   (O(1))
 
   static node_t *next(node_t *p);
   static node_t *prev(node_t *p);
@@ -556,6 +601,8 @@ private:
   static const_iterator make_const_iterator(node_t *p);
   static const_reverse_iterator make_const_rev_iter(node_t *p);
 
+  template <class IT> static IT make_iterator(node_t *p);
+
   // Methods for nodes allocation/deallocation
   // See alloc.hpp
   //
@@ -704,17 +751,27 @@ private:
   static void move_nodes(IT src_from, size_type n, node_t *dst,
                          bool reverse = false);
 
-  // Helper method for sorting and searching
+  // Helper methods for sorting and searching
   //
   // binary_search(): search value in a sorted tree (O(log N))
+  // merge_lists(): stable merge of two sorted lists (O(M+N))
+  // join_lists(): concatenate two lists (O(M))
 
   template <class CMP>
   bool binary_search      // Return true iff it is found
       (const_reference t, // What to search
        node_t **pp,       // Pos. where it is / should be
-       CMP cmp,           // Functor for '<' comparisons
-       P oldpos = 0,      // Old position (in stable sort)
-       bool stable = false) const;
+       CMP cmp) const;    // Functor for '<' comparisons
+
+  template <class CMP>
+  static void merge_lists // Move all nodes of a and b, in
+      (node_t *&a,        // order, to the end of the list
+       node_t *&b,        // [first,last] (a wins on ties)
+       node_t *&first,    // Lists are NULL terminated and
+       node_t *&last,     // only m_next is used. On any
+       CMP &cmp);         // exception, no node is lost
+
+  static node_t *join_lists(node_t *a, node_t *b);
 
   // Helper method for massive resize operations
   // See size.hpp
@@ -723,6 +780,27 @@ private:
   //                                 O(max{old_size,new_size})
 
   template <class DP> void resize(size_type n, DP &dp);
+
+  // Helper methods for NPSV searches
+  // See npsv.hpp
+  //
+  // npsv_node_at_pos(): get the node of a position (O(log N))
+  // npsv_descend(): get the node of a pos. in a subtree (O(log N))
+  // npsv_seek(): finger search forwards (O(log d), d: skipped)
+
+  node_t *npsv_node_at_pos(W pos, W *start = NULL) const;
+
+  template <class CMP> node_t *npsv_node_at_pos(W pos, CMP &cmp) const;
+
+  static node_t *npsv_descend // Return NULL if not found
+      (node_t *p,             // Root of the subtree
+       W pos,                 // Position in the subtree
+       W &base);              // In: subtree pos. Out: node pos.
+
+  node_t *npsv_seek    // Return the node of pos
+      (node_t *p,      // Node to start from
+       W &start,       // In/out: position of the node
+       W pos) const;   // Position searched (not before p)
 };
 
 //////////////////////////////////////////////////////////////////
@@ -750,10 +828,11 @@ private:
 #include "detail/aa_erase.hpp"   // erase(), clear()
 #include "detail/aa_insert.hpp"  // insert()
 #include "detail/aa_move.hpp"    // move/splice(), swap(), reverse()
+#include "detail/aa_batch.hpp"   // Batches of inserts/erases
 #include "detail/aa_size.hpp"    // size(), max_size(), resize()...
 
 #include "detail/aa_sorted_search_tree.hpp" // sort(),
-                                            // [stable_sort()],
+                                            // stable_sort(),
                                             // binary_search(),
                                             // insert_sorted(),
                                             // merge(), unique()
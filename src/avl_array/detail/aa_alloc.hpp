@@ -48,10 +48,15 @@ inline typename avl_array<T, A, W, P>::node_t *avl_array<T, A, W, P>::new_node(
   if (p == NULL)                     // If the allocator didn't
     throw allocator_returned_null(); // throw an exception, but
                                      // it returned NULL, throw
-  if (t)
-    new (p) payload_node_t(*t); // Call the constructor
-  else                          // through the placement
-    new (p) payload_node_t;     // new operator
+  try {
+    if (t)
+      new (p) payload_node_t(*t); // Call the constructor
+    else                          // through the placement
+      new (p) payload_node_t;     // new operator
+  } catch (...) {
+    allocator.deallocate(p, 1); // Don't leak the memory if
+    throw;                      // T's constructor throws
+  }
 
   return static_cast<node_t *>(p); // Return allocated node
 }
@@ -87,6 +87,7 @@ avl_array<T, A, W, P>::swap(typename avl_array<T, A, W, P>::my_class &a) {
 template <class T, class A, class W, class P>
 inline void avl_array<T, A, W, P>::acquire_tree(
     const typename avl_array<T, A, W, P>::node_t &nf) {
+  m_version++;           // Anything indexed is gone
   if (!nf.m_children[L]) // If the tree to acquire is empty,
     init();              // just initialize
   else {
@@ -95,9 +96,9 @@ inline void avl_array<T, A, W, P>::acquire_tree(
     node_t::m_children[L]->m_parent = // Link the tree to dummy
         node_t::m_prev->m_next = node_t::m_next->m_prev = dummy();
 
-    node_t::m_total_width =                   // Copy total
-        node_t::m_children[L]->total_width(); // width into
-  }                                           // dummy node
+    node_t::m_total_width =                     // Copy total
+        node_t::m_children[L]->m_total_width;   // width into
+  }                                             // dummy node
 }
 
 //////////////////////////////////////////////////////////////////
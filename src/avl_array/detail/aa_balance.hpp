@@ -45,9 +45,11 @@ template <class T, class A, class W, class P>
 void avl_array<T, A, W, P>::update_counters(
     typename avl_array<T, A, W, P>::node_t *p) {
   size_type i, j;
+  node_t *top = NULL;
 
   while (p) // Climb until the root is
   {         // reached
+    top = p;
     i = p->left_height();
     j = p->right_height();
 
@@ -66,6 +68,9 @@ void avl_array<T, A, W, P>::update_counters(
 
     p = p->m_parent; // Step up
   }
+
+  if (top)                         // The climb ended in the
+    dummy_owner(top)->m_version++; // dummy: note the edit
 }
 
 // update_counters_and_rebalance(): climb from a node to the root
@@ -82,10 +87,11 @@ void avl_array<T, A, W, P>::update_counters_and_rebalance(
     typename avl_array<T, A, W, P>::node_t *p) {
   size_type i, j;
   int s;
-  node_t *q, *r;
+  node_t *q, *r, *top = NULL;
 
   while (p) // Climb until the root is
   {         // reached
+    top = p;
     i = p->left_height();
     j = p->right_height();
 
@@ -265,6 +271,9 @@ void avl_array<T, A, W, P>::update_counters_and_rebalance(
                          r->m_node_width;
     }
   }
+
+  if (top)                         // The climb ended in the
+    dummy_owner(top)->m_version++; // dummy: note the edit
 }
 
 //////////////////////////////////////////////////////////////////
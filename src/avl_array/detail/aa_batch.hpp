@@ -0,0 +1,280 @@
+///////////////////////////////////////////////////////////////////
+//                                                               //
+//  Copyright (c) 2006, Universidad de Alcala                    //
+//                                                               //
+//  See accompanying LICENSE.TXT                                 //
+//                                                               //
+///////////////////////////////////////////////////////////////////
+
+/*
+  detail/aa_batch.hpp
+  -------------------
+
+  Transactional batches of edits:
+
+  begin_batch(): start buffering inserts/erases (O(1))
+
+  A batch (avl_array_batch) buffers insert(it,t) and erase(it)
+  requests without touching the tree. The new nodes are created
+  at once (so T exceptions show up while buffering, never during
+  commit), and kept in a rollback_list. Nothing is rebalanced
+  until commit(), which applies all the edits in a single pass,
+  choosing (like the massive insert/erase operations) between
+  inserting/extracting the nodes one by one (O(n log N)) and
+  linking them in the circular doubly linked list and rebuilding
+  the whole tree (O(N)). abort() (or the destructor of a batch
+  that was not committed) just deletes the buffered nodes, in
+  O(n) time.
+
+  Usage:
+
+    avl_array<int>::batch tx = a.begin_batch();
+
+    tx.insert(a.begin(), 1);
+    tx.erase(a.end() - 1);
+    tx.commit();
+*/
+
+#ifndef _AVL_ARRAY_BATCH_HPP_
+#define _AVL_ARRAY_BATCH_HPP_
+
+#ifndef _AVL_ARRAY_HPP_
+#error "Don't include this file. Include avl_array.hpp instead."
+#endif
+
+namespace mkr // Public namespace
+{
+
+namespace detail // Private nested namespace mkr::detail
+{
+
+//////////////////////////////////////////////////////////////////
+
+template <class T, class A, class W, class P> // Buffered inserts
+class avl_array_batch                         // and erases of an
+{                                             // avl_array
+  friend class mkr::avl_array<T, A, W, P>;
+
+  typedef avl_array_node_tree_fields<T, A, W, P> node_t;
+  typedef avl_array_batch<T, A, W, P> my_class;
+  typedef mkr::avl_array<T, A, W, P> my_array;
+
+public: // -------------- PUBLIC INTERFACE ----------------
+  typedef typename my_array::size_type size_type;
+  typedef typename my_array::const_reference const_reference;
+  typedef typename my_array::iterator iterator;
+
+  // Buffering edits: O(1) (amortized for erase)
+  //
+  // The positions passed to insert() and the victims passed to
+  // erase() must still belong to the array on commit(). Every
+  // element must be erased once at most. Inserts before the
+  // same position keep the order in which they were buffered
+
+  void insert(const iterator &it, const_reference t);
+  void erase(const iterator &it);
+
+  // Applying or discarding the edits
+
+  void commit(); // O(min{N, n log N})
+  void abort();  // O(n)
+
+  size_type size() const; // Buffered edits: O(1)
+  bool empty() const;     // O(1)
+
+  ~avl_array_batch(); // Abort if not committed: O(n)
+
+private: // ----- PRIVATE DATA MEMBERS AND CONSTRUCTORS ------
+  my_array *m_owner;   // Array to edit
+  size_type m_inserts; // Number of nodes in m_new_nodes
+
+  rollback_list<T, A, W, P> m_new_nodes; // Nodes to insert (their
+                                         // m_parent holds the pos.)
+  std::vector<node_t *> m_victims;       // Nodes to erase
+
+  avl_array_batch(my_array *owner); // Only avl_array can create
+                                    // batches
+
+  avl_array_batch(const my_class &);     // Not copyable
+  my_class &operator=(const my_class &); // (not defined)
+};
+
+//////////////////////////////////////////////////////////////////
+
+// Constructor: an empty batch of edits for a given array
+//
+// Complexity: O(1)
+
+template <class T, class A, class W, class P>
+inline avl_array_batch<T, A, W, P>::avl_array_batch(my_array *owner)
+    : m_owner(owner), m_inserts(0), m_new_nodes(owner) {}
+
+// Destructor: if the edits were not committed, the rollback_list
+// deletes the new nodes, and nothing is done to the array
+//
+// Complexity: O(1) or O(n)
+
+template <class T, class A, class W, class P>
+inline avl_array_batch<T, A, W, P>::~avl_array_batch() {}
+
+// insert(): create a copy of t now, and remember that it must be
+// inserted before it. The m_parent field of new nodes is not used
+// until they are linked in the tree, so it stores the position
+//
+// Complexity: O(1)
+
+template <class T, class A, class W, class P>
+inline void avl_array_batch<T, A, W, P>::insert(
+    const typename avl_array_batch<T, A, W, P>::iterator &it,
+    typename avl_array_batch<T, A, W, P>::const_reference t) {
+  node_t *newnode;
+
+  AA_ASSERT_HO(my_array::owner(my_array::iterator_pointer(it)) == m_owner);
+
+  newnode = m_owner->new_node(&t);
+  newnode->m_parent = my_array::iterator_pointer(it);
+  m_new_nodes.push_back(newnode);
+  m_inserts++;
+}
+
+// erase(): remember that the element referred by it must be
+// erased. The tree is not touched (no rebalance) until commit()
+//
+// Complexity: O(1) amortized
+
+template <class T, class A, class W, class P>
+inline void avl_array_batch<T, A, W, P>::erase(
+    const typename avl_array_batch<T, A, W, P>::iterator &it) {
+  node_t *p;
+
+  p = my_array::iterator_pointer(it);
+
+  AA_ASSERT(p);                                      // Singular it.
+  AA_ASSERT_EXC(p->m_parent, invalid_op_with_end()); // Can't erase end()
+  AA_ASSERT_HO(my_array::owner(p) == m_owner);       // it must point
+                                                     // into the array
+  m_victims.push_back(p);
+}
+
+// commit(): apply all the buffered edits. Inserts go first, so
+// that positions are still linked when new nodes are placed
+// before them (even if they are going to be erased too). If the
+// batch is 'big', the new nodes are only linked in the circular
+// doubly linked list, the victims are only unlinked from it, and
+// the tree is rebuilt once. Otherwise, every node is inserted or
+// extracted with its rebalance. Either way, the batch is left
+// empty, ready for a new set of edits
+//
+// Complexity: O(min{N, n log N})
+
+template <class T, class A, class W, class P>
+// not inline
+void avl_array_batch<T, A, W, P>::commit() {
+  node_t *first, *last, *p, *pos;
+  size_type N, n, i;
+  bool rebuild;
+
+  N = m_owner->size();
+  n = m_inserts + m_victims.size();
+  rebuild = my_array::worth_rebuild(n, N); // Upper bound: as if
+                                           // all were inserts
+  m_new_nodes.commit(first, last);
+  m_inserts = 0;
+
+  while (first) {
+    p = first;
+    first = first->m_next;
+    pos = p->m_parent;
+    p->m_parent = NULL;
+
+    if (!rebuild)
+      my_array::insert_before(p, pos);
+    else {
+      p->m_prev = pos->m_prev; // Insert the node in the
+      p->m_next = pos;         // circular doubly linked
+      p->m_prev->m_next = p;   // list only
+      pos->m_prev = p;
+      N++;
+    }
+  }
+
+  for (i = 0; i < m_victims.size(); i++) {
+    p = m_victims[i];
+
+    if (!rebuild)
+      my_array::update_counters_and_rebalance(my_array::extract_node(p));
+    else {
+      p->m_next->m_prev = p->m_prev; // Bypass the victim in the
+      p->m_prev->m_next = p->m_next; // circ. doubly linked list
+      N--;
+    }
+  }
+
+  if (rebuild)
+    m_owner->build_known_size_tree(N, m_owner->dummy()->m_next);
+
+  for (i = 0; i < m_victims.size(); i++)
+    m_owner->delete_node(m_victims[i]);
+
+  m_victims.clear();
+}
+
+// abort(): discard all the buffered edits, deleting the new
+// nodes. The array is not touched
+//
+// Complexity: O(n)
+
+template <class T, class A, class W, class P>
+// not inline
+void avl_array_batch<T, A, W, P>::abort() {
+  node_t *first, *last, *p;
+
+  m_new_nodes.commit(first, last);
+  m_inserts = 0;
+
+  while (first) {
+    p = first;
+    first = first->m_next;
+    m_owner->delete_node(p);
+  }
+
+  m_victims.clear();
+}
+
+// size(): number of buffered edits (inserts + erases)
+//
+// Complexity: O(1)
+
+template <class T, class A, class W, class P>
+inline typename avl_array_batch<T, A, W, P>::size_type
+avl_array_batch<T, A, W, P>::size() const {
+  return m_inserts + m_victims.size();
+}
+
+template <class T, class A, class W, class P>
+inline bool avl_array_batch<T, A, W, P>::empty() const {
+  return !m_inserts && m_victims.empty();
+}
+
+} // namespace detail
+
+//////////////////////////////////////////////////////////////////
+
+// ---------------------- PUBLIC INTERFACE -----------------------
+
+// begin_batch(): get an empty batch of edits for this array (see
+// avl_array_batch above)
+//
+// Complexity: O(1)
+
+template <class T, class A, class W, class P>
+inline typename avl_array<T, A, W, P>::batch
+avl_array<T, A, W, P>::begin_batch() {
+  return batch(this);
+}
+
+//////////////////////////////////////////////////////////////////
+
+} // namespace mkr
+
+#endif
@@ -92,6 +92,7 @@ typename avl_array<T, A, W, P>::node_t * // First unused node
 {                                                     // to link
   size_type depth;                                    // Current depth
   node_t *p, *last;                                   // Current and last nodes
+  W w;                                                // Width of current node
 
   size_type                // Per level: number of nodes
       counts[8 * sizeof    // that still have to be created
@@ -130,7 +131,9 @@ typename avl_array<T, A, W, P>::node_t * // First unused node
 
     p = next;            // Grab the next node
     next = next->m_next; // Advance in the list
-    p->init();           // Clear the node
+    w = p->m_node_width; // Clear the node, but
+    p->init();           // keep its NPSV width
+    p->m_node_width = p->m_total_width = w;
 
     p->m_prev = last;         // Insert the node after the
     p->m_next = last->m_next; // last one in the circular
@@ -44,7 +44,7 @@ namespace mkr // Public namespace
 // Complexity: O(1)
 
 template <class T, class A, class W, class P>
-inline avl_array<T, A, W, P>::avl_array() {
+inline avl_array<T, A, W, P>::avl_array() : m_version(0) {
   init();
 }
 
@@ -57,7 +57,8 @@ inline avl_array<T, A, W, P>::avl_array() {
 
 template <class T, class A, class W, class P>
 inline avl_array<T, A, W, P>::avl_array(
-    const typename avl_array<T, A, W, P>::my_class &a) {
+    const typename avl_array<T, A, W, P>::my_class &a)
+    : m_version(0) {
   node_t *first, *last;
   iter_data_provider<const_pointer, const_iterator> dp(a.begin());
 
@@ -76,7 +77,8 @@ inline avl_array<T, A, W, P>::avl_array(
 template <class T, class A, class W, class P>
 inline avl_array<T, A, W, P>::avl_array(
     typename avl_array<T, A, W, P>::size_type n,
-    typename avl_array<T, A, W, P>::const_reference t) {
+    typename avl_array<T, A, W, P>::const_reference t)
+    : m_version(0) {
   node_t *first, *last;
   copy_data_provider<const_pointer> dp(&t);
 
@@ -86,7 +88,8 @@ inline avl_array<T, A, W, P>::avl_array(
 
 template <class T, class A, class W, class P>
 inline avl_array<T, A, W, P>::avl_array(
-    int n, typename avl_array<T, A, W, P>::const_reference t) {
+    int n, typename avl_array<T, A, W, P>::const_reference t)
+    : m_version(0) {
   node_t *first, *last;
   copy_data_provider<const_pointer> dp(&t);
 
@@ -98,7 +101,8 @@ inline avl_array<T, A, W, P>::avl_array(
 
 template <class T, class A, class W, class P>
 inline avl_array<T, A, W, P>::avl_array(
-    long n, typename avl_array<T, A, W, P>::const_reference t) {
+    long n, typename avl_array<T, A, W, P>::const_reference t)
+    : m_version(0) {
   node_t *first, *last;
   copy_data_provider<const_pointer> dp(&t);
 
@@ -116,7 +120,8 @@ inline avl_array<T, A, W, P>::avl_array(
 
 template <class T, class A, class W, class P>
 inline avl_array<T, A, W, P>::avl_array(
-    typename avl_array<T, A, W, P>::size_type n) {
+    typename avl_array<T, A, W, P>::size_type n)
+    : m_version(0) {
   node_t *first, *last;
   null_data_provider<const_pointer> dp;
 
@@ -133,7 +138,8 @@ inline avl_array<T, A, W, P>::avl_array(
 
 template <class T, class A, class W, class P>
 template <class IT>
-inline avl_array<T, A, W, P>::avl_array(IT from, IT to) {
+inline avl_array<T, A, W, P>::avl_array(IT from, IT to)
+    : m_version(0) {
 #ifdef BOOST_CLASS_REQUIRE
   function_requires<InputIteratorConcept<IT>>();
 #endif
@@ -155,7 +161,8 @@ inline avl_array<T, A, W, P>::avl_array(IT from, IT to) {
 template <class T, class A, class W, class P>
 template <class IT>
 inline avl_array<T, A, W, P>::avl_array(
-    IT from, typename avl_array<T, A, W, P>::size_type n) {
+    IT from, typename avl_array<T, A, W, P>::size_type n)
+    : m_version(0) {
 #ifdef BOOST_CLASS_REQUIRE
   function_requires<InputIteratorConcept<IT>>();
 #endif
@@ -193,6 +200,7 @@ inline void avl_array<T, A, W, P>::init() {
   node_t::m_node_width = node_t::m_total_width = W(0); // Zero width
 
   m_sums_out_of_date = false; // Sums up to date
+  m_version++;                // Anything indexed is gone
 }
 
 //////////////////////////////////////////////////////////////////
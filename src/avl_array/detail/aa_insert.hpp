@@ -344,10 +344,16 @@ void avl_array<T, A, W, P>::insert_before(
   node_t *parent; // Future parent of the new node
   int side;       // Side (of the parent) where the
                   // new node will be inserted
+  W w;            // Width of the new node
 
   AA_ASSERT(p);       // NULL pointer dereference
   AA_ASSERT(newnode); // Can't insert NULL
 
+  w = newnode->m_node_width;  // A node moved from another
+  newnode->init();            // position still has its old
+  newnode->m_node_width = w;  // children, count and height:
+  newnode->m_total_width = w; // clear them, but keep its width
+
   if (p->m_children[L]) // If p has a left subtree, then the
   {                     // previous node (the rightmost node
     parent = p->m_prev; // in this left subtree) has no right
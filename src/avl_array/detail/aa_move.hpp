@@ -13,7 +13,7 @@
   Methods for moving or swapping nodes:
 
   swap (it/rit,it/rit): interchange two elements
-                                 (O(1)), O(log N) with NPSV)
+                                 (O(1), O(log N) with NPSV)
   move (it/rit,n): offset move (O(log N))
   move (it/rit,it/rit): individual move O(log(M)+log(N))
   move (it/rit,n,it/rit): group move *
@@ -57,7 +57,7 @@ namespace mkr // Public namespace
 // objects. The nodes can be from the same tree, or from
 // a different tree each one
 //
-// Complexity: O(1)
+// Complexity: O(1), O(log N) with NPSV
 
 template <class T, class A, class W, class P>
 inline void
@@ -93,9 +93,7 @@ inline void avl_array<T, A, W, P>::swap(
 // T object. Two versions of this method are provided. One
 // receives a normal iterator. The other one receives a
 // reverse iterator, which inverts the sign of the move.
-// IF |n|==1 AND [ NPSV is not used, OR
-//                 both NPSV widths are the same, OR
-//                 m_sums_out_of_date==true ]
+// IF |n|==1 AND NPSV is not used
 // THEN the oparetion takes just O(1) time
 // ELSE it takes O(log n)
 //
@@ -407,6 +405,8 @@ template <class T, class A, class W, class P>
 void avl_array<T, A, W, P>::reverse() {
   node_t *p, *next, *tmp;
 
+  m_version++; // Every position changes
+
   next = node_t::m_next;
 
   while (next != dummy()) // For every node (excepting the
@@ -437,14 +437,15 @@ void avl_array<T, A, W, P>::reverse() {
 // The dificulty here is that a lot of corner cases have
 // to be taken into account when the nodes are directly
 // related (previous-next or parent-child)
-// If NPSV is not used, or both nodes have the same NPSV
-// width, or the NPSV dirty bit (m_sums_out_of_date) is
-// set, then the operation is O(1) (constant time).
-// Otherwise, the width sums must be updated, taking
-// O(log N) time.
+// If NPSV is not used, the operation is O(1) (constant
+// time). Otherwise, it takes O(log N) time: the width
+// sums must be updated if the widths differ, and even
+// if they don't, the swap must be noted in m_version
+// of both arrays, climbing to their dummies (a flat
+// NPSV index must see it, see npsv_index.hpp).
 //
-// Complexity: O(1) without NPSV or with NPSV but eq. widths
-//             O(log N) with NPSV and different widths
+// Complexity: O(1) without NPSV
+//             O(log N) with NPSV
 
 template <class T, class A, class W, class P>
 // not inline
@@ -510,18 +511,20 @@ void avl_array<T, A, W, P>::swap_nodes(
   p->m_children[R] = q->m_children[R];
   p->m_height = q->m_height; // p->links = q->links
   p->m_count = q->m_count;   // (excepting prev
-  p->m_oldpos = q->m_oldpos; // and next)
+                             // and next)
 
   p->m_node_width = q->m_node_width;
-
+  p->m_total_width = q->m_total_width; // (the sums go with
+                                       // the tree position)
   q->m_parent = tmpnode.m_parent;
   q->m_children[L] = tmpnode.m_children[L];
   q->m_children[R] = tmpnode.m_children[R];
   q->m_height = tmpnode.m_height; // q->links = tmpnode
   q->m_count = tmpnode.m_count;   // (excepting prev
-  q->m_oldpos = tmpnode.m_oldpos; // and next)
+                                  // and next)
 
   q->m_node_width = tmpnode.m_node_width;
+  q->m_total_width = tmpnode.m_total_width;
 
   if (p == p->m_parent) // Very special case: parent-child
   {                     // (p its own parent?? That's because
@@ -572,15 +575,23 @@ void avl_array<T, A, W, P>::swap_nodes(
   if (p->m_node_width != q->m_node_width) {
     do {
       p->m_total_width = p->left_width() + p->right_width() + p->m_node_width;
+      tmp = p;
       p = p->m_parent;
     }          // If necesary, update
     while (p); // width sums from p
                // to root, and from q
-    do         // to root
+    dummy_owner(tmp)->m_version++; // to root (and note the
+    do                             // edit in both dummies)
     {
       q->m_total_width = q->left_width() + q->right_width() + q->m_node_width;
+      tmp = q;
       q = q->m_parent;
     } while (q);
+    dummy_owner(tmp)->m_version++;
+  } else if (!is_empty_number<W>::value) // Same widths: no sums
+  {                                      // to update, but note
+    owner(p)->m_version++;               // the edit in both
+    owner(q)->m_version++;               // dummies anyway
   }
 }
 
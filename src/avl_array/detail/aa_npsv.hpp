@@ -18,8 +18,19 @@
   npsv_set_width(): set an element's width O(log N) or O(1)**
   npsv_pos_of(): get an element's position O(log N) or O(N)*
   npsv_at_pos(): get elem. of a position O(log N) or O(N)*
+  npsv_at_pos_range(): get elems. of sorted positions
+                       O(k + log N) or O(N)*
+  npsv_cursor(): get a cursor for forward seeks O(log N) or O(N)*
   (*) width sums need to be updated
   (**) don't update width sums (lazy mode)
+
+  Private helper methods:
+
+  npsv_node_at_pos(): get the node of a position O(log N)
+  npsv_descend(): get the node of a pos. in a subtree O(log N)
+  npsv_seek(): finger search forwards O(log d)
+
+  Class avl_array_npsv_cursor: forward-only cursor of positions
 */
 
 #ifndef _AVL_ARRAY_NON_PROPORTIONAL_SEQUENCE_VIEW_HPP_
@@ -32,6 +43,97 @@
 namespace mkr // Public namespace
 {
 
+namespace detail // Private nested namespace mkr::detail
+{
+
+//////////////////////////////////////////////////////////////////
+
+template <class T, class A, class W, class P, // Forward-only cursor
+          class IT>                           // over NPSV positions
+class avl_array_npsv_cursor                   // (IT: iterator or
+{                                             // const_iterator)
+  friend class mkr::avl_array<T, A, W, P>;
+
+  typedef avl_array_node_tree_fields<T, A, W, P> node_t;
+  typedef mkr::avl_array<T, A, W, P> my_array;
+
+public: // -------------- PUBLIC INTERFACE ----------------
+  avl_array_npsv_cursor(); // Singular cursor: O(1)
+
+  // The cursor remembers a node and the position where it
+  // begins. Widths must not change while it is in use
+
+  IT seek(W pos); // Move forward to the node of pos: O(log d)
+  IT next();      // Move to the next node: O(1)
+
+  IT current() const; // Node referred: O(1)
+  W start() const;    // Position where it begins: O(1)
+
+private:                   // ----- PRIVATE DATA MEMBERS ------
+  const my_array *m_owner; // Array of the node
+  node_t *m_node;          // Current node
+  W m_start;               // Position of m_node
+
+  avl_array_npsv_cursor(const my_array *owner, // Only avl_array
+                        node_t *p, W start);   // can access this
+};                                             // constructor
+
+//////////////////////////////////////////////////////////////////
+
+template <class T, class A, class W, class P, class IT>
+inline avl_array_npsv_cursor<T, A, W, P, IT>::avl_array_npsv_cursor()
+    : m_owner(NULL), m_node(NULL), m_start(W(0)) {}
+
+template <class T, class A, class W, class P, class IT>
+inline avl_array_npsv_cursor<T, A, W, P, IT>::avl_array_npsv_cursor(
+    const my_array *owner, node_t *p, W start)
+    : m_owner(owner), m_node(p), m_start(start) {}
+
+// seek(): move forward to the node of a given position, which
+// must be greater than or equal to the previous one. The finger
+// search of avl_array (npsv_seek()) starts from the current node
+//
+// Complexity: O(log d), where d is the number of nodes skipped
+
+template <class T, class A, class W, class P, class IT>
+inline IT avl_array_npsv_cursor<T, A, W, P, IT>::seek(W pos) {
+  AA_ASSERT(m_node); // Singular cursor
+
+  m_node = m_owner->npsv_seek(m_node, m_start, pos);
+  return my_array::template make_iterator<IT>(m_node);
+}
+
+// next(): move to the next node, following the circular doubly
+// linked list. Its position is the end of the current one
+//
+// Complexity: O(1)
+
+template <class T, class A, class W, class P, class IT>
+inline IT avl_array_npsv_cursor<T, A, W, P, IT>::next() {
+  AA_ASSERT(m_node); // Singular cursor
+
+  AA_ASSERT_EXC(m_node->m_parent,       // Can't move
+                invalid_op_with_end()); // beyond end
+
+  m_start += m_node->m_node_width;
+  m_node = m_node->m_next;
+  return my_array::template make_iterator<IT>(m_node);
+}
+
+template <class T, class A, class W, class P, class IT>
+inline IT avl_array_npsv_cursor<T, A, W, P, IT>::current() const {
+  return my_array::template make_iterator<IT>(m_node);
+}
+
+template <class T, class A, class W, class P, class IT>
+inline W avl_array_npsv_cursor<T, A, W, P, IT>::start() const {
+  return m_start;
+}
+
+//////////////////////////////////////////////////////////////////
+
+} // namespace detail
+
 //////////////////////////////////////////////////////////////////
 
 // ---------------------- PUBLIC INTERFACE -----------------------
@@ -145,6 +247,7 @@ void avl_array<T, A, W, P>::npsv_set_width(
     return;                      // there's nothing to do
 
   it.ptr->m_node_width = w; // Set the new width
+  m_version++;              // (an index must see it)
 
   if (update_sums)          // If required, update all sums
   {                         // of the tree, or just climb
@@ -197,69 +300,20 @@ W avl_array<T, A, W, P>::npsv_pos_of(
 // npsv_at_pos (): find a node, given its position in the
 // alternative sequence (in which every node can occupy a
 // different width instead of just one unit).
-// It travels down from the root to the searched node. This
-// takes logarithmic time both on average and in the worst
-// case.
+// See npsv_node_at_pos() (below) for details.
 //
 // Complexity: O(log N), or O(N) if sums are out of date
 
 template <class T, class A, class W, class P>
-// not inline
-typename avl_array<T, A, W, P>::iterator
+inline typename avl_array<T, A, W, P>::iterator
 avl_array<T, A, W, P>::npsv_at_pos(W pos) {
-  node_t *p;
-  W left, right;
-
-  if (m_sums_out_of_date)
-    npsv_update_sums();
-
-  if (size() == 0 || pos < W(0) ||
-      pos > node_t::m_total_width || // Out of bounds --> end
-      (pos == node_t::m_total_width && node_t::m_prev->m_node_width != W(0)))
-    return dummy();
-
-  p = node_t::m_children[L]; // Start with the element at the
-                             // root (remember that the dummy
-                             // node has no T element)
-
-  // For every subtree, the position (in it) of its root
-  // node is equal to the left width of this root node...
-
-  while (p)                                // Travel down updating pos to make
-  {                                        // it the index in the visited
-    left = p->left_width();                // subtree, until it fits the
-                                           // index of the subtree's
-    right = left +                         // root node.
-            p->m_node_width;               // A step down-left doesn't
-                                           // touch pos, while a step
-    if (pos < left ||                      // down-right decreases pos
-        (p->m_children[L] &&               // by the sum of the
-         pos == left &&                    // widths of
-         p->m_prev->m_node_width == W(0))) // the nodes
-      p = p->m_children[L];                // we leave at
-    else if (pos < right ||                // the left side
-             (pos == right &&              // (including the
-              p->m_node_width == W(0)))    // subtree's root)
-      return p;
-    else                    // Note that there might be
-    {                       // nodes with zero width
-      pos -= right;         // (some nodes standing in the
-                            // same position of the
-      p = p->m_children[R]; // alternative view). In these
-    }                       // cases return the first one
-  }
-  // We sould never step out of the tree, but
-  return dummy(); // don't trust the coherency of W and its
-} // operators (just in case)
-
-// npsv_at_pos() _const_: See non-const version (above) for
-// details.
+  return iterator(npsv_node_at_pos(pos));
+}
 
 template <class T, class A, class W, class P>
-// not inline
-typename avl_array<T, A, W, P>::const_iterator
+inline typename avl_array<T, A, W, P>::const_iterator
 avl_array<T, A, W, P>::npsv_at_pos(W pos) const {
-  return (const_cast<my_class *>(this))->npsv_at_pos(pos);
+  return const_iterator(npsv_node_at_pos(pos));
 }
 
 // npsv_at_pos (): find a node, given its position in the
@@ -278,18 +332,167 @@ avl_array<T, A, W, P>::npsv_at_pos(W pos) const {
 
 template <class T, class A, class W, class P>
 template <class CMP>
-// not inline
-typename avl_array<T, A, W, P>::iterator
+inline typename avl_array<T, A, W, P>::iterator
 avl_array<T, A, W, P>::npsv_at_pos(W pos, CMP cmp) {
 #ifdef BOOST_CLASS_REQUIRE
   function_requires<BinaryFunctionConcept<CMP, int, const W &, const W &>>();
 #endif
 
-  node_t *p;              // See comments in the first version
-  W left, right;          // of this method (without cmp). The
-  int c;                  // algorithm used here is the same.
-                          // The only difference is the
-  if (m_sums_out_of_date) // comparison method.
+  return iterator(npsv_node_at_pos(pos, cmp));
+}
+
+template <class T, class A, class W, class P>
+template <class CMP>
+inline typename avl_array<T, A, W, P>::const_iterator
+avl_array<T, A, W, P>::npsv_at_pos(W pos, CMP cmp) const {
+#ifdef BOOST_CLASS_REQUIRE
+  function_requires<BinaryFunctionConcept<CMP, int, const W &, const W &>>();
+#endif
+
+  return const_iterator(npsv_node_at_pos(pos, cmp));
+}
+
+// npsv_at_pos_range(): find the nodes of a sorted (non
+// decreasing) sequence of positions [first_pos,last_pos),
+// writing an iterator for each one in out. Instead of
+// travelling down from the root for every position, a
+// finger search moves forward from the previous result
+// (see npsv_seek() below). When consecutive positions are
+// close to each other (e.g. one per pixel row), each step
+// takes O(1) amortized.
+//
+// Complexity: O(k + log N) for k close positions, and
+//             O(k log N) at worst
+
+template <class T, class A, class W, class P>
+template <class IT, class OUT>
+// not inline
+OUT avl_array<T, A, W, P>::npsv_at_pos_range(IT first_pos, IT last_pos,
+                                             OUT out) {
+  node_t *p;
+  W start;
+
+  if (m_sums_out_of_date)
+    npsv_update_sums();
+
+  p = node_t::m_next; // Start with the first node (or
+  start = W(0);       // the dummy if the array is empty)
+
+  for (; first_pos != last_pos; ++first_pos, ++out) {
+    p = npsv_seek(p, start, *first_pos);
+    *out = iterator(p);
+  }
+
+  return out;
+}
+
+template <class T, class A, class W, class P>
+template <class IT, class OUT>
+// not inline
+OUT avl_array<T, A, W, P>::npsv_at_pos_range(IT first_pos, IT last_pos,
+                                             OUT out) const {
+  node_t *p;
+  W start;
+
+  if (m_sums_out_of_date)
+    npsv_update_sums();
+
+  p = node_t::m_next;
+  start = W(0);
+
+  for (; first_pos != last_pos; ++first_pos, ++out) {
+    p = npsv_seek(p, start, *first_pos);
+    *out = const_iterator(p);
+  }
+
+  return out;
+}
+
+// npsv_cursor(): get a cursor referring the node of a given
+// position. The cursor can then be moved forward to greater
+// positions with seek() (see avl_array_npsv_cursor below)
+//
+// Complexity: O(log N), or O(N) if sums are out of date
+
+template <class T, class A, class W, class P>
+inline typename avl_array<T, A, W, P>::npsv_cursor_t
+avl_array<T, A, W, P>::npsv_cursor(W pos) {
+  node_t *p;
+  W start;
+
+  p = npsv_node_at_pos(pos, &start);
+  return npsv_cursor_t(this, p, start);
+}
+
+template <class T, class A, class W, class P>
+inline typename avl_array<T, A, W, P>::const_npsv_cursor_t
+avl_array<T, A, W, P>::npsv_cursor(W pos) const {
+  node_t *p;
+  W start;
+
+  p = npsv_node_at_pos(pos, &start);
+  return const_npsv_cursor_t(this, p, start);
+}
+
+// ------------------- PRIVATE HELPER METHODS --------------------
+
+// npsv_node_at_pos(): find a node, given its position in the
+// alternative sequence. It travels down from the root to the
+// searched node. This takes logarithmic time both on average
+// and in the worst case. If start is not NULL, the position
+// where the node found begins is stored there. This method
+// is const, so that const and non-const npsv_at_pos() can
+// share it without casting constness away
+//
+// Complexity: O(log N), or O(N) if sums are out of date
+
+template <class T, class A, class W, class P>
+// not inline
+typename avl_array<T, A, W, P>::node_t *
+avl_array<T, A, W, P>::npsv_node_at_pos(W pos, W *start) const {
+  node_t *p;
+  W base;
+
+  if (m_sums_out_of_date)
+    npsv_update_sums();
+
+  if (start)                        // Position of end(), in
+    *start = node_t::m_total_width; // case it is returned
+
+  if (size() == 0 || pos < W(0) ||
+      pos > node_t::m_total_width || // Out of bounds --> end
+      (pos == node_t::m_total_width && node_t::m_prev->m_node_width != W(0)))
+    return dummy();
+
+  base = W(0);                            // Start with the element
+  p = npsv_descend(node_t::m_children[L], // at the root (remember
+                   pos, base);            // that the dummy node
+                                          // has no T element)
+  if (!p)           // We sould never step out of the tree,
+    return dummy(); // but don't trust the coherency of W
+                    // and its operators (just in case)
+  if (start)
+    *start = base;
+
+  return p;
+}
+
+// npsv_node_at_pos(): find a node, given its position in the
+// alternative sequence, using a functor for comparisons (see
+// the public npsv_at_pos() with cmp, above).
+//
+// Complexity: O(log N), or O(N) if sums are out of date
+
+template <class T, class A, class W, class P>
+template <class CMP>
+// not inline
+typename avl_array<T, A, W, P>::node_t *
+avl_array<T, A, W, P>::npsv_node_at_pos(W pos, CMP &cmp) const {
+  node_t *p;              // See comments in npsv_descend(). The
+  W left, right;          // algorithm used here is the same.
+  int c;                  // The only difference is the
+                          // comparison method.
+  if (m_sums_out_of_date)
     npsv_update_sums();
 
   if (size() == 0 || cmp(pos, W(0)) < 0 ||            // pos<(W)0
@@ -323,18 +526,119 @@ avl_array<T, A, W, P>::npsv_at_pos(W pos, CMP cmp) {
   return dummy();
 }
 
-// npsv_at_pos() _const_: See non-const version (above) for
-// details.
+// npsv_descend(): find a node, given its position (pos) in the
+// subtree of p. base is the position where the subtree begins,
+// and it is updated to the position where the node found
+// begins. Return NULL if pos is not in the subtree.
+//
+// Complexity: O(log N)
 
 template <class T, class A, class W, class P>
-template <class CMP>
-inline typename avl_array<T, A, W, P>::const_iterator
-avl_array<T, A, W, P>::npsv_at_pos(W pos, CMP cmp) const {
-#ifdef BOOST_CLASS_REQUIRE
-  function_requires<BinaryFunctionConcept<CMP, int, const W &, const W &>>();
-#endif
+// not inline, static
+typename avl_array<T, A, W, P>::node_t *
+avl_array<T, A, W, P>::npsv_descend(node_t *p, W pos, W &base) {
+  W left, right;
+
+  // For every subtree, the position (in it) of its root
+  // node is equal to the left width of this root node...
+
+  while (p)                                // Travel down updating pos to make
+  {                                        // it the index in the visited
+    left = p->left_width();                // subtree, until it fits the
+                                           // index of the subtree's
+    right = left +                         // root node.
+            p->m_node_width;               // A step down-left doesn't
+                                           // touch pos, while a step
+    if (pos < left ||                      // down-right decreases pos
+        (p->m_children[L] &&               // by the sum of the
+         pos == left &&                    // widths of
+         p->m_prev->m_node_width == W(0))) // the nodes
+      p = p->m_children[L];                // we leave at
+    else if (pos < right ||                // the left side
+             (pos == right &&              // (including the
+              p->m_node_width == W(0)))    // subtree's root)
+    {                                      // Note that there might be
+      base += left;                        // nodes with zero width
+      return p;                            // (some nodes standing in the
+    }                                      // same position of the
+    else                                   // alternative view). In these
+    {                                      // cases return the first one
+      pos -= right;
+      base += right;
+      p = p->m_children[R];
+    }
+  }
+
+  return NULL;
+}
+
+// npsv_seek(): finger search. Given a node p beginning at the
+// position start, find the node of the position pos, knowing
+// that it is not before p (pos must be greater than or equal to
+// the position used for finding p). First look at p and at the
+// next node in the circular doubly linked list. If pos is
+// further, climb from p until reaching a subtree that ends
+// after pos, and then travel down from there. Both the node
+// found and its position (start) are returned.
+//
+// Complexity: O(log d), where d is the number of nodes skipped
+
+template <class T, class A, class W, class P>
+// not inline
+typename avl_array<T, A, W, P>::node_t *
+avl_array<T, A, W, P>::npsv_seek(node_t *p, W &start, W pos) const {
+  node_t *q;
+  W end, base;
+
+  if (!p->m_parent) // Already in the dummy node?
+    return p;       // (nothing after it)
+
+  end = start + p->m_node_width;     // If pos is still
+  if (pos < end ||                   // in p, p is the
+      (pos == end && p->m_node_width == W(0))) // node
+    return p;
+
+  q = p->m_next; // Otherwise, try the
+  start = end;   // next node (most usual
+                 // case in dense queries)
+  if (!q->m_parent)
+    return q;
+
+  end = start + q->m_node_width;
+  if (pos < end || (pos == end && q->m_node_width == W(0)))
+    return q;
+
+  base = start - q->left_width(); // Subtree of q: [base,end)
+  end += q->right_width();
+
+  while (q->m_parent->m_parent && // Climb until the subtree
+         !(pos < end))            // ends after pos, or until
+  {                               // the root is reached
+    if (q->m_parent->m_children[L] == q)   // Step up-right: the
+      end += q->m_parent->m_node_width +   // parent and its
+             q->m_parent->right_width();   // right subtree are
+    else                                   // added at the end
+      base -= q->m_parent->m_node_width +  // Step up-left: they
+              q->m_parent->left_width();   // are added at the
+                                           // beginning
+    q = q->m_parent;
+  }
+
+  if (!(pos < end))                    // Not even in the whole
+    return npsv_node_at_pos(pos, &start); // tree? Then search from
+                                         // the root with the bounds
+                                         // checks of npsv_at_pos()
+
+  q = npsv_descend(q, pos - base, base); // Nodes before the
+                                         // old p don't match
+  if (!q)                                // pos, so the first
+  {                                      // match in the subtree
+    start = node_t::m_total_width;       // is the right one
+    return dummy();
+  }
 
-  return (const_cast<my_class *>(this))->npsv_at_pos(pos, cmp);
+  start = base;
+  return q;
 }
 
 //////////////////////////////////////////////////////////////////
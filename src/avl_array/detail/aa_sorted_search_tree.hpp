@@ -21,9 +21,11 @@
   unique(): remove duplicates* (O(N))
   (*) Elements must be previously in order
 
-  Private helper method:
+  Private helper methods:
 
   binary_search(): search value in a sorted tree (O(log N))
+  merge_lists(): stable merge of two sorted lists (O(M+N))
+  join_lists(): concatenate two lists (O(M))
 */
 
 #ifndef _AVL_ARRAY_SORTED_SEARCH_TREE_HPP_
@@ -254,6 +256,8 @@ void avl_array<T, A, W, P>::sort(CMP cmp) {
 
     binary_search(data(p), &pos, cmp);
     p->m_children[L] = p->m_children[R] = NULL;
+    p->m_height = p->m_count = 1;        // Forget the old
+    p->m_total_width = p->m_node_width; // subtree counters
     insert_before(p, pos);
   }
 }
@@ -269,6 +273,17 @@ inline void avl_array<T, A, W, P>::sort() // Same, but with
 // found, place them together in the new array but, unlike
 // sort(), respect the order that existed previously among
 // them.
+// No per-node field is required for this (the P parameter
+// is not used). The tree is detached and its nodes are
+// sorted as a singly linked list with a bottom-up merge
+// sort: bins[i] is empty or holds a sorted run of 2^i
+// nodes, so runs are merged like the digits of a binary
+// counter. Earlier nodes are always in the left operand of
+// merge_lists(), which makes the sort stable. Finally, the
+// tree is rebuilt in perfect balance. Extra space is one
+// pointer per bit of size_type (O(log N)). If cmp throws,
+// all the nodes are gathered again (in an unspecified
+// order) and the exception is re-thrown.
 //
 // Complexity: O(N log N)
 
@@ -281,30 +296,71 @@ void avl_array<T, A, W, P>::stable_sort(CMP cmp) {
       BinaryFunctionConcept<CMP, int, const_reference, const_reference>>();
 #endif
 
-  node_t *p, *next, *pos;
-  P i;
+  const size_type max_bins = 8 * sizeof(size_type);
+  node_t *bins[8 * sizeof(size_type)]; // Pending runs (see above)
+  node_t *next, *a, *b, *first, *last;
+  size_type i, n;
 
-  AA_ASSERT(P(0) != P(1)); // No P -> no stable sort
-                           // Instantiate the avl_aray
-  if (size() < 2)          // specifying std::size_t as P
-    return;                // parameter instead of the
-                           // default value (empty_number)
-  node_t::m_prev->m_next = NULL;
-  next = node_t::m_next;
+  n = size();
+
+  if (n < 2)
+    return;
 
-  init();                // Same as sort, but mark every
-                         // element with its old index and
-  for (i = 0; next; i++) // use this index for comparisons
-  {                      // between duplicates while
-    p = next;            // searching the insertion point
-    next = next->m_next;
+  for (i = 0; i < max_bins; i++) // No runs yet
+    bins[i] = NULL;
 
-    binary_search(data(p), &pos, cmp, i, true);
-    p->m_oldpos = i;
-    p->m_children[L] = p->m_children[R] = NULL;
-    insert_before(p, pos);
+  node_t::m_prev->m_next = NULL; // Detach the whole tree and use
+  next = node_t::m_next;         // it as an independent list
+
+  a = b = first = last = NULL;
+
+  try {
+    while (next) {         // Take the nodes one by one
+      b = next;            // as runs of size 1
+      next = next->m_next;
+      b->m_next = NULL;
+
+      for (i = 0; bins[i]; i++) // Carry: merge with the
+      {                         // (older) runs of the
+        a = bins[i];            // same size while they
+        bins[i] = NULL;         // exist
+        merge_lists(a, b, first, last, cmp);
+        b = first;
+        first = last = NULL;
+      }
+
+      bins[i] = b; // Store the result in the
+      b = NULL;    // first empty bin
+    }
+
+    for (i = 0; i < max_bins; i++) // Merge all pending runs,
+      if (bins[i]) {               // from the smallest (and
+        a = bins[i];               // most recent) one to the
+        bins[i] = NULL;            // largest (and oldest)
+
+        if (b) {
+          merge_lists(a, b, first, last, cmp);
+          b = first;
+          first = last = NULL;
+        } else
+          b = a;
+
+        a = NULL;
+      }
+  } catch (...) {             // cmp threw: gather all the
+    first = join_lists(first, a); // nodes (wherever they are)
+    first = join_lists(first, b); // in a single list, put them
+    first = join_lists(first, next); // back in the tree (the
+                                     // order is lost) and
+    for (i = 0; i < max_bins; i++)   // re-throw
+      first = join_lists(first, bins[i]);
+
+    build_known_size_tree(n, first);
+    throw;
   }
-}
+
+  build_known_size_tree(n, b); // Build the tree with
+} // the sorted list
 
 template <class T, class A, class W, class P>
 inline void avl_array<T, A, W, P>::stable_sort() // Same, but with
@@ -340,7 +396,7 @@ void avl_array<T, A, W, P>::merge(
       BinaryFunctionConcept<CMP, int, const_reference, const_reference>>();
 #endif
 
-  node_t *my_next, *donor_next, *next, *last, *first;
+  node_t *my_next, *donor_next, *last, *first;
   size_type n;
 
   if (this == &donor || donor.size() == 0)
@@ -361,29 +417,9 @@ void avl_array<T, A, W, P>::merge(
   donor_next = donor.m_next;
   donor.init(); // Leave the donor empty
 
-  first = last = NULL; // Start a new list
-
-  while (my_next && donor_next) // While both lists have
-  {                             // elements,
-    if (cmp(data(donor_next),   // take the lesser of the
-            data(my_next)))     // two first elements,
-    {
-      next = donor_next;
-      donor_next = donor_next->m_next;
-    } else // extract it from its list,
-    {
-      next = my_next;
-      my_next = my_next->m_next;
-    }
-
-    if (first)                    // and append it to end of
-      last = last->m_next = next; // the new list (well, the
-    else                          // first time it is the
-      first = last = next;        // beginnig)
-  }
-  // When one list is
-  last->m_next = my_next ? my_next : // empty, append the
-                     donor_next;     // rest of the other
+  first = last = NULL; // Start a new list and move the
+                       // nodes of both lists to it, in
+  merge_lists(my_next, donor_next, first, last, cmp); // order
 
   build_known_size_tree(n, first); // Build the tree with
 } // the merged list
@@ -468,11 +504,7 @@ inline void avl_array<T, A, W, P>::unique() {
 // element has been found or not. The address of the node
 // is stored in *pp (if the exact value is not found, the
 // address stored in *pp points to the node positioned
-// where the searched value should be). The parameter
-// oldpos is used in stable sort operations. When used, it
-// serves for diferencing equal values of T in a way that
-// leads to placing them together, but in a concrete order
-// (the one they had among them before the sort process).
+// where the searched value should be).
 // The binary search takes logarithmic time (time
 // proportional to log(N), where N is the number of nodes
 // in the tree).
@@ -489,9 +521,7 @@ template <class CMP>
 bool avl_array<T, A, W, P>::binary_search               // Return true iff found
     (typename avl_array<T, A, W, P>::const_reference t, // What to search
      typename avl_array<T, A, W, P>::node_t **pp, // Where it is / should be
-     CMP cmp,                                     // Functor for '<' comparisons
-     P oldpos,    // Old position (in stable sort)
-     bool stable) // True for stable sort search
+     CMP cmp) // Functor for '<' comparisons
     const {
 #ifdef BOOST_CLASS_REQUIRE
   function_requires<
@@ -518,15 +548,10 @@ bool avl_array<T, A, W, P>::binary_search               // Return true iff found
                   lesser_and_greater()); // Can't be < and >
 
     if (!lesser && !greater) // If it is equal,
-    {
-      if (!stable) // we found it (unless we are
-      {            // in a stable sort process)
-        *pp = p;
-        return true;                 // In a stable sort, act
-      }                              // as if the values were
-                                     // different (greater or
-      lesser = oldpos < p->m_oldpos; // lesser, depending on
-    }                                // the oldpos values)
+    {                        // we found it
+      *pp = p;
+      return true;
+    }
 
     if (lesser)              // If what we search is lesser
     {                        // than the root of the current
@@ -549,6 +574,89 @@ bool avl_array<T, A, W, P>::binary_search               // Return true iff found
   }
 }
 
+// merge_lists(): move the nodes of two sorted lists (a and b)
+// to the end of a third list [first,last], keeping the order.
+// All lists are NULL terminated and linked only through
+// m_next (m_prev and the tree links are ignored). When two
+// elements are equal, the one from a goes first, so if a
+// holds elements that were before those of b, the merge is
+// stable. The four pointers (passed by ref.) are always
+// consistent: if cmp throws, every node is still in one of
+// the three lists, and the caller can recover them.
+//
+// Complexity: O(M+N)
+
+template <class T, class A, class W, class P>
+template <class CMP>
+// not inline
+void avl_array<T, A, W, P>::merge_lists(
+    typename avl_array<T, A, W, P>::node_t *&a,     // Sorted list
+    typename avl_array<T, A, W, P>::node_t *&b,     // Sorted list
+    typename avl_array<T, A, W, P>::node_t *&first, // Destination
+    typename avl_array<T, A, W, P>::node_t *&last,  // list
+    CMP &cmp) {
+  node_t *p;
+
+  while (a && b)              // While both lists have
+  {                           // elements, take the lesser
+    if (cmp(data(b), data(a))) // of the two first elements
+    {                          // (a on ties),
+      p = b;
+      b = b->m_next;
+    } else {
+      p = a;
+      a = a->m_next;
+    }
+
+    p->m_next = NULL; // extract it from its list,
+
+    if (first)                 // and append it to the end
+      last = last->m_next = p; // of the new list
+    else
+      first = last = p;
+  }
+
+  p = a ? a : b; // When one list is empty,
+  a = b = NULL;  // append the rest of the other
+
+  if (!p)
+    return;
+
+  if (first)
+    last->m_next = p;
+  else
+    first = p;
+
+  while (p->m_next) // Find the new last node
+    p = p->m_next;
+
+  last = p;
+}
+
+// join_lists(): append the NULL terminated list b at the end
+// of the NULL terminated list a, and return the result
+// (either list might be empty). Used for gathering nodes
+// when an operation is interrupted by an exception
+//
+// Complexity: O(M) (M is the length of a)
+
+template <class T, class A, class W, class P>
+// not inline
+typename avl_array<T, A, W, P>::node_t *
+avl_array<T, A, W, P>::join_lists(typename avl_array<T, A, W, P>::node_t *a,
+                                  typename avl_array<T, A, W, P>::node_t *b) {
+  node_t *p;
+
+  if (!a)
+    return b;
+
+  for (p = a; p->m_next; p = p->m_next)
+    ;
+
+  p->m_next = b;
+  return a;
+}
+
 //////////////////////////////////////////////////////////////////
 
 } // namespace mkr
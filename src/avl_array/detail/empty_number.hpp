@@ -11,8 +11,9 @@
   -----------------------
 
   Class intended to be used as default parameter when features
-  like NPSV or stable_sort are not wanted. Compilers should
-  optimize away memory and operations of this class.
+  like NPSV are not wanted. Compilers should optimize away
+  memory and operations of this class. (P, the old stable_sort
+  parameter, is no longer used, but still defaults to this)
 */
 
 #ifndef _AVL_ARRAY_EMPTY_NUMBER_HPP_
@@ -74,6 +75,15 @@ inline bool operator>=(const empty_number &, const empty_number &) {
   return true;
 }
 
+template <class W> struct is_empty_number // W==empty_number?
+{                                         // (then no NPSV)
+  enum { value = false };
+};
+
+template <> struct is_empty_number<empty_number> {
+  enum { value = true };
+};
+
 //////////////////////////////////////////////////////////////////
 
 } // namespace detail
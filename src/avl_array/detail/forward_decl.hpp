@@ -38,6 +38,15 @@ class avl_array_node;                         // its payload value_type
 template <class T, class A, class W, class P> // A list of nodes to
 class rollback_list;                          // complete or delete
 
+template <class T, class A, class W, class P> // Buffered inserts and
+class avl_array_batch;                        // erases (transaction)
+
+template <class T, class A, class W, class P, class IT>
+class avl_array_npsv_cursor; // Forward-only NPSV cursor
+
+template <class T, class A, class W, class P> // Flat index of
+class avl_array_npsv_index;                   // NPSV widths
+
 template <class T, class A, class W, class P, class Ref, class Ptr>
 class avl_array_iterator; // Normal iterator
 
@@ -57,7 +66,7 @@ class range_data_provider;     // under the same interface
 template <class Ptr> class copy_data_provider;
 
 class empty_number; // Default parameter for W (no NPSV)
-                    // and P (no stable_sort)
+                    // and P (unused, kept for compatibility)
 } // namespace detail
 
 } // namespace mkr
@@ -25,6 +25,7 @@
   iterator_pointer(): get the node refered by an it. (O(1))
   make_const_iterator(): get const it. referring a node (O(1))
   make_const_rev_iter(): get const reverse it... (O(1))
+  make_iterator(): get any it. type referring a node (O(1))
 */
 
 #ifndef _AVL_ARRAY_HELPER_FUN_ITER_HPP_
@@ -130,6 +131,21 @@ inline // static
   return const_reverse_iterator(p);
 }
 
+// make_iterator(): call the private constructor of any of
+// the iterator classes (IT). This is required by NPSV
+// cursors, which can't access these constructors
+//
+// Complexity: O(1)
+
+template <class T, class A, class W, class P>
+template <class IT>
+inline // static
+    IT
+    avl_array<T, A, W, P>::make_iterator(
+        typename avl_array<T, A, W, P>::node_t *p) {
+  return IT(p);
+}
+
 //////////////////////////////////////////////////////////////////
 
 } // namespace mkr
@@ -60,6 +60,7 @@ public: // -------------- PUBLIC INTERFACE ----------------
 
   avl_array_iterator();                              // Singular iterator
   avl_array_iterator(const my_class &it);            // Copy constructor
+  my_class &operator=(const my_class &it);           // Assignment
   explicit avl_array_iterator(const my_reverse &it); // From reverse
 
   operator const_iterator(); // Conversion to const
@@ -145,6 +146,16 @@ inline avl_array_iterator<T, A, W, P, Ref, Ptr>::avl_array_iterator(
   ptr = it.ptr;
 }
 
+// Assignment: just copy the embedded pointer (declared along
+// with the copy constructor, as required since C++11)
+
+template <class T, class A, class W, class P, class Ref, class Ptr>
+inline avl_array_iterator<T, A, W, P, Ref, Ptr> &
+avl_array_iterator<T, A, W, P, Ref, Ptr>::operator=(const my_class &it) {
+  ptr = it.ptr;
+  return *this;
+}
+
 // Conversion from reverse iterator: copy the pointer (yes, the
 // same pointer; reverse iterators point to the refered element,
 // not to its neighbor). The helper method it_ptr() calls a
@@ -52,6 +52,11 @@ template <class T, class A,        // Data of a tree node (payload
 class avl_array_node_tree_fields { // Note that the dummy has no T
 
   friend class mkr::avl_array<T, A, W, P>;
+  friend class avl_array_batch<T, A, W, P>;
+  friend class avl_array_npsv_index<T, A, W, P>;
+
+  template <class, class, class, class, class>
+  friend class avl_array_npsv_cursor;
   friend class rollback_list<T, A, W, P>;
 
   typedef avl_array_node_tree_fields<T, A, W, P> node_t;
@@ -67,11 +72,11 @@ protected:
   node_t *m_next; // (last_node.next==dummy)
   node_t *m_prev; // (first_node.prev==dummy)
 
-  // Data for balancing, indexing, and stable-sort
+  // Data for balancing and indexing (stable_sort() needs no
+  // per-node field, so P doesn't add anything here)
 
   std::size_t m_height; // levels in subtree, including self
   std::size_t m_count;  // nodes in subtree, including self
-  P m_oldpos;           // position (used only in stable_sort)
 
   // Alternative sequence view:
   W m_node_width;  // Width of this node
@@ -0,0 +1,298 @@
+///////////////////////////////////////////////////////////////////
+//                                                               //
+//  Copyright (c) 2006, Universidad de Alcala                    //
+//                                                               //
+//  See accompanying LICENSE.TXT                                 //
+//                                                               //
+///////////////////////////////////////////////////////////////////
+
+/*
+  detail/npsv_index.hpp
+  ---------------------
+
+  Flat index of NPSV widths (alternative to the width sums kept
+  in the tree nodes). The widths are copied, in sequence order,
+  to contiguous arrays holding a Fenwick tree (binary indexed
+  tree) of prefix sums. Position queries run on these arrays
+  instead of following node pointers, and width changes made
+  through the index update both the arrays and the avl_array.
+
+  The index is a copy of the sequence, not a structure kept
+  in step with the tree: every edit of the avl_array (swap,
+  insertion, erasure, move, sort, width change...) changes its
+  m_version, and the index, which remembers the version it was
+  built from, rebuilds itself entirely on its next use when
+  they differ. A single insertion or erasure shifts every
+  later slot of the flat arrays anyway, so it would cost O(N)
+  even if it were applied to them in place. Only the width
+  changes made through the index itself (set_width()) are
+  applied incrementally, in O(log N). The index pays off when
+  many queries come between edits of the array.
+
+  The rebuild takes O(N): one pass through the circular
+  doubly linked list, which also writes the running sum of
+  the widths into m_tree, and then one contiguous pass that
+  turns those prefix sums into Fenwick ranges (see build()).
+
+  rebuild(): recreate the index now (O(N)), never required
+  size(): number of elements (O(1)*)
+  width(): total width (O(1)*)
+  pos_of(): position of the i-th element (O(log N)*)
+  at_pos(): element of a given position (O(log N)*)
+  set_width(): change the width of the i-th element
+               (O(log N)*, or O(log N) + O(N) later with
+               update_sums==false, see npsv_set_width())
+
+  * Plus O(N) for the rebuild, after any edit of the avl_array
+    not made through the index
+*/
+
+#ifndef _AVL_ARRAY_NPSV_INDEX_HPP_
+#define _AVL_ARRAY_NPSV_INDEX_HPP_
+
+#ifndef _AVL_ARRAY_HPP_
+#error "Don't include this file. Include avl_array.hpp instead."
+#endif
+
+namespace mkr // Public namespace
+{
+
+namespace detail // Private nested namespace mkr::detail
+{
+
+//////////////////////////////////////////////////////////////////
+
+template <class T, class A, class W, class P> // Flat Fenwick tree
+class avl_array_npsv_index                    // of NPSV widths
+{
+  friend class mkr::avl_array<T, A, W, P>;
+
+  typedef avl_array_node_tree_fields<T, A, W, P> node_t;
+  typedef mkr::avl_array<T, A, W, P> my_array;
+
+public: // -------------- PUBLIC INTERFACE ----------------
+  typedef typename my_array::size_type size_type;
+  typedef typename my_array::iterator iterator;
+
+  explicit avl_array_npsv_index(my_array &a); // Build: O(N)
+
+  void rebuild(); // Force a rebuild now: O(N)
+
+  size_type size() const; // O(1)
+  W width() const;        // O(1)
+
+  W pos_of(size_type i) const;  // O(log N)
+  iterator at_pos(W pos) const; // O(log N)
+
+  void set_width(size_type i, W w, // O(log N)
+                 bool update_sums = true);
+
+private:            // ----- PRIVATE HELPER METHODS ------
+  void build() const; // Rebuild, from any method
+  void check() const; // Rebuild if the array changed
+
+private:                                 // ----- PRIVATE DATA MEMBERS ------
+  my_array *m_owner;                     // Indexed array
+  mutable std::vector<node_t *> m_nodes; // Nodes, in sequence order
+  mutable std::vector<W> m_widths;       // Their widths
+  mutable std::vector<W> m_tree;         // Fenwick tree (1-based: [0]
+                                         // is unused)
+  mutable W m_total;                     // Sum of all widths
+  mutable size_type m_mask;              // Greatest power of 2 <= size
+  mutable std::size_t m_version;         // m_owner's, when built
+};
+
+//////////////////////////////////////////////////////////////////
+
+// Constructor: build the index of a given array
+//
+// Complexity: O(N)
+
+template <class T, class A, class W, class P>
+inline avl_array_npsv_index<T, A, W, P>::avl_array_npsv_index(my_array &a)
+    : m_owner(&a), m_total(W(0)), m_mask(0), m_version(0) {
+  build();
+}
+
+// rebuild(): recreate the index, see build()
+//
+// Complexity: O(N)
+
+template <class T, class A, class W, class P>
+inline void avl_array_npsv_index<T, A, W, P>::rebuild() {
+  build();
+}
+
+// check(): rebuild the index if the array changed since it was
+// built (the array changes its m_version on every edit)
+//
+// Complexity: O(1), or O(N) after edits
+
+template <class T, class A, class W, class P>
+inline void avl_array_npsv_index<T, A, W, P>::check() const {
+  if (m_version != m_owner->m_version)
+    build();
+}
+
+// build(): copy the widths to the flat arrays, and build the
+// Fenwick tree. Every m_tree[i] must hold the sum of the widths
+// in (i-lowbit(i),i]. The list traversal leaves the prefix sums
+// P[i] (widths 0..i-1) in m_tree, and then every m_tree[i]
+// becomes P[i]-P[i-lowbit(i)]. That pass goes from the end to
+// the beginning, so P[i-lowbit(i)] is still unchanged when it's
+// read, and its iterations are independent of each other and
+// contiguous, unlike the usual loop (where every element is
+// added to its parent, in a chain of dependencies). With
+// floating point widths, the ranges may differ from the sums
+// in the tree nodes in the last bits
+//
+// Complexity: O(N)
+
+template <class T, class A, class W, class P>
+// not inline
+void avl_array_npsv_index<T, A, W, P>::build() const {
+  node_t *p;
+  size_type n, i;
+  W sum;
+
+  n = m_owner->size();
+
+  m_nodes.resize(n);
+  m_widths.resize(n);
+  m_tree.resize(n + 1);
+
+  m_tree[0] = sum = W(0);
+
+  p = m_owner->dummy()->m_next; // The only pointer-chasing
+                                // loop: get nodes, widths
+  for (i = 0; i < n; i++, p = p->m_next) { // and prefix sums
+    m_nodes[i] = p;
+    m_widths[i] = p->m_node_width;
+    m_tree[i + 1] = sum += m_widths[i];
+  }
+
+  m_total = sum;
+
+  for (i = n; i; i--)                        // Ranges: independent
+    m_tree[i] -= m_tree[i - (i & (~i + 1))]; // (and contiguous)
+                                             // iterations
+  for (m_mask = 1; m_mask <= n; m_mask <<= 1)
+    ;
+  m_mask >>= 1;
+
+  m_version = m_owner->m_version;
+}
+
+// size(), width(): number of elements and total width
+//
+// Complexity: O(1)
+
+template <class T, class A, class W, class P>
+inline typename avl_array_npsv_index<T, A, W, P>::size_type
+avl_array_npsv_index<T, A, W, P>::size() const {
+  check();
+  return m_nodes.size();
+}
+
+template <class T, class A, class W, class P>
+inline W avl_array_npsv_index<T, A, W, P>::width() const {
+  check();
+  return m_total;
+}
+
+// pos_of(): position of the i-th element in the alternative
+// sequence (the sum of the widths of the i previous elements)
+//
+// Complexity: O(log N)
+
+template <class T, class A, class W, class P>
+inline W avl_array_npsv_index<T, A, W, P>::pos_of(size_type i) const {
+  W pos;
+
+  check();
+  AA_ASSERT(i <= m_nodes.size()); // Out of bounds
+
+  for (pos = W(0); i; i &= i - 1) // Clear the lowest bit
+    pos += m_tree[i];             // on every step
+
+  return pos;
+}
+
+// at_pos(): find the element of a given position. The Fenwick
+// tree is travelled down to the first element i whose range
+// ends at pos or after it. Like npsv_at_pos(), return the
+// first element with zero width standing in pos, if any, or
+// otherwise the one covering [start,end) with start<=pos<end
+// (if i ends exactly at pos, with non-zero width, it's the
+// next one)
+//
+// Complexity: O(log N)
+
+template <class T, class A, class W, class P>
+// not inline
+typename avl_array_npsv_index<T, A, W, P>::iterator
+avl_array_npsv_index<T, A, W, P>::at_pos(W pos) const {
+  size_type n, i, mask;
+
+  check();
+  n = m_nodes.size();
+
+  if (n == 0 || pos < W(0) || m_total < pos) // Out of bounds
+    return m_owner->end();                   // --> end
+
+  for (i = 0, mask = m_mask; mask; mask >>= 1) // Greatest i with
+    if (i + mask <= n &&                       // sum(0..i) < pos
+        m_tree[i + mask] < pos) {              // (pos becomes
+      i += mask;                               // relative to the
+      pos -= m_tree[i];                        // end of i)
+    }
+  if (i < n &&                   // Now m_nodes[i] ends at
+      pos == m_widths[i] &&      // pos or after it. If it
+      m_widths[i] != W(0))       // ends at pos, with non-zero
+    i++;                         // width, take the next one
+
+  if (i >= n)
+    return m_owner->end();
+
+  return my_array::template make_iterator<iterator>(m_nodes[i]);
+}
+
+// set_width(): change the width of the i-th element, both in the
+// index and in the avl_array (see npsv_set_width() for the
+// meaning of update_sums)
+//
+// Complexity: O(log N)
+
+template <class T, class A, class W, class P>
+// not inline
+void avl_array_npsv_index<T, A, W, P>::set_width(size_type i, W w,
+                                                 bool update_sums) {
+  size_type n, j;
+  W d;
+
+  check();
+  n = m_nodes.size();
+
+  AA_ASSERT(i < n); // Out of bounds
+
+  d = w - m_widths[i];
+  m_widths[i] = w;
+  m_total += d;
+
+  for (j = i + 1; j <= n; j += j & (~j + 1)) // Add the lowest
+    m_tree[j] += d;                          // bit on every step
+
+  m_owner->npsv_set_width(
+      my_array::template make_iterator<iterator>(m_nodes[i]), w,
+      update_sums);
+
+  m_version = m_owner->m_version; // That edit is in the index
+}
+
+//////////////////////////////////////////////////////////////////
+
+} // namespace detail
+
+} // namespace mkr
+
+#endif
@@ -36,6 +36,7 @@ template <class T, class A, class W, class P> // A list of nodes to
 class rollback_list                           // complete or delete
 {
   friend class mkr::avl_array<T, A, W, P>;
+  friend class avl_array_batch<T, A, W, P>;
 
   typedef avl_array_node_tree_fields<T, A, W, P> node_t;
   typedef mkr::avl_array<T, A, W, P> my_array;
@@ -6,6 +6,7 @@
 #endif
 
 #include <algorithm>
+#include <cstddef>
 #include <iterator>
 #include <type_traits>
 
@@ -248,6 +249,19 @@ auto splice(pick_2, Cont& src, It sb, It se, Cont& dst, It d) -> void
 	src.erase(sb, se);
 }
 
+template<typename Cont, typename It>
+auto splice(pick_1, Cont& src, It sb, It se, Cont& dst, It d, std::size_t n)
+	-> decltype(dst.splice(d, src, sb, se, n), void())
+{
+	dst.splice(d, src, sb, se, n);
+}
+
+template<typename Cont, typename It>
+auto splice(pick_2, Cont& src, It sb, It se, Cont& dst, It d, std::size_t) -> void
+{
+	splice(pick_1{}, src, sb, se, dst, d);
+}
+
 template<typename Cont>
 auto merge(pick_1, Cont& c1, Cont& c2) -> decltype(c1.merge(c2), void())
 {
@@ -365,6 +379,13 @@ void splice(Cont& src, It sb, It se, Cont& dst, It d)
 	detail::splice(detail::pick_1{}, src, sb, se, dst, d);
 }
 
+// n is the number of elements in [sb,se), for containers that can use it
+template<typename Cont, typename It>
+void splice(Cont& src, It sb, It se, Cont& dst, It d, std::size_t n)
+{
+	detail::splice(detail::pick_1{}, src, sb, se, dst, d, n);
+}
+
 template<typename Cont>
 void merge(Cont& c1, Cont& c2)
 {
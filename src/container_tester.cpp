@@ -1,19 +1,56 @@
 
 #include "container_tester.hpp"
 
-#include <ctime>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 namespace CT
 {
-bool                       inited = false;
-std::default_random_engine generator;
-// std::chrono::high_resolution_clock::time_point t1;
-std::clock_t                                         t1;
-std::map<std::string, std::map<std::string, double>> time_data;
+bool                                                   inited = false;
+std::default_random_engine                             generator;
+std::chrono::steady_clock::time_point                  t1;
+timing_options                                         timing;
+std::map<std::string, std::map<std::string, op_times>> time_data;
+std::size_t                                            problem_size = 0;
 } // namespace CT
 
+namespace
+{
+typedef std::map<std::string, std::map<std::string, CT::op_times>> time_table;
+
+// the tables clear_times() kept, by the problem size they were taken at
+std::map<std::size_t, time_table> filed;
+
+void file(std::map<std::size_t, time_table>& into, std::size_t size, const time_table& tt)
+{
+	for (auto&& x : tt)
+		for (auto&& y : x.second)
+			if (!y.second.samples.empty())
+				into[size][x.first][y.first] += y.second;
+}
+
+// what was filed, and time_data as it is now
+std::map<std::size_t, time_table> recorded()
+{
+	auto all = filed;
+	file(all, CT::problem_size, CT::time_data);
+	return all;
+}
+} // namespace
+
 void CT::clear_times()
 {
+	file(filed, problem_size, time_data);
 	time_data.clear();
 }
 
@@ -26,13 +63,579 @@ void CT::init()
 	generator.seed((unsigned int)tm.time_since_epoch().count());
 }
 
+namespace
+{
+/// <summary>
+/// the hardware events as one perf_event group, so that they are all counted over
+/// the same stretch. opened on first use, closed at exit
+/// </summary>
+struct perf_group
+{
+	constexpr static std::size_t none = std::size_t(-1);
+
+	int         fds[CT::hw::count];
+	std::size_t slot[CT::hw::count]; // place in a group read, none when not counted
+	std::size_t opened  = 0;
+	int         leader  = -1;
+	bool        tried   = false;
+	bool        running = false;
+
+	perf_group()
+	{
+		for (std::size_t i = 0; i < CT::hw::count; ++i)
+		{
+			fds[i]  = -1;
+			slot[i] = none;
+		}
+	}
+	~perf_group();
+
+	void open();
+	void start();
+	bool stop(std::uint64_t* events);
+};
+
+perf_group group;
+
+perf_group::~perf_group()
+{
+#ifdef __linux__
+	for (int fd : fds)
+		if (fd >= 0)
+			close(fd);
+#endif
+}
+
+void perf_group::open()
+{
+	tried = true;
+#ifdef __linux__
+	auto cache = [](std::uint64_t which) -> std::uint64_t {
+		return which | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	};
+	const std::uint32_t types[CT::hw::count]   = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+												  PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE};
+	const std::uint64_t configs[CT::hw::count] = {PERF_COUNT_HW_INSTRUCTIONS,   PERF_COUNT_HW_CPU_CYCLES,
+												  cache(PERF_COUNT_HW_CACHE_L1D), cache(PERF_COUNT_HW_CACHE_LL),
+												  PERF_COUNT_HW_BRANCH_MISSES,  cache(PERF_COUNT_HW_CACHE_DTLB)};
+
+	for (std::size_t i = 0; i < CT::hw::count; ++i)
+	{
+		perf_event_attr attr{};
+		attr.size           = sizeof(attr);
+		attr.type           = types[i];
+		attr.config         = configs[i];
+		attr.disabled       = leader < 0;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv     = 1;
+		attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+		if (fd < 0)
+			continue;
+		if (leader < 0)
+			leader = fd;
+		fds[i]  = fd;
+		slot[i] = opened++;
+	}
+#endif
+	if (leader < 0)
+		std::cerr << "hardware counters are not available, timing only\n";
+}
+
+void perf_group::start()
+{
+#ifdef __linux__
+	ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	running = true;
+#endif
+}
+
+bool perf_group::stop(std::uint64_t* events)
+{
+	if (!running)
+		return false;
+	running = false;
+#ifdef __linux__
+	ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+	// nr, time enabled, time running, then a value per event in the order they were opened
+	std::uint64_t buf[3 + CT::hw::count];
+	if (read(leader, buf, sizeof(buf)) < ssize_t(3 * sizeof(std::uint64_t)) || buf[0] != opened || !buf[2])
+		return false;
+
+	// scale up when the group had to share the PMU with others
+	double scale = double(buf[1]) / double(buf[2]);
+	for (std::size_t i = 0; i < CT::hw::count; ++i)
+		events[i] = slot[i] == none ? 0 : std::uint64_t(double(buf[3 + slot[i]]) * scale);
+	return true;
+#else
+	(void)events;
+	return false;
+#endif
+}
+} // namespace
+
+const char* CT::hw::name(std::size_t c)
+{
+	static const char* names[count] = {"instr", "cycles", "L1d miss", "LLC miss", "br miss", "dTLB miss"};
+	return names[c];
+}
+
+bool CT::hw::available(std::size_t c)
+{
+	return group.slot[c] != perf_group::none;
+}
+
 void CT::start_clock()
 {
-	t1 = clock(); // std::chrono::high_resolution_clock::now();
+	if (timing.counters)
+	{
+		if (!group.tried)
+			group.open();
+		if (group.leader >= 0)
+			group.start();
+	}
+	t1 = std::chrono::steady_clock::now();
+}
+
+auto CT::stop_clock() -> sample
+{
+	sample s;
+	s.ms      = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t1).count();
+	s.counted = group.stop(s.events);
+	if (!s.counted)
+		std::fill(s.events, s.events + hw::count, std::uint64_t(0));
+	return s;
+}
+
+// linear interpolation between the closest ranks of a sorted, non empty sample
+static double quantile(const std::vector<double>& v, double p)
+{
+	double      pos = p * double(v.size() - 1);
+	std::size_t i   = std::size_t(pos);
+	if (i + 1 >= v.size())
+		return v.back();
+	return v[i] + (pos - double(i)) * (v[i + 1] - v[i]);
+}
+
+auto CT::op_times::add(const sample& s, std::size_t n) -> op_times&
+{
+	samples.push_back(s.ms);
+	if (s.counted)
+	{
+		for (std::size_t i = 0; i < hw::count; ++i)
+			events[i] += s.events[i];
+		++counted;
+		elements += n;
+	}
+	return *this;
+}
+
+auto CT::op_times::operator+=(const op_times& other) -> op_times&
+{
+	samples.insert(samples.end(), other.samples.begin(), other.samples.end());
+	for (std::size_t i = 0; i < hw::count; ++i)
+		events[i] += other.events[i];
+	counted += other.counted;
+	elements += other.elements;
+	return *this;
+}
+
+double CT::op_times::total() const
+{
+	double sum = 0.0;
+	for (double x : samples)
+		sum += x;
+	return sum;
 }
 
-double CT::stop_clock()
+std::vector<double> CT::op_times::kept() const
 {
-	auto diff = clock() - t1;
-	return diff * 1000.0 / CLOCKS_PER_SEC;
+	// never drop everything: a single call is still worth reporting
+	std::size_t skip = samples.size() > timing.warmup ? timing.warmup : 0;
+
+	std::vector<double> v(samples.begin() + skip, samples.end());
+	std::sort(v.begin(), v.end());
+	if (timing.reject_outliers && v.size() >= 4)
+	{
+		double q1 = quantile(v, 0.25);
+		double q3 = quantile(v, 0.75);
+		double lo = q1 - 1.5 * (q3 - q1);
+		double hi = q3 + 1.5 * (q3 - q1);
+		v.erase(std::remove_if(v.begin(), v.end(), [lo, hi](double x) { return x < lo || x > hi; }), v.end());
+	}
+	return v;
+}
+
+auto CT::op_times::summary() const -> stats
+{
+	std::vector<double> v = kept();
+	stats               st{v.size(), 0.0, 0.0, 0.0, 0.0, 0.0};
+	if (v.empty())
+		return st;
+
+	st.min    = v.front();
+	st.median = quantile(v, 0.5);
+	st.p90    = quantile(v, 0.9);
+	st.p99    = quantile(v, 0.99);
+
+	if (v.size() > 1)
+	{
+		double mean = 0.0;
+		for (double x : v)
+			mean += x;
+		mean /= double(v.size());
+		double var = 0.0;
+		for (double x : v)
+			var += (x - mean) * (x - mean);
+		st.stddev = std::sqrt(var / double(v.size() - 1));
+	}
+	return st;
+}
+
+void CT::report_events(const std::map<std::string, op_times>& ops, std::size_t name_width)
+{
+	bool any = false;
+	for (auto&& op : ops)
+		any = any || op.second.counted;
+	if (!any)
+		return;
+
+	std::cout << "    " << "events" << space(int(name_width) - 6) << " : " << std::setw(12) << "per";
+	for (std::size_t i = 0; i < hw::count; ++i)
+		std::cout << std::setw(14) << hw::name(i);
+	std::cout << std::setw(8) << "IPC" << "\n";
+
+	for (auto&& op : ops)
+	{
+		const op_times& t = op.second;
+		if (!t.counted)
+			continue;
+		double per = double(t.elements ? t.elements : t.counted);
+		std::cout << "    " << op.first << space(int(name_width - op.first.size())) << " : " << std::setw(12)
+				  << (t.elements ? "element" : "call");
+		for (std::size_t i = 0; i < hw::count; ++i)
+		{
+			if (hw::available(i))
+				std::cout << std::setw(14) << double(t.events[i]) / per;
+			else
+				std::cout << std::setw(14) << "-";
+		}
+		if (hw::available(hw::instructions) && hw::available(hw::cycles) && t.events[hw::cycles])
+			std::cout << std::setw(8) << double(t.events[hw::instructions]) / double(t.events[hw::cycles]);
+		std::cout << "\n";
+	}
+}
+
+// the first template argument of a container name, empty when there is none
+static std::string element_of(const std::string& name)
+{
+	auto b = name.find('<');
+	if (b == std::string::npos)
+		return "";
+	int depth = 0;
+	for (auto i = b + 1; i < name.size(); ++i)
+	{
+		char c = name[i];
+		if (c == '<')
+			++depth;
+		else if (c == '>' && depth)
+			--depth;
+		else if ((c == ',' && !depth) || c == '>')
+			return name.substr(b + 1, i - b - 1);
+	}
+	return name.substr(b + 1);
+}
+
+static std::string json_string(const std::string& str)
+{
+	std::string out = "\"";
+	for (char c : str)
+	{
+		if (c == '"' || c == '\\')
+			out += '\\';
+		out += c;
+	}
+	return out + '"';
+}
+
+static std::string csv_field(const std::string& str)
+{
+	if (str.find_first_of(",\"\n") == std::string::npos)
+		return str;
+	std::string out = "\"";
+	for (char c : str)
+	{
+		if (c == '"')
+			out += '"';
+		out += c;
+	}
+	return out + '"';
+}
+
+void CT::write_json(std::ostream& out)
+{
+	auto prec = out.precision(9);
+	out << "{\n  \"results\": [";
+	const char* sep = "";
+	for (auto&& sz : recorded())
+	{
+		for (auto&& x : sz.second)
+		{
+			for (auto&& y : x.second)
+			{
+				const op_times& t  = y.second;
+				auto            st = t.summary();
+				out << sep << "\n    {\"container\": " << json_string(x.first)
+					<< ", \"element\": " << json_string(element_of(x.first)) << ", \"op\": " << json_string(y.first)
+					<< ", \"size\": " << sz.first << ",\n     \"total_ms\": " << t.total() << ", \"n\": " << st.n
+					<< ", \"min_ms\": " << st.min << ", \"median_ms\": " << st.median << ", \"p90_ms\": " << st.p90
+					<< ", \"p99_ms\": " << st.p99 << ", \"stddev_ms\": " << st.stddev;
+				if (t.counted)
+				{
+					out << ",\n     \"counted\": " << t.counted << ", \"elements\": " << t.elements << ", \"events\": {";
+					const char* esep = "";
+					for (std::size_t i = 0; i < hw::count; ++i)
+						if (hw::available(i))
+						{
+							out << esep << json_string(hw::name(i)) << ": " << t.events[i];
+							esep = ", ";
+						}
+					out << "}";
+				}
+				out << ",\n     \"samples\": [";
+				for (std::size_t i = 0; i < t.samples.size(); ++i)
+					out << (i ? ", " : "") << t.samples[i];
+				out << "]}";
+				sep = ",";
+			}
+		}
+	}
+	out << "\n  ]\n}\n";
+	out.precision(prec);
+}
+
+void CT::write_csv(std::ostream& out)
+{
+	auto prec = out.precision(9);
+	out << "container,element,op,size,sample,ms\n";
+	for (auto&& sz : recorded())
+	{
+		for (auto&& x : sz.second)
+		{
+			std::string front = csv_field(x.first) + "," + csv_field(element_of(x.first)) + ",";
+			for (auto&& y : x.second)
+			{
+				std::string op = csv_field(y.first) + "," + std::to_string(sz.first) + ",";
+				for (std::size_t i = 0; i < y.second.samples.size(); ++i)
+					out << front << op << i << "," << y.second.samples[i] << "\n";
+			}
+		}
+	}
+	out.precision(prec);
+}
+
+// the fields of a csv line, quotes undone
+static std::vector<std::string> csv_split(const std::string& line)
+{
+	std::vector<std::string> fields(1);
+	bool                     quoted = false;
+	for (std::size_t i = 0; i < line.size(); ++i)
+	{
+		char c = line[i];
+		if (quoted)
+		{
+			if (c != '"')
+				fields.back() += c;
+			else if (i + 1 < line.size() && line[i + 1] == '"')
+				fields.back() += line[++i];
+			else
+				quoted = false;
+		}
+		else if (c == '"')
+			quoted = true;
+		else if (c == ',')
+			fields.emplace_back();
+		else if (c != '\r')
+			fields.back() += c;
+	}
+	return fields;
+}
+
+// one sided Mann-Whitney U, normal approximation with tie correction: how likely it is
+// that cur is at least this much slower than base by chance alone
+static double slower_by_chance(const std::vector<double>& base, const std::vector<double>& cur)
+{
+	std::vector<std::pair<double, bool>> all; // time, from cur
+	all.reserve(base.size() + cur.size());
+	for (double x : base)
+		all.emplace_back(x, false);
+	for (double x : cur)
+		all.emplace_back(x, true);
+	std::sort(all.begin(), all.end());
+
+	double rank_sum = 0.0, ties = 0.0;
+	for (std::size_t i = 0; i < all.size();)
+	{
+		std::size_t j = i;
+		while (j < all.size() && all[j].first == all[i].first)
+			++j;
+		double rank = double(i + j + 1) / 2.0; // ranks i+1 .. j share their mean
+		for (std::size_t k = i; k < j; ++k)
+			if (all[k].second)
+				rank_sum += rank;
+		double t = double(j - i);
+		ties += t * t * t - t;
+		i = j;
+	}
+
+	double n1 = double(cur.size()), n2 = double(base.size()), n = n1 + n2;
+	double u     = rank_sum - n1 * (n1 + 1) / 2;
+	double sigma = std::sqrt(n1 * n2 / 12.0 * ((n + 1) - ties / (n * (n - 1))));
+	if (!(sigma > 0))
+		return 1.0;
+	double z = (u - n1 * n2 / 2 - 0.5) / sigma;
+	return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+std::size_t CT::compare_baseline(std::istream& in, const regression_options& opt)
+{
+	std::map<std::size_t, time_table> base;
+
+	std::string line;
+	std::getline(in, line); // header
+	while (std::getline(in, line))
+	{
+		auto f = csv_split(line);
+		if (f.size() == 6)
+			base[std::strtoull(f[3].c_str(), nullptr, 10)][f[0]][f[2]].samples.push_back(
+				std::strtod(f[5].c_str(), nullptr));
+	}
+
+	auto        now         = recorded();
+	std::size_t regressions = 0;
+	for (auto&& sz : base)
+	{
+		auto table = now.find(sz.first);
+		if (table == now.end())
+			continue;
+		for (auto&& x : sz.second)
+		{
+			auto cont = table->second.find(x.first);
+			if (cont == table->second.end())
+				continue;
+			for (auto&& y : x.second)
+			{
+				auto op = cont->second.find(y.first);
+				if (op == cont->second.end())
+					continue;
+
+				auto b = y.second.kept();
+				auto c = op->second.kept();
+				if (b.size() < 2 || c.size() < 2)
+					continue;
+				double bmed = y.second.summary().median;
+				double cmed = op->second.summary().median;
+				if (cmed <= bmed * (1.0 + opt.threshold))
+					continue;
+				double p = slower_by_chance(b, c);
+				if (p >= opt.alpha)
+					continue;
+
+				++regressions;
+				std::cout << "regression: " << x.first << " " << y.first << " size " << sz.first << " median "
+						  << bmed << " -> " << cmed << " ms (+" << (cmed / bmed - 1.0) * 100.0 << "%, p " << p
+						  << ")\n";
+			}
+		}
+	}
+	return regressions;
+}
+
+// a number that is all of str, within [lo, hi]
+static bool parse_number(const char* str, double lo, double hi, double& val)
+{
+	char* end = nullptr;
+	val       = std::strtod(str, &end);
+	return end != str && !*end && val >= lo && val <= hi;
+}
+
+bool CT::parse_args(int argc, char** argv, run_options& opt)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		bool        more = i + 1 < argc;
+		const char* arg  = argv[i];
+		bool        ok   = more;
+		if (more && !std::strcmp(arg, "--json"))
+			opt.json = argv[++i];
+		else if (more && !std::strcmp(arg, "--csv"))
+			opt.csv = argv[++i];
+		else if (more && !std::strcmp(arg, "--baseline"))
+			opt.baseline = argv[++i];
+		else if (more && !std::strcmp(arg, "--threshold"))
+			ok = parse_number(argv[++i], 0.0, HUGE_VAL, opt.regression.threshold);
+		else if (more && !std::strcmp(arg, "--alpha"))
+			ok = parse_number(argv[++i], 0.0, 1.0, opt.regression.alpha);
+		else
+			ok = false;
+		if (!ok)
+		{
+			std::cerr << "usage: " << argv[0]
+					  << " [--json <file>] [--csv <file>] [--baseline <csv> [--threshold <fraction>] [--alpha <p>]]\n";
+			return false;
+		}
+	}
+
+	// found out now rather than after the suites ran. app, so nothing is truncated yet
+	for (const char* out : {opt.json, opt.csv})
+		if (out && !std::ofstream(out, std::ios::app))
+		{
+			std::cerr << "cannot write " << out << "\n";
+			return false;
+		}
+	if (opt.baseline && !std::ifstream(opt.baseline))
+	{
+		std::cerr << "cannot read baseline " << opt.baseline << "\n";
+		return false;
+	}
+	return true;
+}
+
+int CT::finish(const run_options& opt)
+{
+	if (opt.json)
+	{
+		std::ofstream out(opt.json);
+		write_json(out);
+		if (!out)
+		{
+			std::cerr << "cannot write " << opt.json << "\n";
+			return 2;
+		}
+	}
+	if (opt.csv)
+	{
+		std::ofstream out(opt.csv);
+		write_csv(out);
+		if (!out)
+		{
+			std::cerr << "cannot write " << opt.csv << "\n";
+			return 2;
+		}
+	}
+
+	if (!opt.baseline)
+		return 0;
+	std::ifstream in(opt.baseline);
+	if (!in)
+	{
+		std::cerr << "cannot read baseline " << opt.baseline << "\n";
+		return 2;
+	}
+	std::size_t n = compare_baseline(in, opt.regression);
+	std::cout << n << " regression" << (n == 1 ? "" : "s") << " against " << opt.baseline << "\n";
+	return n ? 1 : 0;
 }
@@ -2,6 +2,8 @@
 #include <cassert>
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <iomanip>
 #include <iostream>
 #include <iterator>
 #include <map>
@@ -17,13 +19,82 @@ using namespace std::literals;
 
 namespace CT
 {
+/// <summary>
+/// hardware events counted around every sample while timing.counters is set, through
+/// perf_event_open on linux. an event the machine or the kernel does not offer is left
+/// out, and with none of them the harness times only
+/// </summary>
+struct hw
+{
+	enum counter : std::size_t
+	{
+		instructions,
+		cycles,
+		l1d_misses,
+		llc_misses,
+		branch_misses,
+		dtlb_misses,
+		count
+	};
+
+	static const char* name(std::size_t);
+	static bool        available(std::size_t);
+};
+
+/// <summary>
+/// what stop_clock() measured since start_clock(): the time, and the events when they were counted
+/// </summary>
+struct sample
+{
+	double        ms;
+	bool          counted;
+	std::uint64_t events[hw::count];
+
+	operator double() const { return ms; }
+};
+
 extern void   init();
 extern void   start_clock();
-extern double stop_clock();
+extern sample stop_clock();
 template<typename Excl = void*>
 void report_times(double = 1.0, std::string = "s");
+// keeps time_data for the export, filed under problem_size, and empties it
 void clear_times();
 
+// every sample taken since the start, with the problem_size it was taken at: what
+// clear_times() filed and what time_data holds now. csv has a row per sample:
+// container, element, op, size, sample, ms
+void write_json(std::ostream&);
+void write_csv(std::ostream&);
+
+struct regression_options
+{
+	double threshold = 0.1;  // slowdown of the median that counts, 0.1 is 10%
+	double alpha     = 0.01; // one sided Mann-Whitney significance
+};
+
+// prints the ops of a baseline (as write_csv wrote it) that now have a median slower by
+// more than the threshold at the same size, significantly so; returns how many
+std::size_t compare_baseline(std::istream&, const regression_options& = {});
+
+struct run_options
+{
+	const char*        json     = nullptr;
+	const char*        csv      = nullptr;
+	const char*        baseline = nullptr;
+	regression_options regression;
+
+	bool any() const { return json || csv || baseline; }
+};
+
+// before the suites run: --json <file>, --csv <file>, --baseline <file> [--threshold <fraction>]
+// [--alpha <p>]. false, after printing why, when the command line is not usable
+bool parse_args(int argc, char** argv, run_options&);
+
+// after the suites ran: writes the files and compares with the baseline. returns the
+// exit code, 1 when the comparison found regressions, 2 when a file could not be used
+int finish(const run_options&);
+
 template<typename T>
 std::string nameof(const T&)
 {
@@ -230,6 +301,16 @@ struct reverse
 	void operator()(C1&, Args&...);
 };
 
+template<typename T = void>
+struct move_back
+{
+	void operator()() {}
+	template<typename C1, typename... Args>
+	void operator()(C1&, Args&...);
+
+	static std::string name() { return "move_back"s; }
+};
+
 template<typename T = void>
 struct clear
 {
@@ -256,17 +337,72 @@ private:
 
 namespace CT
 {
-extern std::map<std::string, std::map<std::string, double>> time_data;
-extern std::default_random_engine generator;
+/// <summary>
+/// the times (ms) one operation took on one container, a sample per stop_clock(), in
+/// the order they were taken. the statistics leave out the first timing.warmup samples
+/// and, from 4 samples on, those outside the Tukey fences (1.5 IQR past the quartiles)
+/// </summary>
+struct op_times
+{
+	std::vector<double> samples;
+	std::uint64_t       events[hw::count] = {}; // summed over the counted samples
+	std::size_t         counted           = 0;  // samples that came with events
+	std::size_t         elements          = 0;  // summed over the counted samples, when given
+
+	// elements: how many the operation went through, 0 when unknown
+	op_times& add(const sample& s, std::size_t elements);
+
+	op_times& operator+=(const sample& s) { return add(s, 0); }
+	// the samples of other after these, its events summed in
+	op_times& operator+=(const op_times& other);
+
+	// every sample, warmup included
+	double total() const;
+
+	// sorted samples the statistics are taken over
+	std::vector<double> kept() const;
+
+	struct stats
+	{
+		std::size_t n;
+		double      min, median, p90, p99, stddev;
+	};
+	stats summary() const;
+};
 
-struct ListItem
+struct timing_options
 {
-	std::string name;
-	std::string time;
-	int name_ln;
-	int bef_dot;
-	int aft_dot;
+	std::size_t warmup          = 1; // leading samples left out of the statistics
+	std::size_t repeat          = 1; // samples bench() takes per call
+	bool        reject_outliers = true;
+	bool        counters        = false; // count hardware events around each sample
 };
+
+extern timing_options timing;
+
+extern std::map<std::string, std::map<std::string, op_times>> time_data;
+extern std::size_t                                            problem_size; // written out with the samples, 0 if unset
+extern std::default_random_engine generator;
+
+// the events per element (per call where the elements are unknown) of the ops that counted any
+void report_events(const std::map<std::string, op_times>&, std::size_t name_width);
+
+/// <summary>
+/// times fn timing.repeat times as op on the named container. only for operations
+/// that leave the data as they found it
+/// </summary>
+template<typename F>
+void bench(const std::string& container, const std::string& op, F&& fn)
+{
+	op_times& times = time_data[container][op];
+	for (std::size_t i = 0; i < timing.repeat; ++i)
+	{
+		start_clock();
+		fn();
+		times += stop_clock();
+	}
+}
+
 inline std::string space(int i)
 {
 	if (i < 0)
@@ -286,49 +422,33 @@ void CT::report_times(double multiplyer, std::string unit)
 		if (nameof(Excl{}) != x.first)
 		{
 			std::cout << "Container : " << x.first << std::endl;
+			std::size_t max_name_ln = 2;
+			for (auto&& y : x.second)
+				if (y.first.size() > max_name_ln)
+					max_name_ln = y.first.size();
+			if (x.second.empty())
+				continue;
+
+			std::cout << "    " << "op" << space(int(max_name_ln) - 2) << " : " << std::setw(12) << "total ms"
+					  << std::setw(9) << "n" << std::setw(11) << "min" << std::setw(11) << "median" << std::setw(11)
+					  << "p90" << std::setw(11) << "p99" << std::setw(11) << "stddev" << "\n";
+			auto flags = std::cout.flags();
+			auto prec  = std::cout.precision(3);
+			std::cout << std::fixed;
 			double sum = 0.0;
-			std::vector<ListItem> vli;
 			for (auto&& y : x.second)
 			{
-				ListItem li;
-				li.name    = y.first;
-				li.name_ln = y.first.size();
-				std::stringstream ss;
-				ss << y.second;
-				li.time  = ss.str();
-				auto pos = li.time.find('.');
-				if (pos == std::string::npos)
-				{
-					li.time += ".0";
-					pos = li.time.find('.');
-				}
-				li.bef_dot = pos;
-				li.aft_dot = li.time.size() - pos - 1;
-				vli.push_back(li);
-				sum += y.second;
-			}
-			int sz = vli.size();
-			if (sz)
-			{
-				int max_name_ln = vli[0].name_ln;
-				int max_bef_dot = vli[0].bef_dot;
-				int max_aft_dot = vli[0].aft_dot;
-				for (int i = 1; i < sz; ++i)
-				{
-					if (vli[i].name_ln > max_name_ln)
-						max_name_ln = vli[i].name_ln;
-					if (vli[i].bef_dot > max_bef_dot)
-						max_bef_dot = vli[i].bef_dot;
-					if (vli[i].aft_dot > max_aft_dot)
-						max_aft_dot = vli[i].aft_dot;
-				}
-				for (auto&& li : vli)
-				{
-					std::cout << "    " << li.name << space(max_name_ln - li.name_ln) << " : "
-							  << space(max_bef_dot - li.bef_dot) << li.time << space(max_aft_dot - li.aft_dot) << " ms\n";
-				}
-				std::cout << "Container totals : " << sum * multiplyer / 1000.0 << " " << unit << "\n\n";
+				auto st = y.second.summary();
+				std::cout << "    " << y.first << space(int(max_name_ln - y.first.size())) << " : " << std::setw(12)
+						  << y.second.total() << std::setw(9) << st.n << std::setw(11) << st.min << std::setw(11)
+						  << st.median << std::setw(11) << st.p90 << std::setw(11) << st.p99 << std::setw(11)
+						  << st.stddev << "\n";
+				sum += y.second.total();
 			}
+			report_events(x.second, max_name_ln);
+			std::cout.flags(flags);
+			std::cout.precision(prec);
+			std::cout << "Container totals : " << sum * multiplyer / 1000.0 << " " << unit << "\n\n";
 		}
 	}
 }
@@ -379,7 +499,7 @@ void CT::copy_to<T>::operator()(const C1& from, C2& first, Args&... rest)
 #endif
 		first.push_back(x);
 	}
-	time_data[nameof(first)][name()] += stop_clock();
+	time_data[nameof(first)][name()].add(stop_clock(), from.size());
 	copy_to<>{}(from, rest...);
 }
 
@@ -411,7 +531,7 @@ bool CT::compare<T>::operator()(const C1& orig, const C2& first, const Args&...
 		++i1;
 		++i2; // next items
 	}
-	time_data[nameof(first)][name()] += stop_clock();
+	time_data[nameof(first)][name()].add(stop_clock(), first.size());
 	return compare<>{}(orig, rest...) && eq;
 }
 
@@ -433,7 +553,7 @@ void CT::insert_nth<T>::operator()(std::size_t idx, int val, C1& first, Args&...
 	start_clock();
 	auto itr = CO::nth(first, idx);
 	first.insert(itr, val);
-	time_data[nameof(first)][name()] += stop_clock();
+	time_data[nameof(first)][name()].add(stop_clock(), 1);
 	insert_nth<>{}(idx, val, rest...);
 }
 
@@ -472,7 +592,7 @@ void CT::erase_nth<T>::operator()(std::size_t idx, C1& first, Args&... rest)
 	start_clock();
 	auto itr = CO::nth(first, idx);
 	first.erase(itr);
-	time_data[nameof(first)][name()] += stop_clock();
+	time_data[nameof(first)][name()].add(stop_clock(), 1);
 	erase_nth<>{}(idx, rest...);
 }
 
@@ -498,10 +618,11 @@ void CT::sort_unique<T>::operator()(C1& first, Args&... rest)
 			  << "sort_unique of " << nameof(first) << " (sz:" << first.size() << ")" << clr;
 #endif
 
+	std::size_t n = first.size();
 	start_clock();
 	CO::sort(first);
 	CO::unique(first);
-	time_data[nameof(first)][name()] += stop_clock();
+	time_data[nameof(first)][name()].add(stop_clock(), n);
 	sort_unique<>{}(rest...);
 }
 
@@ -516,7 +637,7 @@ void CT::sort<T>::operator()(C1& first, Args&... rest)
 
 	start_clock();
 	CO::sort(first);
-	time_data[nameof(first)][name()] += stop_clock();
+	time_data[nameof(first)][name()].add(stop_clock(), first.size());
 	CT::sort<>{}(rest...);
 }
 
@@ -528,9 +649,10 @@ void CT::unique<T>::operator()(C1& first, Args&... rest)
 	std::cerr << "attempting: "
 			  << "unique of " << nameof(first) << " (sz:" << first.size() << ")" << clr;
 #endif
+	std::size_t n = first.size();
 	start_clock();
 	CO::unique(first);
-	time_data[nameof(first)][name()] += stop_clock();
+	time_data[nameof(first)][name()].add(stop_clock(), n);
 	CT::unique<>{}(rest...);
 }
 
@@ -552,9 +674,10 @@ template<typename T>
 template<typename Itm, typename C1, typename... Args>
 void CT::remove<T>::operator()(const Itm& itm, C1& first, Args&... rest)
 {
+	std::size_t n = first.size();
 	start_clock();
 	CO::remove(first, itm);
-	time_data[nameof(first)][name()] += stop_clock();
+	time_data[nameof(first)][name()].add(stop_clock(), n);
 	CT::remove<>{}(itm, rest...);
 }
 
@@ -572,9 +695,9 @@ void CT::splice_merge<T>::operator()(C1& first, Args&... rest)
 	auto itr1 = nth(first, idx1);
 	auto itr2 = nth(first, idx2);
 	C1 other;
-	splice(first, itr1, itr2, other, other.begin());
+	splice(first, itr1, itr2, other, other.begin(), idx2 - idx1);
 	merge(first, other);
-	time_data[nameof(first)][name()] += stop_clock();
+	time_data[nameof(first)][name()].add(stop_clock(), first.size());
 	splice_merge<>{}(rest...);
 }
 
@@ -590,7 +713,7 @@ void CT::binary_find_swap<T>::operator()(const Itm& itm1, const Itm& itm2, C1& f
 		using std::swap;
 		swap(*r1.second, *r2.second);
 	}
-	time_data[nameof(first)][name()] += stop_clock();
+	time_data[nameof(first)][name()].add(stop_clock(), 1);
 	binary_find_swap<>{}(itm1, itm2, rest...);
 }
 
@@ -603,7 +726,7 @@ void CT::nth_swap<T>::swp(std::size_t idx1, std::size_t idx2, C1& first, Args&..
 	auto itr2 = nth(first, idx2);
 	using std::swap;
 	std::swap(*itr1, *itr2);
-	time_data[nameof(first)][name()] += stop_clock();
+	time_data[nameof(first)][name()].add(stop_clock(), 1);
 	swp(idx1, idx2, rest...);
 }
 
@@ -629,6 +752,15 @@ void CT::reverse<T>::operator()(C1& first, Args&... args)
 	reverse<>{}(args...);
 }
 
+template<typename T>
+template<typename C1, typename... Args>
+void CT::move_back<T>::operator()(C1& first, Args&... args)
+{
+	C1 tmp(std::move(first));
+	first = std::move(tmp);
+	move_back<>{}(args...);
+}
+
 template<typename T>
 template<typename C1, typename... Args>
 void CT::clear<T>::operator()(C1& first, Args&... args)
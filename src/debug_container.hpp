@@ -1,12 +1,14 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <iostream>
 #include <iterator>
 #include <list>
 #include <memory>
+#include <optional>
 
 template<typename T>
 struct wierd_alloc
@@ -34,10 +36,28 @@ struct wierd_alloc
 		return (T*)malloc(n * sizeof(T));
 	}
 
-	void deallocate(T* ptr, std::size_t n) { free(ptr); }
+	void deallocate(T* ptr, std::size_t) { free(ptr); }
 };
 
-template<typename T, typename Alloc = std::allocator<T>>
+/// <summary>
+/// how much a debug_container checks. one iterator in N is checked, the others are
+/// bare list iterators. with N == 1 (full_checking) every iterator is kept in a list
+/// of the container, and erase and clear walk it to invalidate exactly the iterators
+/// they should. with N > 1 a checked iterator only holds a count on the container and
+/// on its element: an erased element that is still counted is destroyed and its node
+/// set aside until the last of them lets go, so nothing walks the iterators and yet
+/// only those to removed elements are flagged, as with full checking
+/// </summary>
+template<std::size_t N>
+struct sampled_checking
+{
+	static_assert(N > 0, "sampling rate must be positive");
+	constexpr static std::size_t rate = N;
+};
+
+using full_checking = sampled_checking<1>;
+
+template<typename T, typename Alloc = std::allocator<T>, typename Checking = full_checking>
 class debug_container
 {
 public:
@@ -56,10 +76,24 @@ private:
 	struct core_iterator;
 	struct Impl;
 
-	typedef std::list<T, Alloc>              item_list;
-	typedef std::list<core_iterator*, Alloc> iter_list;
+	constexpr static bool sampled = Checking::rate > 1;
 
-	typedef typename Alloc::template rebind<Impl>::other ImplAlloc;
+	// an element, and in sampled mode the checked iterators on it. no value once erased
+	struct slot
+	{
+		template<typename... Args>
+		slot(Args&&... args) : value(std::in_place, std::forward<Args>(args)...)
+		{
+		}
+		std::optional<T> value;
+		std::size_t      refs = 0;
+	};
+
+	typedef std::list<slot, typename std::allocator_traits<Alloc>::template rebind_alloc<slot>> item_list;
+	typedef std::list<core_iterator*, typename std::allocator_traits<Alloc>::template rebind_alloc<core_iterator*>>
+		iter_list;
+
+	typedef typename std::allocator_traits<Alloc>::template rebind_alloc<Impl> ImplAlloc;
 
 	struct core_iterator
 	{
@@ -74,14 +108,16 @@ private:
 		void prev();
 		void move(std::ptrdiff_t off);
 
-	private:
-		Impl*                        cb;
+	protected:
+		Impl*                        cb; // null for an iterator that is not checked
 		typename item_list::iterator iter;
 		bool                         valid;
-		core_iterator(debug_container* owner, typename item_list::iterator iter, bool ok = true)
-			: cb(owner->impl), iter(iter), valid(ok)
-		{
-		}
+		core_iterator(debug_container* owner, typename item_list::iterator iter);
+		bool ok() const;
+		void attach(const core_iterator&);
+		void detach();
+		void hold();
+		void release();
 		friend class debug_container;
 	};
 
@@ -89,20 +125,30 @@ private:
 	core_iterator ci_end() const;
 
 	template<typename... Args>
-	void ci_insert(core_iterator&, Args&&...);
+	core_iterator ci_insert(const core_iterator&, Args&&...);
+
+	core_iterator ci_erase(const core_iterator&);
 
-	void ci_erase(core_iterator&, bool = true);
+	// whether ci belongs to this container, as far as it can tell
+	bool ci_owned(const core_iterator& ci) const { return ci.cb ? ci.cb == impl : ci.valid; }
 
 	struct Impl
 	{
 		item_list        items;
-		iter_list        iters;
+		item_list        graves; // sampled: erased, but checked iterators still on them
+		iter_list        iters;  // full checking: every live iterator
+		std::size_t      refs;   // sampled: live checked iterators
+		std::size_t      tick;   // sampled: iterators handed out
 		unsigned short   usage;
 		unsigned short   state;
 		debug_container* owner;
 		static void      test_self_delete(Impl*);
+		bool             sample();
 		void             addi(core_iterator*);
 		bool             remi(core_iterator*);
+		void             invalidate(typename item_list::iterator);
+		void             invalidate_all();
+		void             remove(typename item_list::iterator);
 	};
 
 	Impl* impl;
@@ -143,30 +189,30 @@ public:
 		iterator() = default;
 		iterator& operator++()
 		{
-			next();
+			this->next();
 			return *this;
 		}
 		iterator& operator--()
 		{
-			prev();
+			this->prev();
 			return *this;
 		}
 		iterator operator++(int)
 		{
 			auto tmp = *this;
-			next();
+			this->next();
 			return tmp;
 		}
 		iterator operator--(int)
 		{
 			auto tmp = *this;
-			prev();
+			this->prev();
 			return tmp;
 		}
-		T&   operator*() { return *item(); }
-		T*   operator->() { return item(); }
-		bool operator==(const iterator& other) const { return iter == other.iter; }
-		bool operator!=(const iterator& other) const { return iter != other.iter; }
+		T&   operator*() { return *this->item(); }
+		T*   operator->() { return this->item(); }
+		bool operator==(const iterator& other) const { return this->iter == other.iter; }
+		bool operator!=(const iterator& other) const { return this->iter != other.iter; }
 
 	private:
 		iterator(debug_container* owner, typename item_list::iterator iter) : core_iterator(owner, iter) {}
@@ -179,33 +225,34 @@ public:
 		const_iterator() = default;
 		const_iterator& operator++()
 		{
-			next();
+			this->next();
 			return *this;
 		}
 		const_iterator& operator--()
 		{
-			prev();
+			this->prev();
 			return *this;
 		}
 		const_iterator operator++(int)
 		{
 			auto tmp = *this;
-			next();
+			this->next();
 			return tmp;
 		}
 		const_iterator operator--(int)
 		{
 			auto tmp = *this;
-			prev();
+			this->prev();
 			return tmp;
 		}
-		const T& operator*() { return *item(); }
-		const T* operator->() { return item(); }
-		bool     operator==(const const_iterator& other) const { return iter == other.iter; }
-		bool     operator!=(const const_iterator& other) const { return iter != other.iter; }
+		const T& operator*() { return *this->item(); }
+		const T* operator->() { return this->item(); }
+		bool     operator==(const const_iterator& other) const { return this->iter == other.iter; }
+		bool     operator!=(const const_iterator& other) const { return this->iter != other.iter; }
 
 	private:
 		const_iterator(debug_container* owner, typename item_list::iterator iter) : core_iterator(owner, iter) {}
+		const_iterator(const core_iterator& ci) : core_iterator(ci) {}
 		friend class debug_container;
 	};
 
@@ -218,7 +265,7 @@ public:
 	const_iterator cend() const;
 
 	iterator erase(iterator);
-	iterator insert(iterator, T&);
+	iterator insert(iterator, const T&);
 	iterator insert(iterator, T&&);
 
 	template<typename... Args>
@@ -229,36 +276,57 @@ public:
 	iterator emplace_front(Args&&... args);
 };
 
-template<typename T, typename A>
-auto debug_container<T, A>::new_block() -> Impl*
+template<typename T, typename A, typename C>
+auto debug_container<T, A, C>::new_block() -> Impl*
 {
 	Impl* pimpl = ImplAlloc{}.allocate(1);
 	new (pimpl) Impl;
+	pimpl->refs  = 0;
+	pimpl->tick  = 0;
 	pimpl->usage = 0;
 	pimpl->state = 0;
 	pimpl->owner = this;
 	return pimpl;
 }
 
-template<typename T, typename A>
-void debug_container<T, A>::Impl::test_self_delete(Impl* pimpl)
+template<typename T, typename A, typename C>
+void debug_container<T, A, C>::Impl::test_self_delete(Impl* pimpl)
 {
-	if (pimpl->items.empty() && pimpl->iters.empty() && !pimpl->owner)
+	if (pimpl->items.empty() && pimpl->iters.empty() && !pimpl->refs && !pimpl->owner)
 	{
 		pimpl->~Impl();
 		ImplAlloc{}.deallocate(pimpl, 1);
 	}
 }
 
-template<typename T, typename A>
-void debug_container<T, A>::Impl::addi(core_iterator* ci)
+template<typename T, typename A, typename C>
+bool debug_container<T, A, C>::Impl::sample()
 {
-	iters.push_back(ci);
+	if constexpr (sampled)
+		return ++tick % C::rate == 0;
+	else
+		return true;
 }
 
-template<typename T, typename A>
-bool debug_container<T, A>::Impl::remi(core_iterator* ci)
+template<typename T, typename A, typename C>
+void debug_container<T, A, C>::Impl::addi(core_iterator* ci)
 {
+	if constexpr (sampled)
+		++refs;
+	else
+		iters.push_back(ci);
+}
+
+template<typename T, typename A, typename C>
+bool debug_container<T, A, C>::Impl::remi(core_iterator* ci)
+{
+	if constexpr (sampled)
+	{
+		assert(refs);
+		--refs;
+		return true;
+	}
+
 	auto b   = iters.begin();
 	auto e   = iters.end();
 	auto pos = std::find(b, e, ci);
@@ -273,256 +341,449 @@ bool debug_container<T, A>::Impl::remi(core_iterator* ci)
 	}
 }
 
-template<typename T, typename A>
-debug_container<T, A>::core_iterator::core_iterator() : cb(nullptr), valid(false)
+template<typename T, typename A, typename C>
+void debug_container<T, A, C>::Impl::invalidate(typename item_list::iterator pos)
 {
+	for (auto&& x : iters)
+		if (x->iter == pos)
+			x->valid = false;
 }
 
-template<typename T, typename A>
-debug_container<T, A>::core_iterator::core_iterator(const core_iterator& other)
+template<typename T, typename A, typename C>
+void debug_container<T, A, C>::Impl::invalidate_all()
 {
-	valid = other.valid;
-	cb    = other.cb;
-	iter  = other.iter;
-	if (cb)
-		cb->addi(this);
+	for (auto&& x : iters)
+		x->valid = false;
 }
 
-template<typename T, typename A>
-debug_container<T, A>::core_iterator::core_iterator(core_iterator&& other)
+/// <summary>
+/// erase one element. sampled, a node with checked iterators on it goes to the graves
+/// without its value, and the last of them to let go frees it
+/// </summary>
+template<typename T, typename A, typename C>
+void debug_container<T, A, C>::Impl::remove(typename item_list::iterator pos)
 {
-	valid = other.valid;
-	cb    = other.cb;
-	iter  = other.iter;
-	if (cb)
+	if constexpr (sampled)
 	{
-		if (!cb->remi(&other))
-			throw "internal library error";
-		cb->addi(this);
-		other.valid = false;
-		other.cb    = nullptr;
+		if (pos->refs)
+		{
+			pos->value.reset();
+			graves.splice(graves.end(), items, pos);
+			return;
+		}
 	}
+	else
+		invalidate(pos);
+	items.erase(pos);
 }
 
-template<typename T, typename A>
-auto debug_container<T, A>::core_iterator::operator=(const core_iterator& other) -> core_iterator&
+template<typename T, typename A, typename C>
+debug_container<T, A, C>::core_iterator::core_iterator() : cb(nullptr), valid(false)
 {
-	if (cb)
-		cb->remi(this);
-	valid = other.valid;
-	cb    = other.cb;
-	iter  = other.iter;
-	if (cb)
+}
+
+template<typename T, typename A, typename C>
+debug_container<T, A, C>::core_iterator::core_iterator(debug_container* owner, typename item_list::iterator iter)
+	: cb(nullptr), iter(iter), valid(true)
+{
+	Impl* pimpl = owner->impl;
+	if (pimpl->sample())
+	{
+		cb = pimpl;
 		cb->addi(this);
+		hold();
+	}
+}
+
+template<typename T, typename A, typename C>
+debug_container<T, A, C>::core_iterator::core_iterator(const core_iterator& other) : cb(nullptr)
+{
+	attach(other);
+}
+
+template<typename T, typename A, typename C>
+debug_container<T, A, C>::core_iterator::core_iterator(core_iterator&& other) : cb(nullptr)
+{
+	attach(other);
+	other.detach();
+}
+
+template<typename T, typename A, typename C>
+auto debug_container<T, A, C>::core_iterator::operator=(const core_iterator& other) -> core_iterator&
+{
+	if (this != &other)
+	{
+		detach();
+		attach(other);
+	}
 	return *this;
 }
 
-template<typename T, typename A>
-auto debug_container<T, A>::core_iterator::operator=(core_iterator&& other) -> core_iterator&
+template<typename T, typename A, typename C>
+auto debug_container<T, A, C>::core_iterator::operator=(core_iterator&& other) -> core_iterator&
+{
+	if (this != &other)
+	{
+		detach();
+		attach(other);
+		other.detach();
+	}
+	return *this;
+}
+
+template<typename T, typename A, typename C>
+debug_container<T, A, C>::core_iterator::~core_iterator()
+{
+	detach();
+}
+
+template<typename T, typename A, typename C>
+void debug_container<T, A, C>::core_iterator::attach(const core_iterator& other)
 {
-	auto old_cb = cb;
-	if (cb)
-		cb->remi(this);
 	valid = other.valid;
 	cb    = other.cb;
 	iter  = other.iter;
 	if (cb)
 	{
-		cb->remi(&other);
 		cb->addi(this);
-		other.valid = false;
-		other.cb    = nullptr;
+		hold();
 	}
+}
 
-	if (old_cb && !cb)
+template<typename T, typename A, typename C>
+void debug_container<T, A, C>::core_iterator::detach()
+{
+	if (cb)
 	{
-		Impl::test_self_delete(old_cb);
+		release();
+		Impl* old = cb;
+		cb        = nullptr;
+		if (!old->remi(this))
+			assert(!"internal library error");
+		Impl::test_self_delete(old);
 	}
+	valid = false;
+}
 
-	return *this;
+// sampled: count a checked iterator on its element (end has none)
+template<typename T, typename A, typename C>
+void debug_container<T, A, C>::core_iterator::hold()
+{
+	if constexpr (sampled)
+		if (cb && iter != cb->items.end())
+			++iter->refs;
 }
 
-template<typename T, typename A>
-debug_container<T, A>::core_iterator::~core_iterator()
+template<typename T, typename A, typename C>
+void debug_container<T, A, C>::core_iterator::release()
 {
-	if (cb)
-	{
-		cb->remi(this);
-		Impl::test_self_delete(cb);
-	}
+	if constexpr (sampled)
+		if (cb && iter != cb->items.end() && !--iter->refs && !iter->value)
+			cb->graves.erase(iter);
+}
+
+template<typename T, typename A, typename C>
+bool debug_container<T, A, C>::core_iterator::ok() const
+{
+	if constexpr (sampled)
+		return valid && (!cb || (cb->owner && (iter == cb->items.end() || iter->value)));
+	else
+		return valid;
 }
 
-template<typename T, typename A>
-void debug_container<T, A>::ci_erase(core_iterator& ci, bool mustexist)
+template<typename T, typename A, typename C>
+T* debug_container<T, A, C>::core_iterator::item() const
 {
-	assert(impl == ci.cb);
-	assert(ci.valid);
-	bool ok = impl->remi(&ci);
-	assert(ok || !mustexist);
-	ci.valid = false;
-	ci.cb    = nullptr;
-	impl->items.erase(ci.iter);
+	assert(ok());
+	return &*iter->value;
 }
 
-template<typename T, typename A>
-auto debug_container<T, A>::ci_begin() const -> core_iterator
+template<typename T, typename A, typename C>
+void debug_container<T, A, C>::core_iterator::next()
+{
+	assert(ok());
+	release();
+	++iter;
+	hold();
+}
+
+template<typename T, typename A, typename C>
+void debug_container<T, A, C>::core_iterator::prev()
+{
+	assert(ok());
+	release();
+	--iter;
+	hold();
+}
+
+template<typename T, typename A, typename C>
+void debug_container<T, A, C>::core_iterator::move(std::ptrdiff_t off)
+{
+	assert(ok());
+	release();
+	std::advance(iter, off);
+	hold();
+}
+
+template<typename T, typename A, typename C>
+auto debug_container<T, A, C>::ci_begin() const -> core_iterator
 {
 	assert(impl);
 	return core_iterator((debug_container*)this, impl->items.begin());
 }
 
-template<typename T, typename A>
-auto debug_container<T, A>::ci_end() const -> core_iterator
+template<typename T, typename A, typename C>
+auto debug_container<T, A, C>::ci_end() const -> core_iterator
 {
 	assert(impl);
 	return core_iterator((debug_container*)this, impl->items.end());
 }
 
-template<typename T, typename A>
-void debug_container<T, A>::clear()
+template<typename T, typename A, typename C>
+template<typename... Args>
+auto debug_container<T, A, C>::ci_insert(const core_iterator& ci, Args&&... args) -> core_iterator
 {
-	for (auto&& x : impl->iters)
-		x->valid = false;
+	assert(impl);
+	assert(ci_owned(ci));
+	assert(ci.ok());
+	return core_iterator(this, impl->items.emplace(ci.iter, std::forward<Args>(args)...));
+}
 
-	while (!empty())
-		ci_erase(ci_begin(), false);
+template<typename T, typename A, typename C>
+auto debug_container<T, A, C>::ci_erase(const core_iterator& ci) -> core_iterator
+{
+	assert(impl);
+	assert(ci_owned(ci));
+	assert(ci.ok());
+	assert(ci.iter != impl->items.end());
+	auto next = std::next(ci.iter);
+	impl->remove(ci.iter);
+	return core_iterator(this, next);
 }
 
-template<typename T, typename A>
-bool debug_container<T, A>::empty() const
+template<typename T, typename A, typename C>
+void debug_container<T, A, C>::clear()
+{
+	if constexpr (sampled)
+	{
+		while (!impl->items.empty())
+			impl->remove(impl->items.begin());
+	}
+	else
+	{
+		impl->invalidate_all();
+		impl->items.clear();
+	}
+}
+
+template<typename T, typename A, typename C>
+std::size_t debug_container<T, A, C>::size() const
+{
+	assert(impl);
+	return impl->items.size();
+}
+
+template<typename T, typename A, typename C>
+bool debug_container<T, A, C>::empty() const
 {
 	assert(impl);
 	return impl->items.empty();
 }
 
-template<typename T, typename A>
-T* debug_container<T, A>::core_iterator::item() const
+template<typename T, typename A, typename C>
+template<typename It>
+auto debug_container<T, A, C>::assign(It b, It e) -> decltype(++b, *b, b != e, void())
 {
-	assert(valid);
-	return &*iter;
+	clear();
+	for (; b != e; ++b)
+		impl->items.emplace_back(*b);
 }
 
-template<typename T, typename A>
-void debug_container<T, A>::core_iterator::next()
+template<typename T, typename A, typename C>
+void debug_container<T, A, C>::assign(std::size_t n, const T& item)
 {
-	assert(valid);
-	++iter;
+	clear();
+	for (; n; --n)
+		impl->items.emplace_back(item);
 }
 
-template<typename T, typename A>
-void debug_container<T, A>::core_iterator::prev()
+template<typename T, typename A, typename C>
+void debug_container<T, A, C>::push_back(const T& item)
 {
-	assert(valid);
-	--iter;
+	impl->items.emplace_back(item);
 }
 
-template<typename T, typename A>
-void debug_container<T, A>::core_iterator::move(std::ptrdiff_t off)
+template<typename T, typename A, typename C>
+void debug_container<T, A, C>::push_back(T&& item)
 {
-	std::advance(iter, off);
+	impl->items.emplace_back(std::move(item));
 }
 
-template<typename T, typename A>
-template<typename... Args>
-void debug_container<T, A>::ci_insert(core_iterator& ci, Args&&... args)
+template<typename T, typename A, typename C>
+void debug_container<T, A, C>::push_front(const T& item)
 {
-	auto iter = ci.iter;
-	assert(ci.cb == impl);
-	assert(ci.valid);
-	assert(impl);
-	impl->items.emplace(iter, std::forward<Args>(args)...);
+	impl->items.emplace_front(item);
 }
 
-template<typename T, typename A>
-void debug_container<T, A>::push_back(const T& item)
+template<typename T, typename A, typename C>
+void debug_container<T, A, C>::push_front(T&& item)
 {
-	ci_insert(ci_end(), item);
+	impl->items.emplace_front(std::move(item));
 }
 
-template<typename T, typename A>
-void debug_container<T, A>::push_back(T&& item)
+template<typename T, typename A, typename C>
+T& debug_container<T, A, C>::back()
 {
-	ci_insert(ci_end(), std::move(item));
+	assert(!empty());
+	return *impl->items.back().value;
 }
 
-template<typename T, typename A>
-auto debug_container<T, A>::begin() -> iterator
+template<typename T, typename A, typename C>
+T& debug_container<T, A, C>::front()
 {
-	return {ci_begin()};
+	assert(!empty());
+	return *impl->items.front().value;
 }
 
-template<typename T, typename A>
-auto debug_container<T, A>::end() -> iterator
+template<typename T, typename A, typename C>
+const T& debug_container<T, A, C>::back() const
 {
-	return {ci_end()};
+	assert(!empty());
+	return *impl->items.back().value;
 }
 
-template<typename T, typename A>
-debug_container<T, A>::debug_container()
+template<typename T, typename A, typename C>
+const T& debug_container<T, A, C>::front() const
+{
+	assert(!empty());
+	return *impl->items.front().value;
+}
+
+template<typename T, typename A, typename C>
+auto debug_container<T, A, C>::begin() -> iterator
+{
+	return iterator(this, impl->items.begin());
+}
+
+template<typename T, typename A, typename C>
+auto debug_container<T, A, C>::end() -> iterator
+{
+	return iterator(this, impl->items.end());
+}
+
+template<typename T, typename A, typename C>
+auto debug_container<T, A, C>::begin() const -> const_iterator
+{
+	return const_iterator((debug_container*)this, impl->items.begin());
+}
+
+template<typename T, typename A, typename C>
+auto debug_container<T, A, C>::end() const -> const_iterator
+{
+	return const_iterator((debug_container*)this, impl->items.end());
+}
+
+template<typename T, typename A, typename C>
+auto debug_container<T, A, C>::cbegin() const -> const_iterator
+{
+	return begin();
+}
+
+template<typename T, typename A, typename C>
+auto debug_container<T, A, C>::cend() const -> const_iterator
+{
+	return end();
+}
+
+template<typename T, typename A, typename C>
+auto debug_container<T, A, C>::erase(iterator pos) -> iterator
+{
+	return ci_erase(pos);
+}
+
+template<typename T, typename A, typename C>
+auto debug_container<T, A, C>::insert(iterator pos, const T& item) -> iterator
+{
+	return ci_insert(pos, item);
+}
+
+template<typename T, typename A, typename C>
+auto debug_container<T, A, C>::insert(iterator pos, T&& item) -> iterator
+{
+	return ci_insert(pos, std::move(item));
+}
+
+template<typename T, typename A, typename C>
+template<typename... Args>
+auto debug_container<T, A, C>::emplace(iterator pos, Args&&... args) -> iterator
+{
+	return ci_insert(pos, std::forward<Args>(args)...);
+}
+
+template<typename T, typename A, typename C>
+template<typename... Args>
+auto debug_container<T, A, C>::emplace_back(Args&&... args) -> iterator
+{
+	impl->items.emplace_back(std::forward<Args>(args)...);
+	return iterator(this, std::prev(impl->items.end()));
+}
+
+template<typename T, typename A, typename C>
+template<typename... Args>
+auto debug_container<T, A, C>::emplace_front(Args&&... args) -> iterator
+{
+	impl->items.emplace_front(std::forward<Args>(args)...);
+	return iterator(this, impl->items.begin());
+}
+
+template<typename T, typename A, typename C>
+debug_container<T, A, C>::debug_container()
 {
 	impl = new_block();
 }
 
-template<typename T, typename A>
-debug_container<T, A>::debug_container(const debug_container& other)
+template<typename T, typename A, typename C>
+debug_container<T, A, C>::debug_container(const debug_container& other)
 {
 	impl = new_block();
-	clear();
 	assign(other.begin(), other.end());
 }
 
-template<typename T, typename A>
-debug_container<T, A>::debug_container(debug_container&& other) : debug_container()
+template<typename T, typename A, typename C>
+debug_container<T, A, C>::debug_container(debug_container&& other) : debug_container()
 {
 	swap(other);
 }
 
-template<typename T, typename A>
-debug_container<T, A>::~debug_container()
+template<typename T, typename A, typename C>
+debug_container<T, A, C>::~debug_container()
 {
 	clear();
 	impl->owner = nullptr;
 	Impl::test_self_delete(impl);
 }
 
-template<typename T, typename A>
-auto debug_container<T, A>::operator=(const debug_container&) -> debug_container&
+template<typename T, typename A, typename C>
+auto debug_container<T, A, C>::operator=(const debug_container& other) -> debug_container&
 {
+	if (this != &other)
+		assign(other.begin(), other.end());
 	return *this;
 }
 
-template<typename T, typename A>
-auto debug_container<T, A>::operator=(debug_container&& other) noexcept -> debug_container&
+template<typename T, typename A, typename C>
+auto debug_container<T, A, C>::operator=(debug_container&& other) noexcept -> debug_container&
 {
 	swap(other);
 	return *this;
 }
 
-template<typename T, typename A>
-void debug_container<T, A>::swap(debug_container& other) noexcept
+// the blocks change hands with the elements, so the iterators follow without being visited
+template<typename T, typename A, typename C>
+void debug_container<T, A, C>::swap(debug_container& other) noexcept
 {
-	assert(impl && other.impl) using std::swap;
-	swap(impl->items, other.impl->items);
-	swap(impl->iters, other.impl->iters);
-	swap(impl->usage, other.impl->usage);
-	swap(impl->state, other.impl->state);
-
-	for (auto&& x : impl->iters)
-	{
-		if (x.cb == other.impl)
-			x.cb = impl;
-	}
-
-	for (auto&& x : other.impl->iters)
-	{
-		if (x.cb == impl)
-			x.cb = other.impl;
-	}
-}
-
-void foo()
-{
-	std::list<int, wierd_alloc<int>> sliwat;
-
-	sliwat.push_back(3);
+	assert(impl && other.impl);
+	std::swap(impl, other.impl);
+	impl->owner       = this;
+	other.impl->owner = &other;
 }
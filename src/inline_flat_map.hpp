@@ -0,0 +1,554 @@
+
+#pragma once
+
+// -------------------------------------------------------------------------------------------------------------
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "inline_vector.hpp"
+
+// -------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// lower bound in a sorted array, the search behind inline_flat_map and inline_flat_set.
+/// arithmetic keys under std::less are counted: keys below k in blocks of 32 bytes, each
+/// block one compare-and-add the compiler turns into vector code, stopping at the first
+/// block not all below k. that beats any search up to a few dozen keys.
+/// past linear_limit keys, and for other keys and orders, a branchless binary search:
+/// the halving step is a conditional move, so nothing waits on a mispredict
+/// </summary>
+template<typename K, typename Compare>
+struct inline_flat_search
+{
+	constexpr static bool linear = std::is_arithmetic<K>::value &&
+		(std::is_same<Compare, std::less<K>>::value || std::is_same<Compare, std::less<>>::value);
+
+	constexpr static std::size_t lanes        = 32 / sizeof(K) < 4 ? 4 : 32 / sizeof(K);
+	constexpr static std::size_t linear_limit = 64;
+
+	static std::size_t lower_bound(const K* p, std::size_t n, const K& k)
+	{
+		if constexpr (linear)
+		{
+			if (n <= linear_limit)
+				return count_below(p, n, k);
+		}
+		return binary(p, n, k);
+	}
+
+	static std::size_t count_below(const K* p, std::size_t n, const K& k)
+	{
+		std::size_t i = 0;
+		for (; i + lanes <= n; i += lanes)
+		{
+			unsigned c = 0;
+			for (std::size_t j = 0; j < lanes; ++j)
+				c += p[i + j] < k;
+			if (c != lanes)
+				return i + c;
+		}
+		for (; i < n && p[i] < k; ++i)
+			;
+		return i;
+	}
+
+	static std::size_t binary(const K* p, std::size_t n, const K& k)
+	{
+		if (!n)
+			return 0;
+		Compare  comp;
+		const K* base = p;
+		while (n > 1)
+		{
+			std::size_t half = n / 2;
+			base             = comp(base[half], k) ? base + half : base;
+			n -= half;
+		}
+		return (base - p) + comp(*base, k);
+	}
+};
+
+// -------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// sorted map for a handful of entries, keys and values in two inline_vectors (SoA), so a
+/// lookup only touches the keys. up to N entries live inside the object, more spill to
+/// the heap. inserting and erasing move the entries behind, O(n). Compare is default
+/// constructed where needed, so it must be stateless.
+/// iterators are invalidated by every insert and erase
+/// </summary>
+template<typename K, typename V, std::size_t N, typename Compare = std::less<K>>
+class inline_flat_map
+{
+	typedef inline_flat_search<K, Compare> search;
+
+public:
+	// types
+	typedef K           key_type;
+	typedef V           mapped_type;
+	typedef Compare     key_compare;
+	typedef std::size_t size_type;
+
+	template<bool Const>
+	class iter;
+	typedef iter<false> iterator;
+	typedef iter<true>  const_iterator;
+
+	// construction
+	inline_flat_map() = default;
+	inline_flat_map(std::initializer_list<std::pair<K, V>>);
+
+	// size
+	size_type          size() const { return ks.size(); }
+	[[nodiscard]] bool empty() const { return ks.empty(); }
+	void               reserve(size_type n);
+	void               clear();
+
+	// iteration
+	iterator       begin() { return iterator(ks.data(), vs.data()); }
+	const_iterator begin() const { return const_iterator(ks.data(), vs.data()); }
+	iterator       end() { return begin() + size(); }
+	const_iterator end() const { return begin() + size(); }
+
+	// the keys, sorted, and the values in the same order
+	const inline_vector<K, N>& keys() const { return ks; }
+	const inline_vector<V, N>& values() const { return vs; }
+	V*                         values_data() { return vs.data(); }
+
+	// lookup
+	size_type      lower_index(const K& k) const { return search::lower_bound(ks.data(), ks.size(), k); }
+	iterator       lower_bound(const K& k) { return begin() + lower_index(k); }
+	const_iterator lower_bound(const K& k) const { return begin() + lower_index(k); }
+	iterator       find(const K& k);
+	const_iterator find(const K& k) const;
+	bool           contains(const K& k) const { return find(k) != end(); }
+	size_type      count(const K& k) const { return contains(k); }
+	V&             at(const K& k);
+	const V&       at(const K& k) const;
+	V&             operator[](const K& k);
+
+	// modifiers
+	std::pair<iterator, bool> insert(const K& k, const V& v);
+	std::pair<iterator, bool> insert(const std::pair<K, V>& kv) { return insert(kv.first, kv.second); }
+	std::pair<iterator, bool> insert_or_assign(const K& k, const V& v);
+	template<typename It>
+	void insert_sorted_range(It, It);
+
+	iterator  erase(const_iterator);
+	size_type erase(const K& k);
+
+private:
+	bool matches(size_type i, const K& k) const { return i < ks.size() && !Compare{}(k, ks[i]); }
+
+	iterator insert_at(size_type i, const K& k, const V& v);
+
+	inline_vector<K, N> ks;
+	inline_vector<V, N> vs;
+};
+
+/// <summary>
+/// iterator over both arrays at once, dereferences to a pair of references
+/// </summary>
+template<typename K, typename V, std::size_t N, typename Compare>
+template<bool Const>
+class inline_flat_map<K, V, N, Compare>::iter
+{
+	friend class inline_flat_map;
+	typedef std::conditional_t<Const, const V, V> VT;
+
+	iter(const K* k, VT* v) : k(k), v(v) {}
+
+public:
+	typedef std::random_access_iterator_tag iterator_category;
+	typedef std::pair<const K&, VT&>        value_type;
+	typedef std::pair<const K&, VT&>        reference;
+	typedef std::ptrdiff_t                  difference_type;
+
+	struct pointer
+	{
+		reference  r;
+		reference* operator->() { return &r; }
+	};
+
+	iter() = default;
+	iter(const iter<false>& o) : k(o.k), v(o.v) {}
+
+	const K& key() const { return *k; }
+	VT&      value() const { return *v; }
+
+	reference operator*() const { return {*k, *v}; }
+	pointer   operator->() const { return {{*k, *v}}; }
+
+	iter& operator++()
+	{
+		++k, ++v;
+		return *this;
+	}
+	iter& operator--()
+	{
+		--k, --v;
+		return *this;
+	}
+	iter operator++(int)
+	{
+		iter t = *this;
+		++*this;
+		return t;
+	}
+	iter operator--(int)
+	{
+		iter t = *this;
+		--*this;
+		return t;
+	}
+	iter& operator+=(difference_type d)
+	{
+		k += d, v += d;
+		return *this;
+	}
+	iter& operator-=(difference_type d) { return *this += -d; }
+	iter  operator+(difference_type d) const { return iter(k + d, v + d); }
+	iter  operator-(difference_type d) const { return iter(k - d, v - d); }
+
+	difference_type operator-(const iter& o) const { return k - o.k; }
+
+	bool operator==(const iter& o) const { return k == o.k; }
+	bool operator!=(const iter& o) const { return k != o.k; }
+	bool operator<(const iter& o) const { return k < o.k; }
+
+private:
+	template<bool>
+	friend class iter;
+
+	const K* k = nullptr;
+	VT*      v = nullptr;
+};
+
+// -------------------------------------------------------------------------------------------------------------
+
+template<typename K, typename V, std::size_t N, typename Compare>
+inline_flat_map<K, V, N, Compare>::inline_flat_map(std::initializer_list<std::pair<K, V>> il)
+{
+	reserve(il.size());
+	for (auto& kv : il)
+		insert(kv);
+}
+
+template<typename K, typename V, std::size_t N, typename Compare>
+void inline_flat_map<K, V, N, Compare>::reserve(size_type n)
+{
+	ks.reserve(n);
+	vs.reserve(n);
+}
+
+template<typename K, typename V, std::size_t N, typename Compare>
+void inline_flat_map<K, V, N, Compare>::clear()
+{
+	ks.clear();
+	vs.clear();
+}
+
+template<typename K, typename V, std::size_t N, typename Compare>
+auto inline_flat_map<K, V, N, Compare>::find(const K& k) -> iterator
+{
+	size_type i = lower_index(k);
+	return matches(i, k) ? begin() + i : end();
+}
+
+template<typename K, typename V, std::size_t N, typename Compare>
+auto inline_flat_map<K, V, N, Compare>::find(const K& k) const -> const_iterator
+{
+	size_type i = lower_index(k);
+	return matches(i, k) ? begin() + i : end();
+}
+
+template<typename K, typename V, std::size_t N, typename Compare>
+V& inline_flat_map<K, V, N, Compare>::at(const K& k)
+{
+	size_type i = lower_index(k);
+	if (!matches(i, k))
+		throw std::out_of_range("inline_flat_map::at");
+	return vs[i];
+}
+
+template<typename K, typename V, std::size_t N, typename Compare>
+const V& inline_flat_map<K, V, N, Compare>::at(const K& k) const
+{
+	size_type i = lower_index(k);
+	if (!matches(i, k))
+		throw std::out_of_range("inline_flat_map::at");
+	return vs[i];
+}
+
+template<typename K, typename V, std::size_t N, typename Compare>
+V& inline_flat_map<K, V, N, Compare>::operator[](const K& k)
+{
+	size_type i = lower_index(k);
+	if (!matches(i, k))
+		insert_at(i, k, V{});
+	return vs[i];
+}
+
+/// <summary>
+/// key and value go in at i, or neither does
+/// </summary>
+template<typename K, typename V, std::size_t N, typename Compare>
+auto inline_flat_map<K, V, N, Compare>::insert_at(size_type i, const K& k, const V& v) -> iterator
+{
+	ks.insert(ks.begin() + i, k);
+	try
+	{
+		vs.insert(vs.begin() + i, v);
+	}
+	catch (...)
+	{
+		ks.erase(ks.begin() + i);
+		throw;
+	}
+	return begin() + i;
+}
+
+template<typename K, typename V, std::size_t N, typename Compare>
+auto inline_flat_map<K, V, N, Compare>::insert(const K& k, const V& v) -> std::pair<iterator, bool>
+{
+	size_type i = lower_index(k);
+	if (matches(i, k))
+		return {begin() + i, false};
+	return {insert_at(i, k, v), true};
+}
+
+template<typename K, typename V, std::size_t N, typename Compare>
+auto inline_flat_map<K, V, N, Compare>::insert_or_assign(const K& k, const V& v) -> std::pair<iterator, bool>
+{
+	size_type i = lower_index(k);
+	if (matches(i, k))
+	{
+		vs[i] = v;
+		return {begin() + i, false};
+	}
+	return {insert_at(i, k, v), true};
+}
+
+/// <summary>
+/// add the (key, value) pairs of a range sorted by key, in one O(n + m) merge.
+/// as with insert, keys already in the map keep their value, and of equal keys
+/// in the range the first one wins. a range all past the last key is appended
+/// </summary>
+template<typename K, typename V, std::size_t N, typename Compare>
+template<typename It>
+void inline_flat_map<K, V, N, Compare>::insert_sorted_range(It b, It e)
+{
+	Compare comp;
+	if (b == e)
+		return;
+	if (empty() || comp(ks.back(), (*b).first))
+	{
+		for (; b != e; ++b)
+		{
+			if (!empty() && !comp(ks.back(), (*b).first))
+				continue;
+			ks.push_back((*b).first);
+			try
+			{
+				vs.push_back((*b).second);
+			}
+			catch (...)
+			{
+				ks.pop_back();
+				throw;
+			}
+		}
+		return;
+	}
+
+	inline_vector<K, N> mk;
+	inline_vector<V, N> mv;
+	if constexpr (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>::value)
+	{
+		mk.reserve(size() + std::distance(b, e));
+		mv.reserve(size() + std::distance(b, e));
+	}
+	size_type i = 0, n = size();
+	auto      put = [&](const K& k, const V& v) {
+		if (!mk.empty() && !comp(mk.back(), k))
+			return;
+		mk.push_back(k);
+		mv.push_back(v);
+	};
+	for (; b != e; ++b)
+	{
+		const K& k = (*b).first;
+		for (; i < n && !comp(k, ks[i]); ++i)
+			put(ks[i], vs[i]);
+		put(k, (*b).second);
+	}
+	for (; i < n; ++i)
+		put(ks[i], vs[i]);
+	ks.swap(mk);
+	vs.swap(mv);
+}
+
+template<typename K, typename V, std::size_t N, typename Compare>
+auto inline_flat_map<K, V, N, Compare>::erase(const_iterator where) -> iterator
+{
+	size_type i = where - begin();
+	ks.erase(ks.begin() + i);
+	vs.erase(vs.begin() + i);
+	return begin() + i;
+}
+
+template<typename K, typename V, std::size_t N, typename Compare>
+auto inline_flat_map<K, V, N, Compare>::erase(const K& k) -> size_type
+{
+	size_type i = lower_index(k);
+	if (!matches(i, k))
+		return 0;
+	ks.erase(ks.begin() + i);
+	vs.erase(vs.begin() + i);
+	return 1;
+}
+
+// -------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// sorted set for a handful of keys, the keys of inline_flat_map without the values
+/// </summary>
+template<typename K, std::size_t N, typename Compare = std::less<K>>
+class inline_flat_set
+{
+	typedef inline_flat_search<K, Compare> search;
+
+public:
+	// types
+	typedef K           key_type;
+	typedef K           value_type;
+	typedef Compare     key_compare;
+	typedef std::size_t size_type;
+	typedef const K*    iterator;
+	typedef const K*    const_iterator;
+
+	// construction
+	inline_flat_set() = default;
+	inline_flat_set(std::initializer_list<K>);
+
+	// size
+	size_type          size() const { return ks.size(); }
+	[[nodiscard]] bool empty() const { return ks.empty(); }
+	void               reserve(size_type n) { ks.reserve(n); }
+	void               clear() { ks.clear(); }
+
+	// iteration
+	const_iterator begin() const { return ks.data(); }
+	const_iterator end() const { return ks.data() + ks.size(); }
+
+	const inline_vector<K, N>& keys() const { return ks; }
+
+	// lookup
+	size_type      lower_index(const K& k) const { return search::lower_bound(ks.data(), ks.size(), k); }
+	const_iterator lower_bound(const K& k) const { return begin() + lower_index(k); }
+	const_iterator find(const K& k) const;
+	bool           contains(const K& k) const { return find(k) != end(); }
+	size_type      count(const K& k) const { return contains(k); }
+
+	// modifiers
+	std::pair<const_iterator, bool> insert(const K& k);
+	template<typename It>
+	void insert_sorted_range(It, It);
+
+	const_iterator erase(const_iterator);
+	size_type      erase(const K& k);
+
+private:
+	bool matches(size_type i, const K& k) const { return i < ks.size() && !Compare{}(k, ks[i]); }
+
+	inline_vector<K, N> ks;
+};
+
+// -------------------------------------------------------------------------------------------------------------
+
+template<typename K, std::size_t N, typename Compare>
+inline_flat_set<K, N, Compare>::inline_flat_set(std::initializer_list<K> il)
+{
+	reserve(il.size());
+	for (auto& k : il)
+		insert(k);
+}
+
+template<typename K, std::size_t N, typename Compare>
+auto inline_flat_set<K, N, Compare>::find(const K& k) const -> const_iterator
+{
+	size_type i = lower_index(k);
+	return matches(i, k) ? begin() + i : end();
+}
+
+template<typename K, std::size_t N, typename Compare>
+auto inline_flat_set<K, N, Compare>::insert(const K& k) -> std::pair<const_iterator, bool>
+{
+	size_type i = lower_index(k);
+	if (matches(i, k))
+		return {begin() + i, false};
+	ks.insert(ks.begin() + i, k);
+	return {begin() + i, true};
+}
+
+/// <summary>
+/// add the keys of a sorted range in one O(n + m) merge, duplicates dropped
+/// </summary>
+template<typename K, std::size_t N, typename Compare>
+template<typename It>
+void inline_flat_set<K, N, Compare>::insert_sorted_range(It b, It e)
+{
+	Compare comp;
+	if (b == e)
+		return;
+	if (empty() || comp(ks.back(), *b))
+	{
+		for (; b != e; ++b)
+			if (empty() || comp(ks.back(), *b))
+				ks.push_back(*b);
+		return;
+	}
+
+	inline_vector<K, N> mk;
+	if constexpr (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>::value)
+	{
+		mk.reserve(size() + std::distance(b, e));
+	}
+	size_type i = 0, n = size();
+	auto      put = [&](const K& k) {
+		if (mk.empty() || comp(mk.back(), k))
+			mk.push_back(k);
+	};
+	for (; b != e; ++b)
+	{
+		for (; i < n && !comp(*b, ks[i]); ++i)
+			put(ks[i]);
+		put(*b);
+	}
+	for (; i < n; ++i)
+		put(ks[i]);
+	ks.swap(mk);
+}
+
+template<typename K, std::size_t N, typename Compare>
+auto inline_flat_set<K, N, Compare>::erase(const_iterator where) -> const_iterator
+{
+	size_type i = where - begin();
+	ks.erase(ks.begin() + i);
+	return begin() + i;
+}
+
+template<typename K, std::size_t N, typename Compare>
+auto inline_flat_set<K, N, Compare>::erase(const K& k) -> size_type
+{
+	size_type i = lower_index(k);
+	if (!matches(i, k))
+		return 0;
+	ks.erase(ks.begin() + i);
+	return 1;
+}
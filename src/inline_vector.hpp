@@ -1,21 +1,60 @@
 
-// #pragma once
+#pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <initializer_list>
 #include <iterator>
 #include <memory>
+#include <stdexcept>
 #include <type_traits>
 #include <utility>
 
-template<typename T, std::size_t N>
+#include "inline_vector_policy.hpp"
+
+/// <summary>
+/// T can be moved to other storage with memcpy, the old bytes then count as gone
+/// (no destructor is run on them). true for trivially copyable types and the smart
+/// pointers, specialise it to opt in a type of your own, e.g. a struct holding a unique_ptr
+/// </summary>
+template<typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T>
+{
+};
+template<typename T, typename D>
+struct is_trivially_relocatable<std::unique_ptr<T, D>> : is_trivially_relocatable<D>
+{
+};
+template<typename T>
+struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type
+{
+};
+
+// the compact header (see inline_vector::small_type) narrows the inline size on little endian only
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define INLINE_VECTOR_LITTLE_ENDIAN 0
+#else
+#define INLINE_VECTOR_LITTLE_ENDIAN 1
+#endif
+
+/// <summary>
+/// vector keeping up to N elements inline, spilling to a heap buffer above that.
+/// Policy sets the growth, the return to inline storage and the spill allocation
+/// (see inline_vector_policy.hpp)
+/// </summary>
+template<typename T, std::size_t N, typename Policy = inline_vector_policy>
 class inline_vector
 {
-	static constexpr bool cne  = std::is_nothrow_copy_constructible<T>::value;
-	static constexpr bool triv = std::is_trivially_copyable<T>::value;
-	static constexpr bool mne  = std::is_nothrow_move_constructible<T>:value;
+	static_assert(N > 0, "inline_vector needs room for one element at least");
+
+	static constexpr bool triv  = std::is_trivially_copyable<T>::value;
+	static constexpr bool mne   = std::is_nothrow_move_constructible<T>::value;
+	static constexpr bool reloc = is_trivially_relocatable<T>::value;
+	static constexpr bool nmv   = reloc || (mne && std::is_nothrow_move_assignable<T>::value);
+
 public:
 	// types
 	typedef T              value_type;
@@ -30,15 +69,16 @@ public:
 
 	// construction
 	inline_vector() noexcept;
-	inline_vector(const inline_vector&) noexcept(cne || triv);
-	inline_vector(inline_vector&&) noexcept(mne || cne || triv);
+	inline_vector(const inline_vector&);
+	inline_vector(inline_vector&&) noexcept(mne || reloc);
 	explicit inline_vector(size_type, const T& = T{});
 	template<typename It>
 	inline_vector(It, It);
 	inline_vector(std::initializer_list<T>);
 
 	// misc
-	void swap(inline_vector&) noexcept(mne || cne || triv);
+	// neither swap nor move ever spill to the heap, inline elements are exchanged in place
+	void swap(inline_vector&) noexcept(nmv);
 
 	// destruction
 	void clear();
@@ -46,7 +86,7 @@ public:
 
 	// assignment
 	inline_vector& operator=(const inline_vector&);
-	inline_vector& operator=(inline_vector&&);
+	inline_vector& operator=(inline_vector&&) noexcept(mne || reloc);
 	void           assign(size_type, const T&);
 	template<typename It>
 	void assign(It, It);
@@ -110,21 +150,64 @@ private:
 	template<typename It>
 	void internal_assign(std::bidirectional_iterator_tag, It, It);
 
-	void create_gap(size_type, size_type);
+	// room for n elements at pos, the elements from pos on are moved up, size is not changed
+	T*   create_gap(size_type pos, size_type n);
+	void close_gap(size_type pos, size_type n);
+
+	// move n elements from src to dst, the ranges may overlap. memmove when T is relocatable
+	static void relocate(T* dst, T* src, size_type n);
 
-	void make_heap();
+	// back from the heap to inline storage, size() must be <= N
+	void to_inline();
+	// to_inline once the size is down to what Policy::shrink_to allows
+	void maybe_inline();
+
+	void take(inline_vector&);
+	void swap_inline(inline_vector&);
+
+	/// <summary>
+	/// both arms start with the size shifted up one bit, the low bit is 1 on the heap.
+	/// inline the size only goes up to N, so it is kept in the smallest type holding N << 1
+	/// and the elements start right after it; the heap pointer and capacity lie over the
+	/// inline buffer. on little endian the low bit lands in the first byte for either
+	/// width, elsewhere both arms use size_type
+	/// </summary>
+	typedef std::conditional_t<INLINE_VECTOR_LITTLE_ENDIAN && (N <= 0x7f), std::uint8_t,
+		std::conditional_t<INLINE_VECTOR_LITTLE_ENDIAN && (N <= 0x7fff), std::uint16_t, size_type>>
+		small_type;
 
 	struct heap_content
 	{
-		size_type size, capa;
+		size_type tag_size;
+		size_type capa;
 		T*        data;
 	};
 	struct inline_content
 	{
-		size_type size, capa;
-		T         data[N];
+		small_type tag_size;
+		T          data[N];
 	};
 
+	// with a narrow small_type (little endian only) the low bit is in the first byte;
+	// otherwise both arms start with a size_type, read as such
+	bool on_heap() const noexcept
+	{
+		if constexpr (std::is_same<small_type, size_type>::value)
+			return hc.tag_size & 1;
+		else
+			return *(const unsigned char*)&hc & 1;
+	}
+
+	void set_size(size_type n) noexcept
+	{
+		if (on_heap())
+			hc.tag_size = (n << 1) | 1;
+		else
+			ic.tag_size = (small_type)(n << 1);
+	}
+	void set_inline(size_type n) noexcept { ic.tag_size = (small_type)(n << 1); }
+	void set_heap(T* ptr, size_type n, size_type cp) noexcept { hc = heap_content{(n << 1) | 1, cp, ptr}; }
+
 	union {
 		heap_content   hc;
 		inline_content ic;
@@ -133,98 +216,90 @@ private:
 
 // construction
 
-template<typename T, std::size_t N>
-inline_vector<T, N>::inline_vector() noexcept
+template<typename T, std::size_t N, typename Policy>
+inline_vector<T, N, Policy>::inline_vector() noexcept
 {
-	ic.size = 0;
-	ic.capa = 0;
+	set_inline(0);
 }
 
-template<typename T, std::size_t N>
-inline_vector<T, N>::inline_vector(const inline_vector& other)
+template<typename T, std::size_t N, typename Policy>
+inline_vector<T, N, Policy>::inline_vector(const inline_vector& other)
 {
-	if (other.ic.size <= N)
-	{
-		ic.size = other.ic.size;
-		ic.capa = 0;
-	}
+	size_type n = other.size();
+	if (n <= N)
+		set_inline(n);
 	else
-	{
-		hc.size = other.ic.size;
-		hc.capa = ic.size;
-		hc.data = std::allocator<T>{}.allocate(ic.size);
-	}
+		set_heap(Policy::template allocate<T>(n), n, n);
 	const T* src = other.data();
 	T*       dst = data();
 	if constexpr (triv)
 	{
-		std::memcpy(dst, src, sizeof(T) * ic.size);
+		std::memcpy(dst, src, sizeof(T) * n);
 	}
 	else
 	{
-		for (size_type i = 0; i < ic.size; ++i)
+		size_type i = 0;
+		try
+		{
+			for (; i < n; ++i)
+				new (dst + i) T(src[i]);
+		}
+		catch (...)
 		{
-			new (dst + i) T(src[i]);
+			while (i--)
+				dst[i].~T();
+			if (on_heap())
+				Policy::template deallocate<T>(hc.data, hc.capa);
+			throw;
 		}
 	}
 }
 
-template<typename T, std::size_t N>
-inline_vector<T, N>::inline_vector(inline_vector&& other) noexcept(cne || triv)
+template<typename T, std::size_t N, typename Policy>
+inline_vector<T, N, Policy>::inline_vector(inline_vector&& other) noexcept(mne || reloc)
+{
+	take(other);
+}
+
+/// <summary>
+/// move the contents of other into this (empty) one, and leave other empty.
+/// a heap block is stolen, unless its elements fit inline
+/// </summary>
+template<typename T, std::size_t N, typename Policy>
+void inline_vector<T, N, Policy>::take(inline_vector& other)
 {
-	if (other.ic.size <= N)
+	size_type n = other.size();
+	if (n <= N)
 	{
-		ic.size      = other.ic.size;
-		ic.capa      = 0;
-		const T* src = other.data();
-		T*       dst = data();
-		if constexpr (triv)
-		{
-			memcpy(dst, src, sizeof(T) * ic.size);
-		}
-		else
-		{
-			for (size_type i = 0; i < ic.size; ++i)
-			{
-				new (dst + i) T(std::move(src[i]));
-			}
-		}
+		set_inline(n);
+		relocate(ic.data, other.data(), n);
+		if (other.on_heap())
+			Policy::template deallocate<T>(other.hc.data, other.hc.capa);
 	}
 	else
 	{
-		hc.size = other.hc.size;
-		hc.capa = other.hc.capa;
-		hc.data = other.hc.data;
+		hc = other.hc;
 	}
-	other.hc.size = 0;
-	other.hc.capa = 0;
-	other.hc.data = nullptr;
+	other.set_inline(0);
 }
 
-template<typename T, std::size_t N>
-inline_vector<T, N>::inline_vector(size_type sz, const T& val)
+template<typename T, std::size_t N, typename Policy>
+inline_vector<T, N, Policy>::inline_vector(size_type sz, const T& val)
 {
 	if (sz <= N)
-	{
-		ic.size = sz;
-		ic.capa = 0;
-	}
+		set_inline(sz);
 	else
-	{
-		hc.size = sz;
-		hc.capa = sz;
-		hc.data = std::allocator<T>{}.allocate(sz);
-	}
+		set_heap(Policy::template allocate<T>(sz), sz, sz);
 	T* dst = data();
-	for (size_type i = 0; i < ic.size; ++i)
+	for (size_type i = 0; i < sz; ++i)
 	{
 		new (dst + i) T(val);
 	}
 }
 
-template<typename T, std::size_t N>
+template<typename T, std::size_t N, typename Policy>
 template<typename It>
-inline_vector<T, N>::inline_vector(It b, It e) : inline_vector()
+inline_vector<T, N, Policy>::inline_vector(It b, It e) : inline_vector()
 {
 	typedef typename std::iterator_traits<It>::iterator_category category;
 	constexpr bool RAI = std::is_same<category, std::random_access_iterator_tag>::value;
@@ -236,50 +311,88 @@ inline_vector<T, N>::inline_vector(It b, It e) : inline_vector()
 		push_back(*b++);
 }
 
-template<typename T, std::size_t N>
-inline_vector<T, N>::inline_vector(std::initializer_list<T> il) : inline_vector(il.begin(), il.end())
+template<typename T, std::size_t N, typename Policy>
+inline_vector<T, N, Policy>::inline_vector(std::initializer_list<T> il) : inline_vector(il.begin(), il.end())
+{
+}
+
+template<typename T, std::size_t N, typename Policy>
+void inline_vector<T, N, Policy>::to_inline()
 {
+	T*   src = hc.data;
+	auto cp  = hc.capa;
+	auto n   = size();
+	set_inline(n);
+	relocate(ic.data, src, n);
+	Policy::template deallocate<T>(src, cp);
 }
 
-template<typename T, std::size_t N>
-void inline_vector<T, N>::make_heap()
+template<typename T, std::size_t N, typename Policy>
+void inline_vector<T, N, Policy>::maybe_inline()
 {
-	if (ic.capa)
+	if (on_heap() && size() <= std::min(Policy::shrink_to(N), N))
+		to_inline();
+}
+
+// misc
+template<typename T, std::size_t N, typename Policy>
+void inline_vector<T, N, Policy>::swap(inline_vector& other) noexcept(nmv)
+{
+	if (this == &other)
 		return;
-	auto sz  = ic.size;
-	auto cp  = sz + 1;
-	T*   ptr = std::allocator<T>{}.allocate(cp);
-	T*   src = data();
-	if constexpr (triv)
+	if constexpr (reloc)
+	{
+		// the whole object is relocatable then, swap the bytes in use on either side
+		auto used = [](const inline_vector& v) -> std::size_t {
+			if (v.on_heap())
+				return sizeof(heap_content);
+			return (const char*)(v.ic.data + v.size()) - (const char*)&v;
+		};
+		std::size_t    n = std::max(used(*this), used(other));
+		unsigned char* a = (unsigned char*)this;
+		std::swap_ranges(a, a + n, (unsigned char*)&other);
+	}
+	else if (on_heap() && other.on_heap())
+	{
+		using std::swap;
+		swap(hc, other.hc);
+	}
+	else if (!on_heap() && !other.on_heap())
 	{
-		std::memcpy(ptr, src, sizeof(T) * sz);
+		swap_inline(other);
 	}
 	else
 	{
-		for (size_type i = 0; i < sz; ++i)
-		{
-			new (ptr + i) T(std::move(src[i]));
-			src[i].~T();
-		}
+		// one on the heap: its block goes over, the inline elements come back
+		inline_vector& h   = on_heap() ? *this : other;
+		inline_vector& i   = on_heap() ? other : *this;
+		heap_content   blk = h.hc;
+		size_type      n   = i.size();
+		h.set_inline(n);
+		relocate(h.ic.data, i.ic.data, n);
+		i.hc = blk;
 	}
-	hc.size = sz;
-	hc.capa = cp;
-	hc.data = ptr;
 }
 
-// misc
-template<typename T, std::size_t N>
-void inline_vector<T, N>::swap(inline_vector& other)
+/// <summary>
+/// both inline: swap the common part element by element, relocate the rest
+/// </summary>
+template<typename T, std::size_t N, typename Policy>
+void inline_vector<T, N, Policy>::swap_inline(inline_vector& other)
 {
-	make_heap();
-	other.make_heap();
+	inline_vector& l = (size() >= other.size()) ? *this : other;
+	inline_vector& s = (size() >= other.size()) ? other : *this;
+	size_type      n = s.size();
 	using std::swap;
-	swap(hc, other.hc);
+	for (size_type i = 0; i < n; ++i)
+		swap(l.ic.data[i], s.ic.data[i]);
+	relocate(s.ic.data + n, l.ic.data + n, l.size() - n);
+	swap(l.ic.tag_size, s.ic.tag_size);
 }
 
 // destruction
-template<typename T, std::size_t N>
-void inline_vector<T, N>::clear()
+template<typename T, std::size_t N, typename Policy>
+void inline_vector<T, N, Policy>::clear()
 {
 	T*        p = data();
 	size_type i, n = size();
@@ -287,67 +400,56 @@ void inline_vector<T, N>::clear()
 	{
 		(p + i)->~T();
 	}
-	if (ic.capa)
-		std::allocator<T>{}.deallocate(hc.data, hc.capa);
+	if (on_heap())
+		Policy::template deallocate<T>(hc.data, hc.capa);
 
-	hc.size = 0;
-	hc.capa = 0;
-	hc.data = nullptr;
+	set_inline(0);
 }
 
-template<typename T, std::size_t N>
-inline_vector<T, N>::~inline_vector()
+template<typename T, std::size_t N, typename Policy>
+inline_vector<T, N, Policy>::~inline_vector()
 {
 	clear();
 }
 
 // assignment
-template<typename T, std::size_t N>
-auto inline_vector<T, N>::operator=(const inline_vector& other) -> inline_vector&
+template<typename T, std::size_t N, typename Policy>
+auto inline_vector<T, N, Policy>::operator=(const inline_vector& other) -> inline_vector&
 {
 	clear();
-	if (other.ic.size <= N)
-	{
-		ic.size = other.ic.size;
-		ic.capa = 0;
-	}
+	size_type n = other.size();
+	if (n <= N)
+		set_inline(n);
 	else
-	{
-		hc.size = other.ic.size;
-		hc.capa = ic.size;
-		hc.data = std::allocator<T>{}.allocate(ic.size);
-	}
+		set_heap(Policy::template allocate<T>(n), n, n);
 	const T* src = other.data();
 	T*       dst = data();
-	for (size_type i = 0; i < ic.size; ++i)
+	for (size_type i = 0; i < n; ++i)
 	{
 		new (dst + i) T(src[i]);
 	}
 	return *this;
 }
 
-template<typename T, std::size_t N>
-auto inline_vector<T, N>::operator=(inline_vector&& other) -> inline_vector&
+template<typename T, std::size_t N, typename Policy>
+auto inline_vector<T, N, Policy>::operator=(inline_vector&& other) noexcept(mne || reloc) -> inline_vector&
 {
-	swap(other);
+	if (this != &other)
+	{
+		clear();
+		take(other);
+	}
 	return *this;
 }
 
-template<typename T, std::size_t N>
-void inline_vector<T, N>::assign(size_type sz, const T& val)
+template<typename T, std::size_t N, typename Policy>
+void inline_vector<T, N, Policy>::assign(size_type sz, const T& val)
 {
 	clear();
 	if (sz <= N)
-	{
-		ic.size = sz;
-		ic.capa = 0;
-	}
+		set_inline(sz);
 	else
-	{
-		hc.size = sz;
-		hc.capa = sz;
-		hc.data = std::allocator<T>{}.allocate(ic.size);
-	}
+		set_heap(Policy::template allocate<T>(sz), sz, sz);
 	T* dst = data();
 	for (size_type i = 0; i < sz; ++i)
 	{
@@ -355,9 +457,9 @@ void inline_vector<T, N>::assign(size_type sz, const T& val)
 	}
 }
 
-template<typename T, std::size_t N>
+template<typename T, std::size_t N, typename Policy>
 template<typename It>
-void inline_vector<T, N>::assign(It b, It e)
+void inline_vector<T, N, Policy>::assign(It b, It e)
 {
 	clear();
 
@@ -371,51 +473,30 @@ void inline_vector<T, N>::assign(It b, It e)
 		push_back(*b++);
 }
 
-template<typename T, std::size_t N>
-void inline_vector<T, N>::assign(std::initializer_list<T> il)
+template<typename T, std::size_t N, typename Policy>
+void inline_vector<T, N, Policy>::assign(std::initializer_list<T> il)
 {
 	assign(il.begin(), il.end());
 }
 
-template<typename T, std::size_t N>
-void inline_vector<T, N>::reserve(size_type sz)
+template<typename T, std::size_t N, typename Policy>
+void inline_vector<T, N, Policy>::reserve(size_type sz)
 {
 	if (!sz)
 		return;
-	if (ic.capa == 0)
-	{
-		if (sz <= N)
-			return;
-	}
-	else
-	{
-		if (sz <= hc.capa)
-			return;
-	}
-	if (sz < ic.size)
-		sz = ic.size;
-	T*   ptr = std::allocator<T>{}.allocate(sz);
+	if (sz <= capacity())
+		return;
+	T*   ptr = Policy::template allocate<T>(sz);
 	T*   src = data();
 	auto n   = size();
-	if constexpr (triv)
-	{
-		std::memcpy(ptr, src, n * sizeof(T));
-	}
-	else
-	{
-		for (size_type i = 0; i < n; ++i)
-		{
-			new (ptr + i) T(std::move(src[i]));
-			src[i].~T();
-		}
-	}
-	hc.size = n;
-	hc.capa = sz;
-	hc.data = ptr;
+	relocate(ptr, src, n);
+	if (on_heap())
+		Policy::template deallocate<T>(src, hc.capa);
+	set_heap(ptr, n, sz);
 }
 
-template<typename T, std::size_t N>
-void inline_vector<T, N>::resize(size_type sz, const T& val)
+template<typename T, std::size_t N, typename Policy>
+void inline_vector<T, N, Policy>::resize(size_type sz, const T& val)
 {
 	auto n = size();
 	if (sz < n)
@@ -431,254 +512,361 @@ void inline_vector<T, N>::resize(size_type sz, const T& val)
 	}
 }
 
-template<typename T, std::size_t N>
-auto inline_vector<T, N>::size() const -> size_type
+template<typename T, std::size_t N, typename Policy>
+auto inline_vector<T, N, Policy>::size() const -> size_type
 {
-	return ic.size;
+	if (on_heap())
+		return hc.tag_size >> 1;
+	else
+		return ic.tag_size >> 1;
 }
 
-template<typename T, std::size_t N>
-auto inline_vector<T, N>::capacity() const -> size_type
+template<typename T, std::size_t N, typename Policy>
+auto inline_vector<T, N, Policy>::capacity() const -> size_type
 {
-	if (ic.capa == 0)
-	{
-		return N;
-	}
-	else
-	{
+	if (on_heap())
 		return hc.capa;
-	}
+	else
+		return N;
 }
 
-template<typename T, std::size_t N>
-bool inline_vector<T, N>::empty() const
+template<typename T, std::size_t N, typename Policy>
+bool inline_vector<T, N, Policy>::empty() const
 {
 	return size() == 0;
 }
 
-template<typename T, std::size_t N>
-constexpr auto inline_vector<T, N>::max_size() noexcept -> size_type
+template<typename T, std::size_t N, typename Policy>
+constexpr auto inline_vector<T, N, Policy>::max_size() noexcept -> size_type
 {
 	return std::allocator<T>::max_size();
 }
 
-template<typename T, std::size_t N>
-void inline_vector<T, N>::shrink_to_fit()
+template<typename T, std::size_t N, typename Policy>
+void inline_vector<T, N, Policy>::shrink_to_fit()
 {
-	if (ic.capa == 0)
+	if (!on_heap())
 		return;
-	auto sz = hc.size;
-	if (hc.capa == sz)
+	auto sz = size();
+	auto cp = hc.capa;
+	if (sz <= N)
+		return to_inline();
+	if (cp == sz)
 		return;
 
-	T* src = data();
-	T* dst;
-	if (hc.size <= N)
-	{
-		ic.capa = 0;
-		dst     = ic.data;
-	}
+	T* src = hc.data;
+	T* dst = Policy::template allocate<T>(sz);
+	relocate(dst, src, sz);
+	Policy::template deallocate<T>(src, cp);
+	hc.capa = sz;
+	hc.data = dst;
+}
+
+template<typename T, std::size_t N, typename Policy>
+T* inline_vector<T, N, Policy>::data()
+{
+	if (on_heap())
+		return hc.data;
+	else
+		return ic.data;
+}
+
+template<typename T, std::size_t N, typename Policy>
+const T* inline_vector<T, N, Policy>::data() const
+{
+	if (on_heap())
+		return hc.data;
 	else
+		return ic.data;
+}
+
+template<typename T, std::size_t N, typename Policy>
+T& inline_vector<T, N, Policy>::at(size_type idx)
+{
+	if (idx >= size())
+		throw std::out_of_range("inline_vector::at");
+	return data()[idx];
+}
+
+template<typename T, std::size_t N, typename Policy>
+const T& inline_vector<T, N, Policy>::at(size_type idx) const
+{
+	if (idx >= size())
+		throw std::out_of_range("inline_vector::at");
+	return data()[idx];
+}
+
+template<typename T, std::size_t N, typename Policy>
+T& inline_vector<T, N, Policy>::back()
+{
+	return data()[size() - 1];
+}
+
+template<typename T, std::size_t N, typename Policy>
+const T& inline_vector<T, N, Policy>::back() const
+{
+	return data()[size() - 1];
+}
+
+// modifiers
+template<typename T, std::size_t N, typename Policy>
+void inline_vector<T, N, Policy>::relocate(T* dst, T* src, size_type n)
+{
+	if (dst == src || !n)
+		return;
+	if constexpr (reloc)
 	{
-		ic.capa = sz;
-		dst = hc.data = std::allocator<T>{}.allocate(sz);
+		std::memmove((void*)dst, (const void*)src, sizeof(T) * n);
 	}
-
-	if constexpr (triv)
+	else if (dst < src)
 	{
-		memcpy(dst, src, sizeof(T) * sz);
+		for (size_type i = 0; i < n; ++i)
+		{
+			new (dst + i) T(std::move(src[i]));
+			src[i].~T();
+		}
 	}
 	else
 	{
-		for (auto i = 0ul; i < sz; ++i)
+		for (size_type i = n; i--;)
 		{
 			new (dst + i) T(std::move(src[i]));
 			src[i].~T();
 		}
 	}
-	std::allocator<T>{}.deallocate(src, sz);
 }
 
-template<typename T, std::size_t N>
-T* inline_vector<T, N>::data()
+/// <summary>
+/// in place when it fits, else the elements go to a new heap block
+/// on either side of the gap, each part relocated once.
+/// in place and not relocatable, the tail is shifted the way std::vector does it,
+/// by move assignment, and the moved from objects left in the gap are destroyed
+/// </summary>
+template<typename T, std::size_t N, typename Policy>
+T* inline_vector<T, N, Policy>::create_gap(size_type pos, size_type n)
 {
-	if (ic.capa == 0)
-		return ic.data;
-	else
-		return hc.data;
+	auto cp  = capacity();
+	auto nn  = size();
+	auto ptr = data();
+	if (cp >= nn + n)
+	{
+		if (reloc || nn - pos <= n)
+		{
+			relocate(ptr + pos + n, ptr + pos, nn - pos);
+		}
+		else
+		{
+			for (size_type i = nn - n; i < nn; ++i)
+				new (ptr + i + n) T(std::move(ptr[i]));
+			std::move_backward(ptr + pos, ptr + nn - n, ptr + nn);
+			for (size_type i = pos; i < pos + n; ++i)
+				ptr[i].~T();
+		}
+		return ptr + pos;
+	}
+	cp       = std::max(Policy::grow(cp, nn + n), nn + n);
+	auto dst = Policy::template allocate<T>(cp);
+	relocate(dst, ptr, pos);
+	relocate(dst + pos + n, ptr + pos, nn - pos);
+	if (on_heap())
+		Policy::template deallocate<T>(ptr, hc.capa);
+	set_heap(dst, nn, cp);
+	return dst + pos;
 }
 
-template<typename T, std::size_t N>
-const T* inline_vector<T, N>::data() const
+/// <summary>
+/// undo create_gap when filling the gap threw
+/// </summary>
+template<typename T, std::size_t N, typename Policy>
+void inline_vector<T, N, Policy>::close_gap(size_type pos, size_type n)
 {
-	if (ic.capa == 0)
-		return ic.data;
-	else
-		return hc.data;
+	auto ptr = data();
+	relocate(ptr + pos, ptr + pos + n, size() - pos);
 }
 
-// modifiers
-template<typename T, std::size_t N>
-auto inline_vector<T, N>::insert(iterator where, const T& val) -> iterator
-{
-	auto      cp  = capacity();
-	auto      nn  = size();
-	size_type ii  = where - begin();
-	auto      ptr = data();
-	if (cp >= (nn + 1))
-	{
-		if (nn)
-			for (size_type i = nn; i > ii; --i)
-			{
-				if (i >= nn)
-					new (ptr + i) T(std::move(ptr[i - 1]));
-				else
-					ptr[i] = std::move(ptr[i - 1]);
-			}
-		if (ii >= nn)
-			new (ptr + ii) T(val);
-		else
-			ptr[ii] = val;
-		ic.size += 1;
-		return ptr + ii;
+template<typename T, std::size_t N, typename Policy>
+auto inline_vector<T, N, Policy>::insert(iterator where, const T& val) -> iterator
+{
+	return emplace(where, val);
+}
+
+template<typename T, std::size_t N, typename Policy>
+auto inline_vector<T, N, Policy>::insert(iterator where, T&& val) -> iterator
+{
+	return emplace(where, std::move(val));
+}
+
+template<typename T, std::size_t N, typename Policy>
+auto inline_vector<T, N, Policy>::insert(iterator where, size_type n, const T& val) -> iterator
+{
+	size_type ii = where - begin();
+	if (!n)
+		return where;
+	T         tmp(val);
+	T*        ptr = create_gap(ii, n);
+	size_type i   = 0;
+	try
+	{
+		for (; i < n; ++i)
+			new (ptr + i) T(tmp);
 	}
-	else
+	catch (...)
 	{
-		cp       = cp * 2 + 1;
-		auto dst = std::allocator<T>{}.allocate(cp);
-		for (size_type i = 0; i < ii; ++i)
-		{
-			new (dst + i) T(std::move(ptr[i]));
+		while (i--)
 			ptr[i].~T();
+		close_gap(ii, n);
+		throw;
+	}
+	set_size(size() + n);
+	return ptr;
+}
+
+template<typename T, std::size_t N, typename Policy>
+template<typename It>
+auto inline_vector<T, N, Policy>::insert(iterator itr, It b, It e) -> iterator
+{
+	if (b == e)
+		return itr;
+	typedef typename std::iterator_traits<It>::iterator_category category;
+	if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value)
+	{
+		// one gap for the whole range
+		size_type ii  = itr - begin();
+		size_type n   = std::distance(b, e);
+		T*        ptr = create_gap(ii, n);
+		size_type i   = 0;
+		try
+		{
+			for (; i < n; ++i, ++b)
+				new (ptr + i) T(*b);
 		}
-		new (dst + ii) T(val);
-		for (size_type i = ii; i < nn; ++i)
+		catch (...)
 		{
-			new (dst + i + 1) T(std::move(ptr[i]));
-			ptr[i].~T();
+			while (i--)
+				ptr[i].~T();
+			close_gap(ii, n);
+			throw;
 		}
-		if (ic.capa != 0)
-			std::allocator<T>{}.deallocate(ptr, nn);
-		hc.size = nn + 1;
-		hc.capa = cp;
-		hc.data = dst;
-		return dst + ii;
-	}
-}
-
-template<typename T, std::size_t N>
-auto inline_vector<T, N>::insert(iterator where, T&& val) -> iterator
-{
-	auto      cp  = capacity();
-	auto      nn  = size();
-	size_type ii  = where - begin();
-	auto      ptr = data();
-	if (cp >= (nn + 1))
-	{
-		if (nn)
-			for (size_type i = nn; i > ii; --i)
-			{
-				if (i >= nn)
-					new (ptr + i) T(std::move(ptr[i - 1]));
-				else
-					ptr[i] = std::move(ptr[i - 1]);
-			}
-		if (ii >= nn)
-			new (ptr + ii) T(std::move(val));
-		else
-			ptr[ii] = std::move(val);
-		ic.size += 1;
-		return ptr + ii;
+		set_size(size() + n);
+		return ptr;
 	}
 	else
 	{
-		cp       = cp * 2 + 1;
-		auto dst = std::allocator<T>{}.allocate(cp);
-		for (size_type i = 0; i < ii; ++i)
+		while (true)
 		{
-			new (dst + i) T(std::move(ptr[i]));
-			ptr[i].~T();
-		}
-		new (dst + ii) T(std::move(val));
-		for (size_type i = ii; i < nn; ++i)
-		{
-			new (dst + i + 1) T(std::move(ptr[i]));
-			ptr[i].~T();
+			itr = insert(itr, *b);
+			++b;
+			if (b == e)
+				break;
+			++itr;
 		}
-		if (ic.capa != 0)
-			std::allocator<T>{}.deallocate(ptr, nn);
-		hc.size = nn + 1;
-		hc.capa = cp;
-		hc.data = dst;
-		return dst + ii;
+		return itr;
 	}
 }
 
-template<typename T, std::size_t N>
-template<typename It>
-auto inline_vector<T, N>::insert(iterator itr, It b, It e) -> iterator
+template<typename T, std::size_t N, typename Policy>
+auto inline_vector<T, N, Policy>::insert(iterator where, std::initializer_list<T> il) -> iterator
 {
-	if (b == e)
-		return itr;
-	while (true)
+	return insert(where, il.begin(), il.end());
+}
+
+template<typename T, std::size_t N, typename Policy>
+template<typename... Args>
+auto inline_vector<T, N, Policy>::emplace(iterator where, Args&&... args) -> iterator
+{
+	size_type ii = where - begin();
+	if (ii == size() && size() < capacity())
+		return emplace_back(std::forward<Args>(args)...);
+	// args may refer to an element the gap moves
+	T  tmp(std::forward<Args>(args)...);
+	T* ptr = create_gap(ii, 1);
+	try
+	{
+		new (ptr) T(std::move(tmp));
+	}
+	catch (...)
 	{
-		itr = insert(itr, *b);
-		++b;
-		if (b == e)
-			break;
-		++itr;
+		close_gap(ii, 1);
+		throw;
 	}
-	return itr;
+	set_size(size() + 1);
+	return ptr;
+}
+
+template<typename T, std::size_t N, typename Policy>
+template<typename... Args>
+auto inline_vector<T, N, Policy>::emplace_back(Args&&... args) -> iterator
+{
+	if (size() == capacity())
+		return emplace(end(), std::forward<Args>(args)...);
+	T* ptr = data() + size();
+	new (ptr) T(std::forward<Args>(args)...);
+	set_size(size() + 1);
+	return ptr;
 }
 
-template<typename T, std::size_t N>
-auto inline_vector<T, N>::erase(iterator where) -> iterator
+template<typename T, std::size_t N, typename Policy>
+auto inline_vector<T, N, Policy>::erase(iterator where) -> iterator
 {
 	auto e = end();
 	assert(where >= begin());
 	assert(where < e);
-	auto itr = where;
-	while (true)
+	if constexpr (reloc)
+	{
+		where->~T();
+		relocate(where, where + 1, e - where - 1);
+	}
+	else
 	{
-		auto nxt = itr + 1;
-		if (nxt >= e)
-			break;
-		(*itr) = std::move(*nxt);
-		itr    = nxt;
+		std::move(where + 1, e, where);
+		(e - 1)->~T();
 	}
-	itr->~T();
-	ic.size -= 1;
-	return where;
+	set_size(size() - 1);
+	// may go back inline, which moves everything
+	size_type ii = where - begin();
+	maybe_inline();
+	return begin() + ii;
 }
 
-template<typename T, std::size_t N>
-auto inline_vector<T, N>::erase(iterator b, iterator e) -> iterator
+template<typename T, std::size_t N, typename Policy>
+auto inline_vector<T, N, Policy>::erase(iterator b, iterator e) -> iterator
 {
 	if (b >= e)
 		return b;
-	auto itr = b;
-	auto ee  = end();
-	while (itr != e)
+	auto ee = end();
+	if constexpr (reloc)
 	{
-		itr->~T();
-		++itr;
-		ic.size -= 1;
+		for (auto itr = b; itr != e; ++itr)
+			itr->~T();
+		relocate(b, e, ee - e);
 	}
-	itr      = b;
-	auto src = e;
-	while (true)
+	else
 	{
-		if (src == ee)
-			break;
-		// move into destroyed
-		new (itr) T(std::move(*src));
-		src->~T();
-		++itr;
-		++src;
+		auto itr = std::move(e, ee, b);
+		for (; itr != ee; ++itr)
+			itr->~T();
 	}
-	return b;
+	set_size(size() - (e - b));
+	size_type ii = b - begin();
+	maybe_inline();
+	return begin() + ii;
+}
+
+template<typename T, std::size_t N, typename Policy>
+void inline_vector<T, N, Policy>::pop_back()
+{
+	assert(!empty());
+	data()[size() - 1].~T();
+	set_size(size() - 1);
+	maybe_inline();
 }
 
+// the header is one word at most, a byte or two for small N: a char vector then is as
+// big as the three words the heap arm needs, like a small string
+static_assert(sizeof(inline_vector<void*, 8>) == 9 * sizeof(void*), "inline_vector header above one word");
+static_assert(!INLINE_VECTOR_LITTLE_ENDIAN || sizeof(inline_vector<char, 3 * sizeof(void*) - 1>) == 3 * sizeof(void*),
+	"inline_vector header is not compact");
+
 #ifndef SUPRESS_MAIN
 #include <iostream>
 
@@ -0,0 +1,167 @@
+
+#pragma once
+
+// -------------------------------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+// -------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// how an inline_vector grows, when it goes back to inline storage and where its spill
+/// buffer comes from. the default doubles (+1) and returns to inline storage once the
+/// size is down to half of N: the gap between spilling (above N) and returning
+/// (at N/2) keeps a vector swinging around N from going back and forth on every call
+/// </summary>
+struct inline_vector_policy
+{
+	// new capacity, when cap is too small for need elements
+	static std::size_t grow(std::size_t cap, std::size_t need) { return std::max(cap * 2 + 1, need); }
+
+	// a spilled vector of N goes back inline when its size drops to this
+	static std::size_t shrink_to(std::size_t n) { return n / 2; }
+
+	template<typename T>
+	static T* allocate(std::size_t n)
+	{
+		return std::allocator<T>{}.allocate(n);
+	}
+	template<typename T>
+	static void deallocate(T* p, std::size_t n)
+	{
+		std::allocator<T>{}.deallocate(p, n);
+	}
+};
+
+// -------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// recycling arena for spill buffers. blocks are rounded up to a power of two, carved
+/// from big chunks and kept on a free list per size when given back, so a steady
+/// spill / return churn does not touch the global heap. memory only goes back when the
+/// arena dies, which must be after every vector using it. not thread safe.
+/// blocks above the largest class go straight to operator new
+/// </summary>
+class spill_arena
+{
+public:
+	spill_arena() = default;
+	spill_arena(const spill_arena&) = delete;
+	spill_arena& operator=(const spill_arena&) = delete;
+	~spill_arena();
+
+	void* allocate(std::size_t sz);
+	void  deallocate(void* p, std::size_t sz) noexcept;
+
+	// bytes taken from the heap, and how many of those are handed out right now
+	std::size_t reserved() const noexcept { return reserved_bytes; }
+	std::size_t in_use() const noexcept { return used_bytes; }
+
+private:
+	constexpr static std::size_t min_shift  = 6; // 64 bytes
+	constexpr static std::size_t classes    = 11; // up to 64 KiB
+	constexpr static std::size_t chunk_size = std::size_t(1) << (min_shift + classes + 1);
+
+	struct Free
+	{
+		Free* next;
+	};
+
+	// size class of a block, classes when it is too big for one
+	static std::size_t size_class(std::size_t sz) noexcept;
+
+	Free*              free_list[classes] = {};
+	char*              cur                = nullptr;
+	char*              end                = nullptr;
+	std::size_t        reserved_bytes     = 0;
+	std::size_t        used_bytes         = 0;
+	std::vector<void*> chunks;
+};
+
+/// <summary>
+/// policy drawing spill buffers from the spill_arena Arena() returns,
+/// growth and shrinking as in Base
+/// </summary>
+template<spill_arena& (*Arena)(), typename Base = inline_vector_policy>
+struct arena_spill : Base
+{
+	template<typename T>
+	static T* allocate(std::size_t n)
+	{
+		static_assert(alignof(T) <= alignof(std::max_align_t), "over aligned types are not supported");
+		if (n > std::size_t(-1) / sizeof(T))
+			throw std::bad_alloc{};
+		return (T*)Arena().allocate(n * sizeof(T));
+	}
+	template<typename T>
+	static void deallocate(T* p, std::size_t n)
+	{
+		Arena().deallocate(p, n * sizeof(T));
+	}
+};
+
+// -------------------------------------------------------------------------------------------------------------
+
+inline spill_arena::~spill_arena()
+{
+	for (void* c : chunks)
+		::operator delete(c);
+}
+
+inline std::size_t spill_arena::size_class(std::size_t sz) noexcept
+{
+	std::size_t cls = 0;
+	while (cls < classes && (std::size_t(1) << (min_shift + cls)) < sz)
+		++cls;
+	return cls;
+}
+
+inline void* spill_arena::allocate(std::size_t sz)
+{
+	std::size_t cls = size_class(sz);
+	if (cls == classes)
+	{
+		void* p = ::operator new(sz);
+		reserved_bytes += sz;
+		used_bytes += sz;
+		return p;
+	}
+	std::size_t bs = std::size_t(1) << (min_shift + cls);
+	used_bytes += bs;
+	if (Free* f = free_list[cls])
+	{
+		free_list[cls] = f->next;
+		return f;
+	}
+	if (std::size_t(end - cur) < bs)
+	{
+		// the tail of the old chunk is lost, at most half a chunk
+		chunks.reserve(chunks.size() + 1);
+		cur = (char*)::operator new(chunk_size);
+		end = cur + chunk_size;
+		chunks.push_back(cur);
+		reserved_bytes += chunk_size;
+	}
+	void* p = cur;
+	cur += bs;
+	return p;
+}
+
+inline void spill_arena::deallocate(void* p, std::size_t sz) noexcept
+{
+	std::size_t cls = size_class(sz);
+	if (cls == classes)
+	{
+		reserved_bytes -= sz;
+		used_bytes -= sz;
+		return ::operator delete(p);
+	}
+	Free* f        = (Free*)p;
+	f->next        = free_list[cls];
+	free_list[cls] = f;
+	used_bytes -= std::size_t(1) << (min_shift + cls);
+}
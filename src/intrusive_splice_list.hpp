@@ -0,0 +1,572 @@
+
+#pragma once
+
+// -------------------------------------------------------------------------------------------------------------
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "splice_list_algorithms.hpp"
+
+// -------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// prev / next links embedded in a user type, for intrusive_splice_list.
+/// an object can sit in as many lists at once as it has hooks.
+/// a hook that is not in a list has null links. copying an object does not copy
+/// its memberships: the copy starts unlinked, and assignment keeps the links of both
+/// </summary>
+struct splice_list_hook
+{
+	splice_list_hook* prev = nullptr;
+	splice_list_hook* next = nullptr;
+
+	splice_list_hook() = default;
+	splice_list_hook(const splice_list_hook&) noexcept {}
+	splice_list_hook& operator=(const splice_list_hook&) noexcept { return *this; }
+
+	bool is_linked() const { return next != nullptr; }
+};
+
+/// <summary>
+/// selects the splice_list_hook member of T that a list links through.
+/// T must be standard layout, the way back from a hook to its T is offsetof arithmetic
+/// </summary>
+template<typename T, splice_list_hook T::*Member>
+struct member_hook
+{
+	static_assert(std::is_standard_layout<T>::value, "member_hook needs a standard layout T");
+
+	static splice_list_hook* to_hook(T& t) { return std::addressof(t.*Member); }
+	static T*                to_value(splice_list_hook* h) { return (T*)((char*)h - offset()); }
+
+private:
+	// offset of the member. without virtual bases (standard layout has none) the Itanium and
+	// the MSVC ABIs both represent a data member pointer by that offset, so it is read out of
+	// Member: no T, constructed or not, is touched. folds to a constant
+	static std::ptrdiff_t offset()
+	{
+		typedef splice_list_hook T::*member_ptr;
+		typedef typename std::conditional<sizeof(member_ptr) == 4, std::int32_t, std::int64_t>::type rep;
+		static_assert(sizeof(rep) == sizeof(member_ptr), "unexpected data member pointer size");
+
+		member_ptr m = Member;
+		rep        r;
+		std::memcpy(&r, &m, sizeof r);
+		return r;
+	}
+};
+
+// -------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// splice_list over objects it does not own. the links live in the objects themselves
+/// (Hook is a member_hook), so insert and erase only relink, they never allocate, copy
+/// or move a T. splice, sort, merge and reverse are the splice_list algorithms.
+/// objects must outlive their membership, the list unlinks whatever is left on destruction.
+///
+///     struct Job { int prio; splice_list_hook run_q, all; };
+///     intrusive_splice_list<Job, member_hook<Job, &Job::run_q>> ready;
+///     intrusive_splice_list<Job, member_hook<Job, &Job::all>>   everything;
+/// </summary>
+template<typename T, typename Hook>
+class intrusive_splice_list
+{
+	typedef splice_list_hook* HookP;
+
+public:
+	typedef T              value_type;
+	typedef T&             reference;
+	typedef T*             pointer;
+	typedef const T&       const_reference;
+	typedef const T*       const_pointer;
+	typedef std::size_t    size_type;
+	typedef std::ptrdiff_t difference_type;
+	struct iterator;
+	struct const_iterator;
+
+	intrusive_splice_list() noexcept;
+	intrusive_splice_list(const intrusive_splice_list&) = delete;
+	intrusive_splice_list(intrusive_splice_list&&) noexcept;
+	intrusive_splice_list& operator=(const intrusive_splice_list&) = delete;
+	intrusive_splice_list& operator=(intrusive_splice_list&&) noexcept;
+	~intrusive_splice_list();
+
+	void swap(intrusive_splice_list&) noexcept;
+
+	// unlinks all elements, O(n)
+	void clear() noexcept;
+
+	std::size_t size() const noexcept;
+	bool        empty() const noexcept { return sentinel.next == &sentinel; }
+
+	constexpr static std::size_t max_size() { return std::numeric_limits<std::size_t>::max(); }
+
+	void push_back(T& t) { insert(end(), t); }
+	void push_front(T& t) { insert(begin(), t); }
+	void pop_back() { erase(iterator{sentinel.prev}); }
+	void pop_front() { erase(iterator{sentinel.next}); }
+
+	struct iterator : std::iterator<std::bidirectional_iterator_tag, T>
+	{
+		iterator() = default;
+		iterator& operator++()
+		{
+			node = node->next;
+			return *this;
+		}
+		iterator& operator--()
+		{
+			node = node->prev;
+			return *this;
+		}
+		iterator operator++(int)
+		{
+			iterator tmp = *this;
+			node         = node->next;
+			return tmp;
+		}
+		iterator operator--(int)
+		{
+			iterator tmp = *this;
+			node         = node->prev;
+			return tmp;
+		}
+		T&   operator*() const { return *Hook::to_value(node); }
+		T*   operator->() const { return Hook::to_value(node); }
+		bool operator==(iterator rhs) const { return node == rhs.node; }
+		bool operator!=(iterator rhs) const { return node != rhs.node; }
+		friend class intrusive_splice_list;
+		friend struct const_iterator;
+
+	private:
+		iterator(HookP p) : node(p) {}
+		HookP node = nullptr;
+	};
+	struct const_iterator : std::iterator<std::bidirectional_iterator_tag, const T>
+	{
+		const_iterator() = default;
+		const_iterator(typename intrusive_splice_list::iterator other) : node(other.node) {}
+		const_iterator& operator++()
+		{
+			node = node->next;
+			return *this;
+		}
+		const_iterator& operator--()
+		{
+			node = node->prev;
+			return *this;
+		}
+		const_iterator operator++(int)
+		{
+			const_iterator tmp = *this;
+			node               = node->next;
+			return tmp;
+		}
+		const_iterator operator--(int)
+		{
+			const_iterator tmp = *this;
+			node               = node->prev;
+			return tmp;
+		}
+		const T& operator*() const { return *Hook::to_value(node); }
+		const T* operator->() const { return Hook::to_value(node); }
+		bool     operator==(const_iterator rhs) const { return node == rhs.node; }
+		bool     operator!=(const_iterator rhs) const { return node != rhs.node; }
+		friend class intrusive_splice_list;
+
+	private:
+		const_iterator(HookP p) : node(p) {}
+		HookP node = nullptr;
+	};
+
+	typedef std::reverse_iterator<iterator>       reverse_iterator;
+	typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+	iterator               begin() { return {sentinel.next}; }
+	iterator               end() { return {&sentinel}; }
+	const_iterator         begin() const { return {sentinel.next}; }
+	const_iterator         end() const { return {(HookP)&sentinel}; }
+	const_iterator         cbegin() const { return {sentinel.next}; }
+	const_iterator         cend() const { return {(HookP)&sentinel}; }
+	reverse_iterator       rbegin() { return reverse_iterator{end()}; }
+	reverse_iterator       rend() { return reverse_iterator{begin()}; }
+	const_reverse_iterator rbegin() const { return const_reverse_iterator{end()}; }
+	const_reverse_iterator rend() const { return const_reverse_iterator{begin()}; }
+	const_reverse_iterator crbegin() const { return const_reverse_iterator{end()}; }
+	const_reverse_iterator crend() const { return const_reverse_iterator{begin()}; }
+
+	// iterator to an element known to be in this list, O(1)
+	static iterator       iterator_to(T& t) { return {Hook::to_hook(t)}; }
+	static const_iterator iterator_to(const T& t) { return {Hook::to_hook(const_cast<T&>(t))}; }
+
+	// t must not be linked through this hook already
+	iterator insert(iterator, T& t);
+	template<typename It>
+	iterator insert(iterator itr, It b, It e)
+	{
+		if (b == e)
+			return itr;
+		while (true)
+		{
+			itr = insert(itr, *b);
+			++b;
+			if (b == e)
+				break;
+			++itr;
+		}
+		return itr;
+	}
+	// only unlinks, the objects are not touched
+	iterator erase(iterator);
+	iterator erase(iterator, iterator);
+
+	void splice(iterator pos, intrusive_splice_list& other);
+	void splice(iterator pos, intrusive_splice_list&& other) { splice(pos, other); }
+
+	// pos, it, first and last all in this list
+	void splice(iterator pos, iterator it);
+	void splice(iterator pos, iterator first, iterator last);
+
+	void splice(iterator pos, intrusive_splice_list& other, iterator it);
+
+	// between lists, counting [first,last) would be O(n), so both sizes go stale until next size()
+	void splice(iterator pos, intrusive_splice_list& other, iterator first, iterator last);
+
+	// n must be std::distance(first,last), sizes stay exact
+	void splice(iterator pos, intrusive_splice_list& other, iterator first, iterator last, std::size_t n);
+
+	// default sort is stable
+	void sort() { sort(std::less<T>{}); }
+	template<typename Op>
+	void sort(Op op);
+
+	void merge(intrusive_splice_list& other) { merge(other, std::less<T>{}); }
+	template<typename Op>
+	void merge(intrusive_splice_list& other, Op op);
+
+	void unique() { unique(std::equal_to<T>{}); }
+	template<class Eq>
+	void unique(Eq eq);
+
+	void reverse();
+
+	void remove(const T& val);
+	template<typename Pred>
+	Pred remove_if(Pred pred);
+
+	template<typename Stream>
+	friend Stream& operator<<(Stream& out, const intrusive_splice_list& lst)
+	{
+		out << "[";
+		bool first = true;
+		for (auto&& x : lst)
+		{
+			if (!first)
+				out << ", ";
+			out << x;
+			first = false;
+		}
+		out << "]";
+		return out;
+	}
+
+private:
+	static T& value_of(HookP p) { return *Hook::to_value(p); }
+
+	static void link(HookP, HookP);
+	static void unlink(HookP);
+
+	// move the whole ring of from behind the sentinel to, leaving from empty
+	static void move_ring(splice_list_hook& to, splice_list_hook& from);
+
+	splice_list_hook    sentinel;
+	mutable std::size_t count       = 0;
+	mutable bool        count_stale = false;
+};
+
+// -------------------------------------------------------------------------------------------------------------
+
+template<typename T, typename Hook>
+intrusive_splice_list<T, Hook>::intrusive_splice_list() noexcept
+{
+	link(&sentinel, &sentinel);
+}
+
+template<typename T, typename Hook>
+intrusive_splice_list<T, Hook>::intrusive_splice_list(intrusive_splice_list&& other) noexcept
+{
+	move_ring(sentinel, other.sentinel);
+	count             = other.count;
+	count_stale       = other.count_stale;
+	other.count       = 0;
+	other.count_stale = false;
+}
+
+template<typename T, typename Hook>
+auto intrusive_splice_list<T, Hook>::operator=(intrusive_splice_list&& other) noexcept -> intrusive_splice_list&
+{
+	if (this != &other)
+	{
+		clear();
+		splice(end(), other);
+	}
+	return *this;
+}
+
+template<typename T, typename Hook>
+intrusive_splice_list<T, Hook>::~intrusive_splice_list()
+{
+	clear();
+}
+
+template<typename T, typename Hook>
+void intrusive_splice_list<T, Hook>::link(HookP n1, HookP n2)
+{
+	n1->next = n2;
+	n2->prev = n1;
+}
+
+template<typename T, typename Hook>
+void intrusive_splice_list<T, Hook>::unlink(HookP p)
+{
+	link(p->prev, p->next);
+	p->prev = p->next = nullptr;
+}
+
+template<typename T, typename Hook>
+void intrusive_splice_list<T, Hook>::move_ring(splice_list_hook& to, splice_list_hook& from)
+{
+	if (from.next == &from)
+	{
+		link(&to, &to);
+		return;
+	}
+	link(&to, from.next);
+	link(from.prev, &to);
+	link(&from, &from);
+}
+
+template<typename T, typename Hook>
+void intrusive_splice_list<T, Hook>::swap(intrusive_splice_list& other) noexcept
+{
+	using std::swap;
+	splice_list_hook tmp;
+	move_ring(tmp, sentinel);
+	move_ring(sentinel, other.sentinel);
+	move_ring(other.sentinel, tmp);
+	swap(count, other.count);
+	swap(count_stale, other.count_stale);
+}
+
+template<typename T, typename Hook>
+void intrusive_splice_list<T, Hook>::clear() noexcept
+{
+	HookP p = sentinel.next;
+	while (p != &sentinel)
+	{
+		HookP n = p->next;
+		p->prev = p->next = nullptr;
+		p                 = n;
+	}
+	link(&sentinel, &sentinel);
+	count       = 0;
+	count_stale = false;
+}
+
+/// <summary>
+/// size is O(1), except after an uncounted range splice
+/// between lists, where it is recounted once in O(n)
+/// </summary>
+template<typename T, typename Hook>
+std::size_t intrusive_splice_list<T, Hook>::size() const noexcept
+{
+	if (count_stale)
+	{
+		const splice_list_hook* p  = sentinel.next;
+		std::size_t             sz = 0;
+		while (p != &sentinel)
+		{
+			p = p->next;
+			++sz;
+		}
+		count       = sz;
+		count_stale = false;
+	}
+	return count;
+}
+
+template<typename T, typename Hook>
+auto intrusive_splice_list<T, Hook>::insert(iterator where, T& t) -> iterator
+{
+	HookP p = Hook::to_hook(t);
+	assert(!p->is_linked());
+	link(where.node->prev, p);
+	link(p, where.node);
+	++count;
+	return {p};
+}
+
+template<typename T, typename Hook>
+auto intrusive_splice_list<T, Hook>::erase(iterator what) -> iterator
+{
+	HookP n = what.node->next;
+	unlink(what.node);
+	--count;
+	return {n};
+}
+
+template<typename T, typename Hook>
+auto intrusive_splice_list<T, Hook>::erase(iterator b, iterator e) -> iterator
+{
+	while (b != e)
+		b = erase(b);
+	return b;
+}
+
+template<typename T, typename Hook>
+void intrusive_splice_list<T, Hook>::splice(iterator pos, intrusive_splice_list& other)
+{
+	if (other.empty())
+		return;
+	link(pos.node->prev, other.sentinel.next);
+	link(other.sentinel.prev, pos.node);
+	link(&other.sentinel, &other.sentinel);
+	count += other.count;
+	count_stale       = count_stale || other.count_stale;
+	other.count       = 0;
+	other.count_stale = false;
+}
+
+template<typename T, typename Hook>
+void intrusive_splice_list<T, Hook>::splice(iterator pos, iterator it)
+{
+	if (pos.node == it.node || pos.node == it.node->next)
+		return;
+	link(it.node->prev, it.node->next);
+	link(pos.node->prev, it.node);
+	link(it.node, pos.node);
+}
+
+template<typename T, typename Hook>
+void intrusive_splice_list<T, Hook>::splice(iterator pos, iterator first, iterator last)
+{
+	if (first == last || pos == first || pos == last)
+		return;
+	HookP f = first.node;
+	HookP l = last.node->prev;
+	link(f->prev, l->next);
+	link(pos.node->prev, f);
+	link(l, pos.node);
+}
+
+template<typename T, typename Hook>
+void intrusive_splice_list<T, Hook>::splice(iterator pos, intrusive_splice_list& other, iterator it)
+{
+	splice(pos, it);
+	if (&other != this)
+	{
+		++count;
+		--other.count;
+	}
+}
+
+template<typename T, typename Hook>
+void intrusive_splice_list<T, Hook>::splice(iterator pos, intrusive_splice_list& other, iterator first, iterator last)
+{
+	if (first == last)
+		return;
+	splice(pos, first, last);
+	if (&other != this)
+		count_stale = other.count_stale = true;
+}
+
+template<typename T, typename Hook>
+void intrusive_splice_list<T, Hook>::splice(
+	iterator pos, intrusive_splice_list& other, iterator first, iterator last, std::size_t n)
+{
+	splice(pos, first, last);
+	if (&other != this)
+	{
+		count += n;
+		other.count -= n;
+	}
+}
+
+template<typename T, typename Hook>
+template<typename Op>
+void intrusive_splice_list<T, Hook>::sort(Op op)
+{
+	splice_algo::sort(&sentinel, value_of, op);
+}
+
+template<typename T, typename Hook>
+template<typename Op>
+void intrusive_splice_list<T, Hook>::merge(intrusive_splice_list& other, Op op)
+{
+	if (other.empty() || this == &other)
+		return;
+	splice_algo::merge(&sentinel, &other.sentinel, value_of, op);
+	count += other.count;
+	count_stale       = count_stale || other.count_stale;
+	other.count       = 0;
+	other.count_stale = false;
+}
+
+template<typename T, typename Hook>
+template<class Eq>
+void intrusive_splice_list<T, Hook>::unique(Eq eq)
+{
+	iterator i = begin();
+	if (i == end())
+		return;
+	iterator curr = i;
+	++i;
+	while (i != end())
+	{
+		if (eq(*i, *curr))
+		{
+			i = erase(i);
+		}
+		else
+		{
+			curr = i;
+			++i;
+		}
+	}
+}
+
+template<typename T, typename Hook>
+void intrusive_splice_list<T, Hook>::reverse()
+{
+	splice_algo::reverse(&sentinel);
+}
+
+template<typename T, typename Hook>
+void intrusive_splice_list<T, Hook>::remove(const T& val)
+{
+	remove_if([&val](const T& v) -> bool { return v == val; });
+}
+
+template<typename T, typename Hook>
+template<typename Pred>
+Pred intrusive_splice_list<T, Hook>::remove_if(Pred pred)
+{
+	auto i = begin();
+	while (i != end())
+	{
+		if (pred(*i))
+			i = erase(i);
+		else
+			++i;
+	}
+	return pred;
+}
@@ -1,9 +1,61 @@
+#include "container_tester.hpp"
 
 extern void testsuit_performance();
 extern void testsuit_integrity();
+extern void testsuit_avl_sort();
+extern void testsuit_list_sort();
+extern void testsuit_list_alloc();
+extern void testsuit_inline_vector_insert();
+extern void testsuit_inline_vector_oscillate();
+extern void testsuit_inline_vector_memory();
+extern void testsuit_inline_flat_map();
+extern void testsuit_polymorphic();
+extern void testsuit_polymorphic_visit();
+extern void testsuit_polymorphic_alloc();
+extern void testsuit_polymorphic_copy();
+extern void testsuit_debug_container();
+extern void testsuit_intrusive_list();
+extern void testsuit_npsv_index();
+extern void testsuit_avl_batch();
+extern void testsuit_npsv_queries();
+extern void testsuit_pool_splice();
+extern void testsuit_debug_iterators();
+extern void testsuit_unrolled_list();
 
-int main()
+int main(int argc, char** argv)
 {
-	// testsuit_performance();
-	testsuit_integrity();
+	CT::run_options opt;
+	if (!CT::parse_args(argc, argv, opt))
+		return 2;
+
+	// nothing to write out: the correctness suites, then the integrity run, which goes on
+	// until it finds a fault
+	if (!opt.any())
+	{
+		testsuit_intrusive_list();
+		testsuit_npsv_index();
+		testsuit_avl_batch();
+		testsuit_npsv_queries();
+		testsuit_pool_splice();
+		testsuit_debug_iterators();
+		testsuit_unrolled_list();
+		testsuit_polymorphic_copy();
+		testsuit_integrity();
+		return 0;
+	}
+
+	testsuit_performance();
+	// testsuit_avl_sort();
+	// testsuit_list_sort();
+	// testsuit_list_alloc();
+	// testsuit_inline_vector_insert();
+	// testsuit_inline_vector_oscillate();
+	// testsuit_inline_vector_memory();
+	// testsuit_inline_flat_map();
+	// testsuit_polymorphic();
+	// testsuit_polymorphic_visit();
+	// testsuit_polymorphic_alloc();
+	// testsuit_debug_container();
+
+	return CT::finish(opt);
 }
@@ -0,0 +1,44 @@
+
+// replaces the global operator new to count its calls, for the tests that check an
+// operation does not allocate. kept apart, so no other translation unit sees the
+// replacement inline
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+static std::size_t calls = 0;
+
+std::size_t new_calls()
+{
+	return calls;
+}
+
+void* operator new(std::size_t sz)
+{
+	++calls;
+	if (void* p = std::malloc(sz ? sz : 1))
+		return p;
+	throw std::bad_alloc{};
+}
+
+void* operator new(std::size_t sz, const std::nothrow_t&) noexcept
+{
+	++calls;
+	return std::malloc(sz ? sz : 1);
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+	std::free(p);
+}
@@ -1,8 +1,12 @@
+#define SUPRESS_MAIN
 
+#include "avl_array/avl_array.hpp"
 #include "avl_vector.hpp"
 #include "container_tester.hpp"
 #include "inline_vector.hpp"
+#include "polymorphic_container.hpp"
 #include "splice_list.hpp"
+#include "test_item.hpp"
 
 // #include "asyn_kb.h"
 #include "graph.h"
@@ -25,18 +29,25 @@ struct Data
 typedef std::vector<Data> DataVec;
 
 DataVec vectorData, treeData, listData;
+DataVec polyVectorData, polyTreeData, polyListData, polyArrayData;
 
 void all_test(std::size_t sz, bool last = false)
 {
 	CT::clear_times();
+	CT::problem_size = sz;
 
 	std::vector<int> vi;
 	avl::vector<int> ti;
 	std::list<int>   li;
 
-#define ALL vi, ti, li
+	ext::polymorphic_container<test_item>                  pvi;
+	ext::polymorphic_container<test_item, avl::vector>     pti;
+	ext::polymorphic_container<test_item, splice_list>     pli;
+	ext::polymorphic_container<test_item, mkr::avl_array> pai;
 
-	CT::fillup<>{}(sz, vi, ti, li);
+#define ALL vi, ti, li, pvi, pti, pli, pai
+
+	CT::fillup<>{}(sz, ALL);
 
 	CT::insert<>{sz}(ALL);
 	CT::erase<>{sz}(ALL);
@@ -49,16 +60,20 @@ void all_test(std::size_t sz, bool last = false)
 		Data data;
 		data.size        = sz;
 		auto name        = CT::nameof(cont);
-		data.insert_time = CT::time_data[name]["insert_nth"];
-		data.insert_time += CT::time_data[name]["erase_nth"];
-		data.splice_time = CT::time_data[name]["splice_merge"];
-		data.sort_time   = CT::time_data[name]["sort"];
+		data.insert_time = CT::time_data[name]["insert_nth"].total();
+		data.insert_time += CT::time_data[name]["erase_nth"].total();
+		data.splice_time = CT::time_data[name]["splice_merge"].total();
+		data.sort_time   = CT::time_data[name]["sort"].total();
 		return data;
 	};
 
 	vectorData.push_back(mkdata(vi));
 	treeData.push_back(mkdata(ti));
 	listData.push_back(mkdata(li));
+	polyVectorData.push_back(mkdata(pvi));
+	polyTreeData.push_back(mkdata(pti));
+	polyListData.push_back(mkdata(pli));
+	polyArrayData.push_back(mkdata(pai));
 
 	if (last)
 		CT::report_times<>();
@@ -120,8 +135,13 @@ void testsuit()
 	mkimg(vectorData, "VectorData.bmp");
 	mkimg(treeData, "TreeData.bmp");
 	mkimg(listData, "ListData.bmp");
+	mkimg(polyVectorData, "PolyVectorData.bmp");
+	mkimg(polyTreeData, "PolyTreeData.bmp");
+	mkimg(polyListData, "PolyListData.bmp");
+	mkimg(polyArrayData, "PolyArrayData.bmp");
 
-	auto mkimg2 = [](const DataVec& vec, const DataVec& tree, const DataVec& lst) -> void {
+	auto mkimg2 = [](const DataVec& vec, const DataVec& tree, const DataVec& lst, const DataVec* arr,
+					 std::string name) -> void {
 		MultiPlot mp;
 		for (auto&& itm : vec)
 			mp.AddPoint({255, 127, 127}, (double)itm.size, itm.insert_time + itm.splice_time + itm.sort_time);
@@ -129,11 +149,15 @@ void testsuit()
 			mp.AddPoint({127, 255, 127}, (double)itm.size, itm.insert_time + itm.splice_time + itm.sort_time);
 		for (auto&& itm : lst)
 			mp.AddPoint({127, 127, 255}, (double)itm.size, itm.insert_time + itm.splice_time + itm.sort_time);
+		if (arr)
+			for (auto&& itm : *arr)
+				mp.AddPoint({255, 255, 127}, (double)itm.size, itm.insert_time + itm.splice_time + itm.sort_time);
 		Image img = mp.generate(1024, 768);
-		img.Save("all.bmp");
+		img.Save(name);
 	};
 
-	mkimg2(vectorData, treeData, listData);
+	mkimg2(vectorData, treeData, listData, nullptr, "all.bmp");
+	mkimg2(polyVectorData, polyTreeData, polyListData, &polyArrayData, "all_poly.bmp");
 
 	// fitting(insertData, "insert_nth");
 	// fitting(eraseData, "erase_nth");
@@ -1,28 +1,388 @@
 
+#pragma once
+
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <exception>
-#include <functional>
 #include <iterator>
+#include <memory>
+#include <new>
 #include <stdexcept>
 #include <type_traits>
 #include <typeinfo>
+#include <utility>
 #include <vector>
 
 // ----------------------------------------------------------------------------------------------
 
+namespace mkr
+{
+template<class, class, class, class>
+class avl_array;
+}
+
 namespace ext
 {
 
-template<typename, template<typename...> class, template<typename...> class>
+/// <summary>
+/// room for an element inside the item of a polymorphic_container. elements of a type fitting
+/// in Size bytes at Align, and not throwing on move, are built there instead of on the heap.
+/// the items are then bigger by Size, and moving them moves the elements
+/// </summary>
+template<std::size_t Size, std::size_t Align = alignof(void*)>
+struct inline_slot
+{
+	static_assert((Align & (Align - 1)) == 0, "Align is a power of two");
+
+	static const std::size_t size  = Size;
+	static const std::size_t align = Align;
+};
+
+// every element on the heap, the default
+typedef inline_slot<0> no_slot;
+
+/// <summary>
+/// blocks the elements of one polymorphic_container are bump allocated from, whatever their
+/// type. nothing is given back on erase, the blocks all go at once on clear() and when the
+/// container dies. allocations bigger than a quarter block get a block of their own
+/// </summary>
+class monotonic_arena
+{
+public:
+	explicit monotonic_arena(std::size_t block_size = 64 * 1024) noexcept : block_size(block_size) {}
+	monotonic_arena(const monotonic_arena&) = delete;
+	monotonic_arena(monotonic_arena&& other) noexcept : block_size(other.block_size) { swap(other); }
+	monotonic_arena& operator=(const monotonic_arena&) = delete;
+	monotonic_arena& operator                          =(monotonic_arena&& other) noexcept
+	{
+		release();
+		swap(other);
+		return *this;
+	}
+	~monotonic_arena() { release(); }
+
+	void* allocate(std::size_t sz, std::size_t align);
+	// room for sz bytes in the current block, a new block when there is not
+	void reserve(std::size_t sz);
+	// every block back to the heap
+	void release() noexcept;
+	void swap(monotonic_arena&) noexcept;
+
+	// bytes taken from the heap
+	std::size_t reserved() const noexcept { return reserved_bytes; }
+
+private:
+	void* new_block(std::size_t sz);
+
+	std::vector<void*> blocks;
+	char*              cur            = nullptr;
+	char*              end            = nullptr;
+	std::size_t        block_size     = 0;
+	std::size_t        reserved_bytes = 0;
+};
+
+// elements allocated one by one with the Allocator, the default
+struct no_arena
+{
+};
+
+template<typename, template<typename...> class, template<typename...> class, typename, typename>
 class polymorphic_container;
 
+template<typename, template<typename...> class>
+class segregated_container;
+
+// ----------------------------------------------------------------------------------------------
+
+inline void* monotonic_arena::new_block(std::size_t sz)
+{
+	blocks.reserve(blocks.size() + 1);
+	void* b = ::operator new(sz);
+	blocks.push_back(b);
+	reserved_bytes += sz;
+	return b;
+}
+
+inline void* monotonic_arena::allocate(std::size_t sz, std::size_t align)
+{
+	std::size_t pad = std::size_t(-(std::uintptr_t)cur) & (align - 1);
+	if (std::size_t(end - cur) >= sz + pad)
+	{
+		void* p = cur + pad;
+		cur += pad + sz;
+		return p;
+	}
+	if (sz + align > block_size / 4)
+	{
+		// a block of its own, the current one goes on
+		char* b = (char*)new_block(sz + align);
+		return b + (std::size_t(-(std::uintptr_t)b) & (align - 1));
+	}
+	cur = (char*)new_block(block_size);
+	end = cur + block_size;
+	pad = std::size_t(-(std::uintptr_t)cur) & (align - 1);
+	void* p = cur + pad;
+	cur += pad + sz;
+	return p;
+}
+
+inline void monotonic_arena::reserve(std::size_t sz)
+{
+	if (std::size_t(end - cur) >= sz)
+		return;
+	sz  = std::max(sz, block_size);
+	cur = (char*)new_block(sz);
+	end = cur + sz;
+}
+
+inline void monotonic_arena::release() noexcept
+{
+	for (void* b : blocks)
+		::operator delete(b);
+	blocks.clear();
+	cur            = nullptr;
+	end            = nullptr;
+	reserved_bytes = 0;
+}
+
+inline void monotonic_arena::swap(monotonic_arena& other) noexcept
+{
+	using std::swap;
+	swap(blocks, other.blocks);
+	swap(cur, other.cur);
+	swap(end, other.end);
+	swap(block_size, other.block_size);
+	swap(reserved_bytes, other.reserved_bytes);
+}
+
+// ----------------------------------------------------------------------------------------------
+
 namespace detail
 {
 
 template<typename T>
 using clean = typename std::remove_cv<typename std::remove_reference<T>::type>::type;
 
+// U is T, or derived from it
+template<typename U, typename T>
+struct sub_or_same
+{
+	static const bool value = std::is_base_of<clean<T>, clean<U>>::value || std::is_same<clean<T>, clean<U>>::value;
+};
+
+/// <summary>
+/// what the container needs to know about the dynamic type of an element. one constant
+/// table per concrete type (and way of getting rid of it), items point to it, so an item
+/// is the object pointer and the table pointer, nothing more
+/// </summary>
+template<typename T>
+struct type_ops
+{
+	// run the destructor, leave the memory
+	void (*destroy)(T*);
+	// give the memory back. self is the table the item points to, for the tables
+	// carrying a deleter. for objects owned by a deleter destroy does nothing and
+	// this does both
+	void (*deallocate)(const type_ops& self, T*);
+	// a copy of the object, allocated the same way. nullptr when the type is not known
+	// or the object is not on the heap
+	T* (*clone)(const T*);
+	// a copy of the object built at dst, room for size bytes at align. nullptr when the
+	// type is not known
+	T* (*copy)(const T*, void* dst);
+	// move the object living in an item to dst, in the item it goes to, and end the old
+	// one. the new address. nullptr for objects on the heap, the pointer moves instead
+	T* (*relocate)(T*, void* dst);
+	// sizeof and alignof the dynamic type, 0 when not known
+	std::size_t size;
+	std::size_t align;
+};
+
+// copy of the U t is part of, at dst. bytes copied as a block when U allows it
+template<typename T, typename U>
+T* copy_at(const T* t, void* dst)
+{
+	if constexpr (std::is_trivially_copyable<U>::value)
+		return (U*)std::memcpy(dst, (const U*)t, sizeof(U));
+	else
+		return new (dst) U(*(const U*)t);
+}
+
+// reserve n, when the container can
+template<typename C>
+auto reserve(C& c, std::size_t n, int) -> decltype(c.reserve(n), void())
+{
+	c.reserve(n);
+}
+template<typename C>
+void reserve(C&, std::size_t, long)
+{
+}
+
+// the underlying containers differ in what they offer: the member when there is one,
+// the algorithm otherwise
+struct pick_3
+{
+};
+struct pick_2 : pick_3
+{
+};
+struct pick_1 : pick_2
+{
+};
+
+template<typename C, typename It, typename... Args>
+auto emplace(pick_1, C& c, It pos, Args&&... args) -> decltype(c.emplace(pos, std::forward<Args>(args)...))
+{
+	return c.emplace(pos, std::forward<Args>(args)...);
+}
+// insert by copy only: an empty item goes in, then the item made from args is moved to it
+template<typename C, typename It, typename... Args>
+It emplace(pick_2, C& c, It pos, Args&&... args)
+{
+	typename C::value_type item(std::forward<Args>(args)...);
+	It                     i = c.insert(pos, typename C::value_type{});
+	*i                       = std::move(item);
+	return i;
+}
+
+template<typename C>
+auto nth(pick_1, C& c, std::size_t idx) -> decltype(c.nth(idx))
+{
+	return c.nth(idx);
+}
+template<typename C>
+auto nth(pick_2, C& c, std::size_t idx) -> decltype(c.begin() + idx)
+{
+	return c.begin() + idx;
+}
+template<typename C>
+auto nth(pick_3, C& c, std::size_t idx)
+{
+	return std::next(c.begin(), idx);
+}
+
+// nth in less than O(n)
+template<typename C>
+auto indexable(pick_1, C& c) -> decltype(c.nth(0), std::true_type{});
+template<typename C>
+auto indexable(pick_2, C& c) -> decltype(c.begin() + 0, std::true_type{});
+template<typename C>
+std::false_type indexable(pick_3, C&);
+
+template<typename C, typename Less>
+auto sort(pick_1, C& c, Less less) -> decltype(c.sort(less), void())
+{
+	c.sort(less);
+}
+template<typename C, typename Less>
+void sort(pick_2, C& c, Less less)
+{
+	std::sort(c.begin(), c.end(), less);
+}
+
+// avl_array::unique takes a less, the others an equality
+template<typename C>
+struct unique_by_less : std::false_type
+{
+};
+template<class T, class A, class W, class P>
+struct unique_by_less<mkr::avl_array<T, A, W, P>> : std::true_type
+{
+};
+
+template<typename C, typename Less, typename Equal>
+auto unique(pick_1, C& c, Less less, Equal equal) -> decltype(c.unique(equal), void())
+{
+	if constexpr (unique_by_less<C>::value)
+		c.unique(less);
+	else
+		c.unique(equal);
+}
+template<typename C, typename Less, typename Equal>
+void unique(pick_2, C& c, Less, Equal equal)
+{
+	c.erase(std::unique(c.begin(), c.end(), equal), c.end());
+}
+
+template<typename C>
+auto reverse(pick_1, C& c) -> decltype(c.reverse(), void())
+{
+	c.reverse();
+}
+template<typename C>
+void reverse(pick_2, C& c)
+{
+	std::reverse(c.begin(), c.end());
+}
+
+template<typename C, typename Pred>
+auto remove_if(pick_1, C& c, Pred pred) -> decltype(c.remove_if(pred), void())
+{
+	c.remove_if(pred);
+}
+template<typename C, typename Pred>
+void remove_if(pick_2, C& c, Pred pred)
+{
+	c.erase(std::remove_if(c.begin(), c.end(), pred), c.end());
+}
+
+template<typename C, typename Less>
+auto merge(pick_1, C& c, C& other, Less less) -> decltype(c.merge(other, less), void())
+{
+	c.merge(other, less);
+}
+template<typename C, typename Less>
+void merge(pick_2, C& c, C& other, Less less)
+{
+	C dst;
+	reserve(dst, c.size() + other.size(), 0);
+	std::merge(std::make_move_iterator(c.begin()), std::make_move_iterator(c.end()),
+			   std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()), std::back_inserter(dst),
+			   less);
+	c.swap(dst);
+	other.clear();
+}
+
+// [first,last) of other before pos, n elements
+template<typename C, typename It>
+auto splice(pick_1, C& c, It pos, C& other, It first, It last, std::size_t n)
+	-> decltype(c.splice(pos, other, first, last, n), void())
+{
+	c.splice(pos, other, first, last, n);
+}
+template<typename C, typename It>
+auto splice(pick_2, C& c, It pos, C& other, It first, It last, std::size_t)
+	-> decltype(c.splice(pos, other, first, last), void())
+{
+	c.splice(pos, other, first, last);
+}
+template<typename C, typename It>
+void splice(pick_3, C& c, It pos, C& other, It first, It last, std::size_t)
+{
+	assert(&c != &other && "moving items within one container needs a splice of the underlying container");
+	c.insert(pos, std::make_move_iterator(first), std::make_move_iterator(last));
+	other.erase(first, last);
+}
+
+// the bytes of an inline_slot, nothing for a slot of 0
+template<std::size_t Size, std::size_t Align>
+struct slot_storage
+{
+	alignas(Align) unsigned char bytes[Size];
+
+	void* slot() noexcept { return bytes; }
+};
+
+template<std::size_t Align>
+struct slot_storage<0, Align>
+{
+	void* slot() noexcept { return nullptr; }
+};
+
 template<typename, typename, typename>
 struct iterator;
 
@@ -76,11 +436,13 @@ struct iterator : std::iterator<category, T>, iterator_base<T, underlying_iterat
 
 	using iterator_base<T, underlying_iterator>::iterator_base;
 
-	template<typename, template<typename...> class, template<typename...> class>
+	template<typename, template<typename...> class, template<typename...> class, typename, typename>
 	friend class ext::polymorphic_container;
+	template<typename, template<typename...> class>
+	friend class ext::segregated_container;
 
-	// if the underlying iterator can convert, support it
-	template<typename T2, typename UI2, typename C2>
+	// if the underlying iterator can convert, support it. not from const T to T
+	template<typename T2, typename UI2, typename C2, typename = std::enable_if_t<std::is_convertible<T*, T2*>::value>>
 	operator iterator<T2, UI2, C2>()
 	{
 		return {this->iter};
@@ -131,11 +493,13 @@ struct iterator<T, underlying_iterator, std::random_access_iterator_tag>
 
 	std::ptrdiff_t operator-(const iterator& other) const { return this->iter - other.iter; }
 
-	template<typename, template<typename...> class, template<typename...> class>
+	template<typename, template<typename...> class, template<typename...> class, typename, typename>
 	friend class ext::polymorphic_container;
+	template<typename, template<typename...> class>
+	friend class ext::segregated_container;
 
-	// if the underlying iterator can convert, support it
-	template<typename T2, typename UI2, typename C2>
+	// if the underlying iterator can convert, support it. not from const T to T
+	template<typename T2, typename UI2, typename C2, typename = std::enable_if_t<std::is_convertible<T*, T2*>::value>>
 	operator iterator<T2, UI2, C2>()
 	{
 		return {this->iter};
@@ -149,24 +513,58 @@ struct iterator<T, underlying_iterator, std::random_access_iterator_tag>
 
 // ----------------------------------------------------------------------------------------------
 
-template<typename T, template<typename...> class Underlying = std::vector, template<typename...> class Allocator = std::allocator>
+template<typename T, template<typename...> class Underlying = std::vector,
+		 template<typename...> class Allocator = std::allocator, typename Slot = no_slot, typename Arena = no_arena>
 class polymorphic_container
 {
 private:
-	typedef std::function<void(T*)> deleter_t;
-	struct Item
+	typedef detail::type_ops<T>                           type_ops;
+	typedef detail::slot_storage<Slot::size, Slot::align> slot_storage;
+
+	// U is built in the item
+	template<typename U>
+	static constexpr bool fits_slot = sizeof(U) <= Slot::size && alignof(U) <= Slot::align &&
+									  std::is_nothrow_move_constructible<U>::value;
+
+	// the elements not in a slot come from the arena
+	static constexpr bool has_arena = !std::is_same<Arena, no_arena>::value;
+
+	template<typename U>
+	struct in_slot;
+	template<typename U>
+	struct in_arena;
+
+	struct Item : slot_storage
 	{
-		T*        value   = nullptr;
-		deleter_t deleter = nullptr;
+		T*              value = nullptr;
+		const type_ops* vt    = nullptr;
 
-		Item()                  = default;
-		Item(const Item& other) = delete;
-		Item(Item&& other) noexcept : Item() { swap(other); }
+		Item(T* v, const type_ops* t) noexcept : value(v), vt(t) {}
+
+		// U built in the slot
+		template<typename U, typename... Args>
+		Item(std::in_place_type_t<U>, Args&&... args)
+			: value(new (this->slot()) U(std::forward<Args>(args)...)), vt(&in_slot<U>::ops)
+		{
+		}
+
+		Item() = default;
+		// for containers inserting by copy only, they get empty items. a container that
+		// copies a live item would lose its element, that is not survivable, NDEBUG or not
+		Item(const Item& other) noexcept : Item()
+		{
+			if (other.value)
+				std::terminate();
+		}
+		Item(Item&& other) noexcept : Item() { take(other); }
 		Item& operator=(const Item& other) = delete;
 		Item& operator                     =(Item&& other) noexcept
 		{
-			clear();
-			swap(other);
+			if (this != &other)
+			{
+				clear();
+				take(other);
+			}
 			return *this;
 		}
 		~Item() { clear(); }
@@ -174,6 +572,9 @@ private:
 		void swap(Item&) noexcept;
 		void clear();
 
+		// the element of other, which is left empty. this is empty
+		void take(Item& other) noexcept;
+
 		bool operator<(const Item& i) { return (*value) < *i; }
 		bool operator<=(const Item& i) { return (*value) <= *i; }
 		bool operator>(const Item& i) { return (*value) > *i; }
@@ -181,9 +582,7 @@ private:
 		bool operator==(const Item& i) { return (*value) == *i; }
 		bool operator!=(const Item& i) { return (*value) != *i; }
 	};
-
-	template<typename U>
-	deleter_t make_deleter();
+	static_assert(Slot::size != 0 || sizeof(Item) == 2 * sizeof(void*), "Item is two pointers");
 
 	template<typename U>
 	static Allocator<U>& allocator()
@@ -192,56 +591,86 @@ private:
 		return a;
 	}
 
+	// the tables: objects from allocator<U>(), objects deleted with delete, with a Deleter
+	template<typename U>
+	struct typed;
+	struct deleted;
+	template<typename Deleter, bool stateless>
+	struct with_deleter;
+
 	typedef Underlying<Item, Allocator<Item>>                                     underlying_container;
 	typedef typename underlying_container::iterator                               underlying_iterator;
-	typedef typename underlying_container::const_iterator                         underlying_const_iterator;
 	typedef typename std::iterator_traits<underlying_iterator>::iterator_category underlying_iterator_category;
 
 	template<typename U>
-	struct sub_or_same
-	{
-		using CT                = detail::clean<T>;
-		using CU                = detail::clean<U>;
-		static const bool value = std::is_base_of<CT, CU>::value || std::is_same<CT, CU>::value;
-	};
+	using sub_or_same = detail::sub_or_same<U, T>;
 
 	static const bool underlying_swap_noexcept =
 		noexcept(std::declval<underlying_container&>().swap(std::declval<underlying_container&>()));
 
+	static const bool indexable =
+		decltype(detail::indexable(detail::pick_1{}, std::declval<underlying_container&>()))::value;
+
 public:
 	typedef std::size_t size_type;
 	typedef T           value_type;
 	typedef T&          reference;
 	typedef const T&    const_reference;
 
-	polymorphic_container()                             = default;
-	polymorphic_container(const polymorphic_container&) = default;
-	polymorphic_container(polymorphic_container&&)      = default;
+	polymorphic_container() = default;
+	// the copy gets an arena of its own, default constructed
+	polymorphic_container(const polymorphic_container& other) { copy_from(other); }
+	// not defaulted, the underlying container may copy its items on move (mkr::avl_array)
+	polymorphic_container(polymorphic_container&& other) noexcept(underlying_swap_noexcept)
+		: polymorphic_container()
+	{
+		swap(other);
+	}
 
-	polymorphic_container& operator=(const polymorphic_container&) = default;
-	polymorphic_container& operator=(polymorphic_container&&) = default;
+	explicit polymorphic_container(Arena a) : store(std::move(a)) {}
+
+	polymorphic_container& operator=(const polymorphic_container& other)
+	{
+		assign(other);
+		return *this;
+	}
+	// the elements go before the arena they may live in
+	polymorphic_container& operator=(polymorphic_container&& other) noexcept(underlying_swap_noexcept)
+	{
+		clear();
+		swap(other);
+		return *this;
+	}
 
 	~polymorphic_container() = default;
 
-	void assign(const polymorphic_container& other) { data.assign(other.data); }
-	void assign(polymorphic_container&& other) noexcept(underlying_swap_noexcept) { data.swap(other.data); }
+	void assign(const polymorphic_container& other);
+	void assign(polymorphic_container&& other) noexcept(underlying_swap_noexcept) { swap(other); }
 
-	void clear() { data.clear(); }
-	void swap(polymorphic_container& other) noexcept(underlying_swap_noexcept) { data.swap(other.data); }
-	void swap(polymorphic_container&& other) noexcept(underlying_swap_noexcept) { data.swap(other.data); }
+	void clear();
+	void swap(polymorphic_container& other) noexcept(underlying_swap_noexcept);
+	void swap(polymorphic_container&& other) noexcept(underlying_swap_noexcept) { swap(other); }
 
-	size_type size() { return data.size(); }
-	bool      empty() { return data.empty(); }
+	const Arena& get_arena() const { return store; }
+
+	size_type size() const { return data.size(); }
+	bool      empty() const { return data.empty(); }
 
 	typedef detail::iterator<T, underlying_iterator, underlying_iterator_category>             iterator;
-	typedef detail::iterator<const T, underlying_const_iterator, underlying_iterator_category> const_iterator;
+	// both over the iterator of the underlying container, not all of them take a const_iterator
+	// for a position
+	typedef detail::iterator<const T, underlying_iterator, underlying_iterator_category> const_iterator;
 
 	iterator       begin() { return {data.begin()}; }
 	iterator       end() { return {data.end()}; }
-	const_iterator begin() const { return {data.begin()}; }
-	const_iterator end() const { return {data.end()}; }
-	const_iterator cbegin() const { return {data.begin()}; }
-	const_iterator cend() const { return {data.end()}; }
+	const_iterator begin() const { return {mut().begin()}; }
+	const_iterator end() const { return {mut().end()}; }
+	const_iterator cbegin() const { return {mut().begin()}; }
+	const_iterator cend() const { return {mut().end()}; }
+
+	// O(log n) over avl::vector, avl_array or an indexed splice_list
+	iterator       nth(size_type idx) { return {detail::nth(detail::pick_1{}, data, idx)}; }
+	const_iterator nth(size_type idx) const { return {detail::nth(detail::pick_1{}, mut(), idx)}; }
 
 	typedef std::reverse_iterator<iterator>       reverse_iterator;
 	typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
@@ -254,12 +683,23 @@ public:
 	const_reverse_iterator crend() const { return const_reverse_iterator{begin()}; }
 
 private:
+	// make the object, then the item owning it
+	template<typename U, typename... Args>
+	underlying_iterator make_item(const_iterator, Args&&...);
+
+	// copies of the elements of other at the end, through their tables
+	void copy_from(const polymorphic_container& other);
+	// copy of the element of from in the empty item to
+	void copy_item(const Item& from, Item& to);
+
 	template<typename U>
 	iterator explicit_insert(const_iterator, const U&);
 
 	template<typename U>
 	iterator explicit_insert(const_iterator, U&&);
 
+	underlying_container& mut() const { return const_cast<underlying_container&>(data); }
+
 public:
 	template<typename U, typename = std::enable_if_t<sub_or_same<U>::value>>
 	iterator insert(const_iterator i, U&& u) // creates copy
@@ -267,6 +707,13 @@ public:
 		return explicit_insert<detail::clean<U>>(i, std::forward<U>(u));
 	}
 
+	template<typename U>
+	auto insert(const_iterator i, U&& u) // a T made from u
+		-> std::enable_if_t<!sub_or_same<U>::value && std::is_constructible<T, U&&>::value, iterator>
+	{
+		return emplace<T>(i, std::forward<U>(u));
+	}
+
 	iterator insert(const_iterator,
 					T*); // takes ownership, uses delete for disposal
 
@@ -279,6 +726,7 @@ public:
 	iterator emplace(const_iterator, Args&&...);
 
 	iterator erase(const_iterator i) { return {data.erase(i.iter)}; }
+	iterator erase(const_iterator first, const_iterator last) { return {data.erase(first.iter, last.iter)}; }
 
 	template<typename... Args>
 	void push_back(Args&&... args)
@@ -292,7 +740,7 @@ public:
 		emplace<U>(end(), std::forward<Args>(args)...);
 	}
 
-	void pop_back() { erase(end()); }
+	void pop_back() { erase(std::prev(end())); }
 
 	T&       back() { return *data.back(); }
 	const T& back() const { return *data.back(); }
@@ -302,58 +750,65 @@ public:
 
 	T& operator[](std::size_t idx)
 	{
-		static_assert(
-			detail::sub_or_same<underlying_iterator_category, std::random_access_iterator_tag>::value,
-			"underlying container does not support random access");
-		return begin()[idx];
+		static_assert(indexable, "underlying container does not support random access");
+		return *nth(idx);
 	}
 	const T& operator[](std::size_t idx) const
 	{
-		static_assert(
-			detail::sub_or_same<underlying_iterator_category, std::random_access_iterator_tag>::value,
-			"underlying container does not support random access");
-		return begin()[idx];
+		static_assert(indexable, "underlying container does not support random access");
+		return *nth(idx);
 	}
 
 	T& at(std::size_t idx)
 	{
-		static_assert(
-			detail::sub_or_same<underlying_iterator_category, std::random_access_iterator_tag>::value,
-			"underlying container does not support random access");
+		static_assert(indexable, "underlying container does not support random access");
 		if (idx >= size())
 			throw std::out_of_range{"index"};
-		return begin()[idx];
+		return *nth(idx);
 	}
 	const T& at(std::size_t idx) const
 	{
-		static_assert(
-			detail::sub_or_same<underlying_iterator_category, std::random_access_iterator_tag>::value,
-			"underlying container does not support random access");
+		static_assert(indexable, "underlying container does not support random access");
 		if (idx >= size())
 			throw std::out_of_range{"index"};
-		return begin()[idx];
+		return *nth(idx);
 	}
 
+	// the list operations, on the items: the elements stay where they are. through the
+	// members of the underlying container when it has them. elements in an arena can not
+	// go to another container
+	void splice(const_iterator pos, polymorphic_container& other, const_iterator first, const_iterator last);
+	// n is the number of elements in [first,last), for the containers that can use it
+	void splice(const_iterator pos, polymorphic_container& other, const_iterator first, const_iterator last,
+				size_type n);
+	void merge(polymorphic_container& other);
+	void sort();
+	void unique();
+	void reverse() { detail::reverse(detail::pick_1{}, data); }
+	void remove(const T&);
+
 	int compare(const polymorphic_container&) const;
 
 private:
+	Arena                store; // declared first, so it outlives the elements
 	underlying_container data;
 };
 
 // ----------------------------------------------------------------------------------------------
 
-template<typename T, template<typename...> class U, template<typename...> class A>
-void swap(polymorphic_container<T, U, A>& lhs, polymorphic_container<T, U, A>& rhs)
+template<typename T, template<typename...> class U, template<typename...> class A, typename S, typename R>
+void swap(polymorphic_container<T, U, A, S, R>& lhs, polymorphic_container<T, U, A, S, R>& rhs)
 {
 	lhs.swap(rhs);
 }
 
-template<typename T, template<typename...> class U, template<typename...> class A>
-int polymorphic_container<T, Underlying, Allocator>::compare(const polymorphic_container& rhs) const
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+int polymorphic_container<T, Underlying, Allocator, Slot, Arena>::compare(const polymorphic_container& rhs) const
 {
+	auto&& lhs = *this;
 	auto   li  = lhs.begin();
 	auto   ri  = rhs.begin();
-	auto&& lhs = *this;
 	while (true)
 	{
 		bool le = (li == lhs.end());
@@ -376,141 +831,666 @@ int polymorphic_container<T, Underlying, Allocator>::compare(const polymorphic_c
 	}
 }
 
-template<typename T, template<typename...> class U, template<typename...> class A>
-bool operator==(polymorphic_container<T, U, A>& lhs, polymorphic_container<T, U, A>& rhs)
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+void polymorphic_container<T, Underlying, Allocator, Slot, Arena>::splice(
+	const_iterator pos, polymorphic_container& other, const_iterator first, const_iterator last)
+{
+	splice(pos, other, first, last, (size_type)std::distance(first, last));
+}
+
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+void polymorphic_container<T, Underlying, Allocator, Slot, Arena>::splice(
+	const_iterator pos, polymorphic_container& other, const_iterator first, const_iterator last, size_type n)
+{
+	static_assert(!has_arena, "elements in an arena can not go to another container");
+	detail::splice(detail::pick_1{}, data, pos.iter, other.data, first.iter, last.iter, n);
+}
+
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+void polymorphic_container<T, Underlying, Allocator, Slot, Arena>::merge(polymorphic_container& other)
+{
+	static_assert(!has_arena, "elements in an arena can not go to another container");
+	detail::merge(detail::pick_1{}, data, other.data, [](const Item& a, const Item& b) { return *a.value < *b.value; });
+}
+
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+void polymorphic_container<T, Underlying, Allocator, Slot, Arena>::sort()
+{
+	detail::sort(detail::pick_1{}, data, [](const Item& a, const Item& b) { return *a.value < *b.value; });
+}
+
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+void polymorphic_container<T, Underlying, Allocator, Slot, Arena>::unique()
+{
+	detail::unique(
+		detail::pick_1{}, data, [](const Item& a, const Item& b) { return *a.value < *b.value; },
+		[](const Item& a, const Item& b) { return *a.value == *b.value; });
+}
+
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+void polymorphic_container<T, Underlying, Allocator, Slot, Arena>::remove(const T& t)
+{
+	detail::remove_if(detail::pick_1{}, data, [&t](const Item& i) { return *i.value == t; });
+}
+
+template<typename T, template<typename...> class U, template<typename...> class A, typename S, typename R>
+bool operator==(polymorphic_container<T, U, A, S, R>& lhs, polymorphic_container<T, U, A, S, R>& rhs)
 {
 	return lhs.compare(rhs) == 0;
 }
 
-template<typename T, template<typename...> class U, template<typename...> class A>
-bool operator!=(polymorphic_container<T, U, A>& lhs, polymorphic_container<T, U, A>& rhs)
+template<typename T, template<typename...> class U, template<typename...> class A, typename S, typename R>
+bool operator!=(polymorphic_container<T, U, A, S, R>& lhs, polymorphic_container<T, U, A, S, R>& rhs)
 {
 	return lhs.compare(rhs) != 0;
 }
 
-template<typename T, template<typename...> class U, template<typename...> class A>
-bool operator<(polymorphic_container<T, U, A>& lhs, polymorphic_container<T, U, A>& rhs)
+template<typename T, template<typename...> class U, template<typename...> class A, typename S, typename R>
+bool operator<(polymorphic_container<T, U, A, S, R>& lhs, polymorphic_container<T, U, A, S, R>& rhs)
 {
 	return lhs.compare(rhs) < 0;
 }
 
-template<typename T, template<typename...> class U, template<typename...> class A>
-bool operator<=(polymorphic_container<T, U, A>& lhs, polymorphic_container<T, U, A>& rhs)
+template<typename T, template<typename...> class U, template<typename...> class A, typename S, typename R>
+bool operator<=(polymorphic_container<T, U, A, S, R>& lhs, polymorphic_container<T, U, A, S, R>& rhs)
 {
 	return lhs.compare(rhs) <= 0;
 }
 
-template<typename T, template<typename...> class U, template<typename...> class A>
-bool operator>(polymorphic_container<T, U, A>& lhs, polymorphic_container<T, U, A>& rhs)
+template<typename T, template<typename...> class U, template<typename...> class A, typename S, typename R>
+bool operator>(polymorphic_container<T, U, A, S, R>& lhs, polymorphic_container<T, U, A, S, R>& rhs)
 {
 	return lhs.compare(rhs) > 0;
 }
 
-template<typename T, template<typename...> class U, template<typename...> class A>
-bool operator>=(polymorphic_container<T, U, A>& lhs, polymorphic_container<T, U, A>& rhs)
+template<typename T, template<typename...> class U, template<typename...> class A, typename S, typename R>
+bool operator>=(polymorphic_container<T, U, A, S, R>& lhs, polymorphic_container<T, U, A, S, R>& rhs)
 {
 	return lhs.compare(rhs) >= 0;
 }
 
 // ----------------------------------------------------------------------------------------------
 
-template<typename T, template<typename...> class Underlying, template<typename...> class Allocator>
-void polymorphic_container<T, Underlying, Allocator>::Item::swap(Item& other) noexcept
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+template<typename U>
+struct polymorphic_container<T, Underlying, Allocator, Slot, Arena>::typed
+{
+	static void destroy(T* t) { ((U*)t)->~U(); }
+	static void deallocate(const type_ops&, T* t) { allocator<U>().deallocate((U*)t, 1); }
+	static T*   clone(const T* t)
+	{
+		U* space = allocator<U>().allocate(1);
+		try
+		{
+			return detail::copy_at<T, U>(t, space);
+		}
+		catch (...)
+		{
+			allocator<U>().deallocate(space, 1);
+			throw;
+		}
+	}
+
+	static constexpr type_ops ops = {
+		&destroy, &deallocate, &clone, &detail::copy_at<T, U>, nullptr, sizeof(U), alignof(U)};
+};
+
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+void polymorphic_container<T, Underlying, Allocator, Slot, Arena>::clear()
+{
+	data.clear();
+	if constexpr (has_arena)
+		store.release();
+}
+
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+void polymorphic_container<T, Underlying, Allocator, Slot, Arena>::swap(polymorphic_container& other) noexcept(
+	underlying_swap_noexcept)
 {
 	using std::swap;
-	swap(value, other.value);
-	swap(deleter, other.deleter);
+	data.swap(other.data);
+	swap(store, other.store);
+}
+
+/// <summary>
+/// elements not known to the container by type (inserted by pointer) can not be copied,
+/// the copy throws std::logic_error. basic guarantee, the elements copied so far stay
+/// </summary>
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+void polymorphic_container<T, Underlying, Allocator, Slot, Arena>::assign(const polymorphic_container& other)
+{
+	if (this == &other)
+		return;
+	clear();
+	copy_from(other);
 }
 
-template<typename T, template<typename...> class Underlying, template<typename...> class Allocator>
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+void polymorphic_container<T, Underlying, Allocator, Slot, Arena>::copy_from(const polymorphic_container& other)
+{
+	if constexpr (has_arena)
+	{
+		// one block for all of them, alignment at its worst. the types not known have no
+		// size, their copy throws
+		std::size_t bytes = 0;
+		for (const Item& i : other.data)
+			if (!i.vt->relocate && i.vt->copy)
+				bytes += i.vt->size + i.vt->align - 1;
+		store.reserve(bytes);
+	}
+	detail::reserve(data, data.size() + other.data.size(), 0);
+	for (const Item& from : other.data)
+	{
+		auto to = detail::emplace(detail::pick_1{}, data, data.end());
+		try
+		{
+			copy_item(from, *to);
+		}
+		catch (...)
+		{
+			data.erase(to);
+			throw;
+		}
+	}
+}
+
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+void polymorphic_container<T, Underlying, Allocator, Slot, Arena>::copy_item(const Item& from, Item& to)
+{
+	const type_ops* vt = from.vt;
+	if (!vt->copy)
+		throw std::logic_error{"copy of an element of unknown type"};
+	if (vt->relocate)
+		to.value = vt->copy(from.value, to.slot());
+	else if constexpr (has_arena)
+		to.value = vt->copy(from.value, store.allocate(vt->size, vt->align));
+	else
+		to.value = vt->clone(from.value);
+	to.vt = vt;
+}
+
+// ----------------------------------------------------------------------------------------------
+
+/// <summary>
+/// objects built in the item: nothing to give back, moving the item moves the object
+/// </summary>
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
 template<typename U>
-auto polymorphic_container<T, Underlying, Allocator>::make_deleter() -> deleter_t
+struct polymorphic_container<T, Underlying, Allocator, Slot, Arena>::in_slot
 {
-	auto deleter = [](T* t) -> void {
-		U* item = (U*)t;
-		allocator<U>().deallocate(item, 1);
-	};
-	return deleter;
+	static void destroy(T* t) { ((U*)t)->~U(); }
+	static void deallocate(const type_ops&, T*) {}
+	static T*   relocate(T* t, void* dst)
+	{
+		U* u = new (dst) U(std::move(*(U*)t));
+		((U*)t)->~U();
+		return u;
+	}
+
+	static constexpr type_ops ops = {
+		&destroy, &deallocate, nullptr, &detail::copy_at<T, U>, &relocate, sizeof(U), alignof(U)};
+};
+
+// objects in the arena of the container, the memory goes with the arena
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+template<typename U>
+struct polymorphic_container<T, Underlying, Allocator, Slot, Arena>::in_arena
+{
+	static void destroy(T* t) { ((U*)t)->~U(); }
+	static void deallocate(const type_ops&, T*) {}
+
+	static constexpr type_ops ops = {
+		&destroy, &deallocate, nullptr, &detail::copy_at<T, U>, nullptr, sizeof(U), alignof(U)};
+};
+
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+struct polymorphic_container<T, Underlying, Allocator, Slot, Arena>::deleted
+{
+	static void destroy(T*) {}
+	static void deallocate(const type_ops&, T* t) { delete t; }
+
+	static constexpr type_ops ops = {&destroy, &deallocate, nullptr, nullptr, nullptr, 0, 0};
+};
+
+/// <summary>
+/// a Deleter without state gets one table, like the types. one with state is kept
+/// in a table of its own for the item, which goes with the object
+/// </summary>
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+template<typename Deleter>
+struct polymorphic_container<T, Underlying, Allocator, Slot, Arena>::with_deleter<Deleter, true>
+{
+	static void destroy(T*) {}
+	static void deallocate(const type_ops&, T* t) { Deleter{}(t); }
+
+	static constexpr type_ops ops = {&destroy, &deallocate, nullptr, nullptr, nullptr, 0, 0};
+};
+
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+template<typename Deleter>
+struct polymorphic_container<T, Underlying, Allocator, Slot, Arena>::with_deleter<Deleter, false> : type_ops
+{
+	Deleter d;
+
+	with_deleter(const Deleter& d) : type_ops{&destroy, &deallocate, nullptr, nullptr, nullptr, 0, 0}, d(d) {}
+
+	static void destroy(T*) {}
+	static void deallocate(const type_ops& self, T* t)
+	{
+		auto* wd = static_cast<const with_deleter*>(&self);
+		wd->d(t);
+		delete wd;
+	}
+};
+
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+void polymorphic_container<T, Underlying, Allocator, Slot, Arena>::Item::swap(Item& other) noexcept
+{
+	Item tmp(std::move(other));
+	other = std::move(*this);
+	*this = std::move(tmp);
 }
 
-template<typename T, template<typename...> class Underlying, template<typename...> class Allocator>
-void polymorphic_container<T, Underlying, Allocator>::Item::clear()
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+void polymorphic_container<T, Underlying, Allocator, Slot, Arena>::Item::take(Item& other) noexcept
+{
+	assert(!value);
+	vt = other.vt;
+	if constexpr (Slot::size != 0)
+		value = (vt && vt->relocate) ? vt->relocate(other.value, this->slot()) : other.value;
+	else
+		value = other.value;
+	other.value = nullptr;
+	other.vt    = nullptr;
+}
+
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+void polymorphic_container<T, Underlying, Allocator, Slot, Arena>::Item::clear()
 {
 	if (value)
 	{
-		assert(deleter);
-		deleter(value);
+		assert(vt);
+		vt->destroy(value);
+		vt->deallocate(*vt, value);
 	}
-	value   = nullptr;
-	deleter = nullptr;
+	value = nullptr;
+	vt    = nullptr;
 }
 
-template<typename T, template<typename...> class Underlying, template<typename...> class Allocator>
-auto polymorphic_container<T, Underlying, Allocator>::Item::operator*() const -> T&
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+auto polymorphic_container<T, Underlying, Allocator, Slot, Arena>::Item::operator*() const -> T&
 {
 	assert(value);
 	return *value;
 }
 
-template<typename T, template<typename...> class Underlying, template<typename...> class Allocator>
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+template<typename U, typename... Args>
+auto polymorphic_container<T, Underlying, Allocator, Slot, Arena>::make_item(const_iterator i, Args&&... args)
+	-> underlying_iterator
+{
+	if constexpr (fits_slot<U>)
+	{
+		return detail::emplace(detail::pick_1{}, data, i.iter, std::in_place_type<U>, std::forward<Args>(args)...);
+	}
+	else if constexpr (has_arena)
+	{
+		// the memory stays in the arena if the constructor throws
+		U* value = new (store.allocate(sizeof(U), alignof(U))) U(std::forward<Args>(args)...);
+		return detail::emplace(detail::pick_1{}, data, i.iter, Item{value, &in_arena<U>::ops});
+	}
+	else
+	{
+		U* space = allocator<U>().allocate(1);
+		U* value;
+		try
+		{
+			value = new (space) U(std::forward<Args>(args)...);
+		}
+		catch (...)
+		{
+			allocator<U>().deallocate(space, 1);
+			throw;
+		}
+		// owned from here on, the item cleans up if emplace throws
+		return detail::emplace(detail::pick_1{}, data, i.iter, Item{value, &typed<U>::ops});
+	}
+}
+
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
 template<typename U>
-auto polymorphic_container<T, Underlying, Allocator>::explicit_insert(const_iterator i, const U& u) -> iterator
+auto polymorphic_container<T, Underlying, Allocator, Slot, Arena>::explicit_insert(const_iterator i, const U& u)
+	-> iterator
 {
 	assert((typeid(u) == typeid(U)) && "allocator::deallocate need to know the exact type");
-	U*   space    = allocator<U>().allocate(1);
-	U*   value    = new (space) U(u);
-	auto iter     = data.emplace(i.iter);
-	iter->value   = value;
-	iter->deleter = make_deleter<U>();
-	return {iter};
+	return {make_item<U>(i, u)};
 }
 
-template<typename T, template<typename...> class Underlying, template<typename...> class Allocator>
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
 template<typename U>
-auto polymorphic_container<T, Underlying, Allocator>::explicit_insert(const_iterator i, U&& u) -> iterator
+auto polymorphic_container<T, Underlying, Allocator, Slot, Arena>::explicit_insert(const_iterator i, U&& u) -> iterator
 {
 	assert((typeid(u) == typeid(U)) && "allocator::deallocate need to know the exact type");
-	U*   space    = allocator<U>().allocate(1);
-	U*   value    = new (space) U(std::move(u));
-	auto iter     = data.emplace(i.iter);
-	iter->value   = value;
-	iter->deleter = make_deleter<U>();
-	return {iter};
+	return {make_item<U>(i, std::move(u))};
 }
 
-template<typename T, template<typename...> class Underlying, template<typename...> class Allocator>
-auto polymorphic_container<T, Underlying, Allocator>::insert(const_iterator i, T* t) -> iterator
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
+auto polymorphic_container<T, Underlying, Allocator, Slot, Arena>::insert(const_iterator i, T* t) -> iterator
 {
-	auto iter     = data.emplace(i.iter);
-	iter->value   = t;
-	iter->deleter = [](T* t) -> void { delete t; };
-	return {iter};
+	// owned from here on, deleted by the item if the emplace throws
+	Item item{t, &deleted::ops};
+	return {detail::emplace(detail::pick_1{}, data, i.iter, std::move(item))};
 }
 
-template<typename T, template<typename...> class Underlying, template<typename...> class Allocator>
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
 template<typename Deleter>
-auto polymorphic_container<T, Underlying, Allocator>::insert(const_iterator i, T* t, const Deleter& d) -> iterator
+auto polymorphic_container<T, Underlying, Allocator, Slot, Arena>::insert(const_iterator i, T* t, const Deleter& d)
+	-> iterator
 {
-	auto iter     = data.emplace(i.iter);
-	iter->value   = t;
-	iter->deleter = [d](T* t) -> void { d(t); };
-	return {iter};
+	constexpr bool stateless = std::is_empty<Deleter>::value && std::is_default_constructible<Deleter>::value;
+	const type_ops* vt;
+	try
+	{
+		if constexpr (stateless)
+			vt = &with_deleter<Deleter, true>::ops;
+		else
+			vt = new with_deleter<Deleter, false>(d);
+	}
+	catch (...)
+	{
+		d(t);
+		throw;
+	}
+	return {detail::emplace(detail::pick_1{}, data, i.iter, Item{t, vt})};
 }
 
-template<typename T, template<typename...> class Underlying, template<typename...> class Allocator>
+template<typename T, template<typename...> class Underlying, template<typename...> class Allocator, typename Slot,
+		 typename Arena>
 template<typename U, typename... Args, typename>
-auto polymorphic_container<T, Underlying, Allocator>::emplace(const_iterator i, Args&&... args) -> iterator
+auto polymorphic_container<T, Underlying, Allocator, Slot, Arena>::emplace(const_iterator i, Args&&... args) -> iterator
 {
-	U*   space    = allocator<U>().allocate(1);
-	U*   value    = new (space) U(std::forward<Args>(args)...);
-	auto iter     = data.emplace(i.iter);
-	iter->value   = value;
-	iter->deleter = make_deleter<U>();
-	return {iter};
+	return {make_item<U>(i, std::forward<Args>(args)...)};
+}
+
+// ----------------------------------------------------------------------------------------------
+
+/// <summary>
+/// polymorphic sequence keeping each concrete type in a pool of its own, chunks of U that
+/// never move. for_each<U> runs over one pool with the type known, so the calls are direct
+/// (devirtualised when U or the function is final) and memory is read in order. visit_all
+/// goes pool by pool. the insertion order is kept in an index of pointers, for begin(),
+/// end() and operator[]. elements are added at the end and go all at once with clear()
+/// </summary>
+template<typename T, template<typename...> class Allocator = std::allocator>
+class segregated_container
+{
+	// an entry of the order index, shaped like the items of polymorphic_container
+	struct Ref
+	{
+		T* value;
+	};
+	typedef std::vector<Ref> order_t;
+
+	struct pool_base
+	{
+		std::size_t count = 0;
+
+		virtual ~pool_base() = default;
+		virtual void clear()  = 0;
+		// every element as a T, through cb
+		virtual void visit(void (*cb)(void*, T&), void* ctx) = 0;
+	};
+	template<typename U>
+	struct pool;
+
+	// a number per concrete type, the slot of its pool
+	static std::size_t next_id()
+	{
+		static std::size_t n = 0;
+		return n++;
+	}
+	template<typename U>
+	static std::size_t type_id()
+	{
+		static const std::size_t id = next_id();
+		return id;
+	}
+
+	template<typename U>
+	pool<U>* find_pool() const;
+
+public:
+	typedef std::size_t size_type;
+	typedef T           value_type;
+	typedef T&          reference;
+	typedef const T&    const_reference;
+
+	typedef detail::iterator<T, typename order_t::iterator, std::random_access_iterator_tag>             iterator;
+	typedef detail::iterator<const T, typename order_t::const_iterator, std::random_access_iterator_tag> const_iterator;
+
+	segregated_container() = default;
+	segregated_container(const segregated_container&) = delete;
+	segregated_container(segregated_container&&)      = default;
+
+	segregated_container& operator=(const segregated_container&) = delete;
+	segregated_container& operator=(segregated_container&&) = default;
+
+	~segregated_container() = default;
+
+	size_type size() const { return order.size(); }
+	bool      empty() const { return order.empty(); }
+	void      clear();
+
+	// number of elements of exactly type U
+	template<typename U>
+	size_type count() const;
+
+	template<typename U = T, typename... Args, typename = std::enable_if_t<detail::sub_or_same<U, T>::value>>
+	U& emplace_back(Args&&...);
+
+	template<typename U, typename = std::enable_if_t<detail::sub_or_same<U, T>::value>>
+	void push_back(U&& u)
+	{
+		emplace_back<detail::clean<U>>(std::forward<U>(u));
+	}
+
+	// fn(U&) for the elements of exactly type U, pool order
+	template<typename U, typename Fn>
+	void for_each(Fn&& fn);
+
+	// fn(U&) for the elements of each type in Us, as for_each<U>, then fn(T&) for the
+	// elements of the other types, pool by pool
+	template<typename... Us, typename Fn>
+	void visit_all(Fn&& fn);
+
+	// insertion order
+	iterator       begin() { return {order.begin()}; }
+	iterator       end() { return {order.end()}; }
+	const_iterator begin() const { return {order.begin()}; }
+	const_iterator end() const { return {order.end()}; }
+
+	T&       operator[](std::size_t idx) { return *order[idx].value; }
+	const T& operator[](std::size_t idx) const { return *order[idx].value; }
+	T&       front() { return *order.front().value; }
+	const T& front() const { return *order.front().value; }
+	T&       back() { return *order.back().value; }
+	const T& back() const { return *order.back().value; }
+
+private:
+	std::vector<std::unique_ptr<pool_base>> pools; // by type_id
+	order_t                                 order;
+};
+
+// ----------------------------------------------------------------------------------------------
+
+template<typename T, template<typename...> class Allocator>
+template<typename U>
+struct segregated_container<T, Allocator>::pool : pool_base
+{
+	// elements per chunk, about 4 KiB
+	constexpr static std::size_t chunk = sizeof(U) >= 4096 ? 1 : 4096 / sizeof(U);
+
+	std::vector<U*> chunks;
+
+	~pool() override { clear(); }
+
+	template<typename... Args>
+	U* emplace(Args&&... args)
+	{
+		std::size_t n = this->count;
+		if (n == chunks.size() * chunk)
+		{
+			U* c = Allocator<U>{}.allocate(chunk);
+			try
+			{
+				chunks.push_back(c);
+			}
+			catch (...)
+			{
+				Allocator<U>{}.deallocate(c, chunk);
+				throw;
+			}
+		}
+		U* p = new (chunks[n / chunk] + n % chunk) U(std::forward<Args>(args)...);
+		++this->count;
+		return p;
+	}
+
+	template<typename Fn>
+	void for_each(Fn& fn)
+	{
+		std::size_t left = this->count;
+		for (U* c : chunks)
+		{
+			std::size_t n = left < chunk ? left : chunk;
+			for (std::size_t i = 0; i < n; ++i)
+				fn(c[i]);
+			left -= n;
+		}
+	}
+
+	void visit(void (*cb)(void*, T&), void* ctx) override
+	{
+		auto fn = [cb, ctx](U& u) { cb(ctx, u); };
+		for_each(fn);
+	}
+
+	void clear() override
+	{
+		auto fn = [](U& u) { u.~U(); };
+		for_each(fn);
+		for (U* c : chunks)
+			Allocator<U>{}.deallocate(c, chunk);
+		chunks.clear();
+		this->count = 0;
+	}
+};
+
+template<typename T, template<typename...> class Allocator>
+template<typename U>
+auto segregated_container<T, Allocator>::find_pool() const -> pool<U>*
+{
+	std::size_t id = type_id<U>();
+	return id < pools.size() ? static_cast<pool<U>*>(pools[id].get()) : nullptr;
+}
+
+template<typename T, template<typename...> class Allocator>
+void segregated_container<T, Allocator>::clear()
+{
+	order.clear();
+	for (auto& p : pools)
+		if (p)
+			p->clear();
+}
+
+template<typename T, template<typename...> class Allocator>
+template<typename U>
+auto segregated_container<T, Allocator>::count() const -> size_type
+{
+	pool<U>* p = find_pool<U>();
+	return p ? p->count : 0;
+}
+
+template<typename T, template<typename...> class Allocator>
+template<typename U, typename... Args, typename>
+U& segregated_container<T, Allocator>::emplace_back(Args&&... args)
+{
+	pool<U>* p = find_pool<U>();
+	if (!p)
+	{
+		std::size_t id = type_id<U>();
+		if (id >= pools.size())
+			pools.resize(id + 1);
+		pools[id].reset(p = new pool<U>);
+	}
+	order.push_back({nullptr});
+	try
+	{
+		order.back().value = p->emplace(std::forward<Args>(args)...);
+	}
+	catch (...)
+	{
+		order.pop_back();
+		throw;
+	}
+	return *(U*)order.back().value;
+}
+
+template<typename T, template<typename...> class Allocator>
+template<typename U, typename Fn>
+void segregated_container<T, Allocator>::for_each(Fn&& fn)
+{
+	if (pool<U>* p = find_pool<U>())
+		p->for_each(fn);
+}
+
+template<typename T, template<typename...> class Allocator>
+template<typename... Us, typename Fn>
+void segregated_container<T, Allocator>::visit_all(Fn&& fn)
+{
+	(for_each<Us>(fn), ...);
+
+	std::size_t ids[] = {type_id<Us>()..., std::size_t(-1)};
+	void*       ctx   = (void*)std::addressof(fn);
+	auto        cb    = [](void* ctx, T& t) { (*(std::remove_reference_t<Fn>*)ctx)(t); };
+	for (std::size_t id = 0; id < pools.size(); ++id)
+	{
+		if (!pools[id] || std::find(std::begin(ids), std::end(ids), id) != std::end(ids))
+			continue;
+		pools[id]->visit(cb, ctx);
+	}
 }
 
 } // namespace ext
 
+#ifndef SUPRESS_MAIN
+
 #include <cstdlib>
 #include <iostream>
 #include <list>
@@ -699,3 +1679,5 @@ int main()
 
 	cout << "\ndone\n";
 }
+
+#endif
@@ -4,6 +4,7 @@
 // -------------------------------------------------------------------------------------------------------------
 
 #include <algorithm>
+#include <cassert>
 #include <cstddef>
 #include <functional>
 #include <initializer_list>
@@ -12,6 +13,10 @@
 #include <memory>
 #include <utility>
 
+#include "splice_list_algorithms.hpp"
+#include "splice_list_allocator.hpp"
+#include "splice_list_index.hpp"
+
 // -------------------------------------------------------------------------------------------------------------
 
 template<typename It>
@@ -19,17 +24,26 @@ using iterator_category_t = typename std::iterator_traits<It>::iterator_category
 
 // -------------------------------------------------------------------------------------------------------------
 
-template<typename T>
+/// <summary>
+/// nodes and the sentinel come from Allocator, rebound to the node types.
+/// nodes must only be spliced between lists with equal allocators
+/// (see pool_allocator in splice_list_allocator.hpp for a shareable node pool).
+/// Index picks a positional index kept over the nodes (see splice_list_index.hpp),
+/// the default has none and adds nothing to a node
+/// </summary>
+template<typename T, typename Allocator = std::allocator<T>, typename Index = splice_list_no_index>
 class splice_list
 {
 	union Sentry_or_Node {
 		struct Node;
-		typedef Node* NodeP;
-		struct Sentry
+		typedef Node*                                    NodeP;
+		typedef typename Index::template node_base<Node> Base;
+		// same base on both, so prev and next line up
+		struct Sentry : Base
 		{
 			NodeP prev, next;
 		};
-		struct Node
+		struct Node : Base
 		{
 			NodeP prev, next;
 			T     value;
@@ -43,6 +57,13 @@ class splice_list
 	typedef typename Sentry_or_Node::NodeP  NodeP;
 	typedef typename Sentry_or_Node::Sentry Sentry;
 
+	typedef typename std::allocator_traits<Allocator>::template rebind_alloc<Node>   NodeAlloc;
+	typedef typename std::allocator_traits<Allocator>::template rebind_alloc<Sentry> SentryAlloc;
+	typedef std::allocator_traits<NodeAlloc>                                         NodeTraits;
+	typedef std::allocator_traits<SentryAlloc>                                       SentryTraits;
+
+	typedef typename Index::template ops<Node> Ix;
+
 public:
 	typedef T              value_type;
 	typedef T&             reference;
@@ -51,23 +72,27 @@ public:
 	typedef const T*       const_pointer;
 	typedef std::size_t    size_type;
 	typedef std::ptrdiff_t difference_type;
+	typedef Allocator      allocator_type;
 	struct iterator;
 	struct const_iterator;
 
 	splice_list();
+	explicit splice_list(const Allocator&);
 	splice_list(const splice_list&);
 	splice_list(splice_list&&);
 	splice_list& operator=(const splice_list&);
 	splice_list& operator=(splice_list&&) noexcept;
 	~splice_list();
 
-	splice_list(std::initializer_list<T> il);
+	splice_list(std::initializer_list<T> il, const Allocator& a = Allocator{});
 	splice_list& operator=(std::initializer_list<T> il);
 
 	template<typename It, typename = iterator_category_t<It>>
-	splice_list(It b, It e);
+	splice_list(It b, It e, const Allocator& a = Allocator{});
 
-	splice_list(std::size_t n, const T& val);
+	splice_list(std::size_t n, const T& val, const Allocator& a = Allocator{});
+
+	allocator_type get_allocator() const { return allocator_type(alloc); }
 
 	template<typename It, typename = iterator_category_t<It>>
 	void assign(It b, It e);
@@ -210,23 +235,39 @@ public:
 	iterator erase(iterator);
 	iterator erase(iterator, iterator);
 
+	// O(log n) with an Index, a linear walk without
+	iterator       nth(std::size_t idx);
+	const_iterator nth(std::size_t idx) const;
+	std::size_t    index_of(const_iterator it) const;
+
 	void splice(iterator pos, splice_list& other);
 	void splice(iterator pos, splice_list&& other);
+
+	// pos, it, first and last all in this list
 	void splice(iterator pos, iterator it);
 	void splice(iterator pos, iterator first, iterator last);
 
-	void splice(iterator pos, splice_list&, iterator it) { splice(pos, it); }
-	void splice(iterator pos, splice_list&&, iterator it) { splice(pos, it); }
-	void splice(iterator pos, splice_list&, iterator first, iterator last) { splice(pos, first, last); }
-	void splice(iterator pos, splice_list&&, iterator first, iterator last) { splice(pos, first, last); }
+	void splice(iterator pos, splice_list& other, iterator it);
+	void splice(iterator pos, splice_list&& other, iterator it) { splice(pos, other, it); }
+
+	// between lists, counting [first,last) would be O(n), so both sizes go stale until next size().
+	// with an Index the count is taken from it and sizes stay exact
+	void splice(iterator pos, splice_list& other, iterator first, iterator last);
+	void splice(iterator pos, splice_list&& other, iterator first, iterator last) { splice(pos, other, first, last); }
+
+	// n must be std::distance(first,last), sizes stay exact
+	void splice(iterator pos, splice_list& other, iterator first, iterator last, std::size_t n);
+	void splice(iterator pos, splice_list&& other, iterator first, iterator last, std::size_t n)
+	{
+		splice(pos, other, first, last, n);
+	}
 
 	// default sort is stable
+	// bottom-up natural merge sort, O(n) on sorted, reversed or nearly sorted input
 	void sort() { sort(std::less<T>{}); }
 	template<typename Op>
 	void sort(Op op);
 
-	void experimental_merge_sort();
-
 	void merge(splice_list& other) { merge(other, std::less<T>{}); }
 	void merge(splice_list&& other) { merge(other); }
 	template<typename Op>
@@ -266,13 +307,7 @@ private:
 	template<typename Stream>
 	static Stream& helper_print(Stream&, Sentry&);
 
-	template<typename Op>
-	static void helper_merge(Sentry&, Sentry&, Sentry&, Op);
-
-	static void helper_split(Sentry&, Sentry&, Sentry&);
-
-	template<typename Op>
-	static void helper_sort(Sentry&, Op);
+	static T& value_of(NodeP p) { return p->value; }
 
 	template<typename It, typename = iterator_category_t<It>>
 	void helper_assign(It b, It e);
@@ -281,87 +316,114 @@ private:
 
 	template<typename... Args>
 	NodeP helper_makenode(Args&&...);
+	void  helper_freenode(NodeP);
+
+	NodeP helper_makesentinel();
+	void  helper_freesentinel();
 
-	NodeP       sentinel;
-	static void link(NodeP, NodeP);
+	void        helper_link_before(NodeP where, NodeP p);
+	void        helper_unlink(NodeP p);
+	std::size_t helper_splice(splice_list& src, NodeP pos, NodeP first, NodeP last);
+
+	NodeAlloc           alloc;
+	NodeP               sentinel;
+	mutable std::size_t count       = 0;
+	mutable bool        count_stale = false;
+	static void         link(NodeP, NodeP);
 };
 
 // -------------------------------------------------------------------------------------------------------------
 
-template<typename T>
-splice_list<T>::splice_list(std::initializer_list<T> il) : splice_list(il.begin(), il.end())
+template<typename T, typename Allocator, typename Index>
+splice_list<T, Allocator, Index>::splice_list(std::initializer_list<T> il, const Allocator& a)
+	: splice_list(il.begin(), il.end(), a)
 {
 }
 
-template<typename T>
-auto splice_list<T>::operator=(std::initializer_list<T> il) -> splice_list&
+template<typename T, typename Allocator, typename Index>
+auto splice_list<T, Allocator, Index>::operator=(std::initializer_list<T> il) -> splice_list&
 {
 	assign(il.begin(), il.end());
 	return *this;
 }
 
-template<typename T>
-void splice_list<T>::assign(std::initializer_list<T> il)
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::assign(std::initializer_list<T> il)
 {
 	assign(il.begin(), il.end());
 }
 
-template<typename T>
-splice_list<T>::splice_list()
+template<typename T, typename Allocator, typename Index>
+splice_list<T, Allocator, Index>::splice_list() : splice_list(Allocator{})
 {
-	sentinel = (NodeP) new Sentry;
-	link(sentinel, sentinel);
 }
 
-template<typename T>
-splice_list<T>::splice_list(const splice_list& other) : splice_list()
+template<typename T, typename Allocator, typename Index>
+splice_list<T, Allocator, Index>::splice_list(const Allocator& a) : alloc(a)
+{
+	sentinel = helper_makesentinel();
+}
+
+template<typename T, typename Allocator, typename Index>
+splice_list<T, Allocator, Index>::splice_list(const splice_list& other)
+	: splice_list(std::allocator_traits<Allocator>::select_on_container_copy_construction(other.get_allocator()))
 {
 	helper_assign(other.begin(), other.end());
 }
 
-template<typename T>
-splice_list<T>::splice_list(splice_list&& other) : splice_list()
+template<typename T, typename Allocator, typename Index>
+splice_list<T, Allocator, Index>::splice_list(splice_list&& other) : splice_list(other.get_allocator())
 {
 	swap(other);
 }
 
-template<typename T>
-auto splice_list<T>::operator=(const splice_list& other) -> splice_list&
+template<typename T, typename Allocator, typename Index>
+auto splice_list<T, Allocator, Index>::operator=(const splice_list& other) -> splice_list&
 {
+	if (this == &other)
+		return *this;
+	if (NodeTraits::propagate_on_container_copy_assignment::value && alloc != other.alloc)
+	{
+		// the sentinel belongs to the old allocator too
+		clear();
+		helper_freesentinel();
+		alloc    = other.alloc;
+		sentinel = helper_makesentinel();
+	}
 	assign(other);
 	return *this;
 }
 
-template<typename T>
-auto splice_list<T>::operator=(splice_list&& other) noexcept -> splice_list&
+template<typename T, typename Allocator, typename Index>
+auto splice_list<T, Allocator, Index>::operator=(splice_list&& other) noexcept -> splice_list&
 {
 	swap(other);
 	return *this;
 }
 
-template<typename T>
-splice_list<T>::~splice_list()
+template<typename T, typename Allocator, typename Index>
+splice_list<T, Allocator, Index>::~splice_list()
 {
 	clear();
-	delete (Sentry*)sentinel;
+	helper_freesentinel();
 }
 
-template<typename T>
+template<typename T, typename Allocator, typename Index>
 template<typename It, typename>
-splice_list<T>::splice_list(It b, It e) : splice_list()
+splice_list<T, Allocator, Index>::splice_list(It b, It e, const Allocator& a) : splice_list(a)
 {
 	helper_assign(b, e);
 }
 
-template<typename T>
-splice_list<T>::splice_list(std::size_t n, const T& val) : splice_list()
+template<typename T, typename Allocator, typename Index>
+splice_list<T, Allocator, Index>::splice_list(std::size_t n, const T& val, const Allocator& a) : splice_list(a)
 {
 	helper_assign(n, val);
 }
 
-template<typename T>
+template<typename T, typename Allocator, typename Index>
 template<typename It, typename>
-void splice_list<T>::helper_assign(It b, It e)
+void splice_list<T, Allocator, Index>::helper_assign(It b, It e)
 {
 	while (b != e)
 	{
@@ -370,309 +432,464 @@ void splice_list<T>::helper_assign(It b, It e)
 	}
 }
 
-template<typename T>
-void splice_list<T>::helper_assign(std::size_t n, const T& val)
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::helper_assign(std::size_t n, const T& val)
 {
 	while (n--)
 		push_back(val);
 }
 
-template<typename T>
+template<typename T, typename Allocator, typename Index>
 template<typename It, typename>
-void splice_list<T>::assign(It b, It e)
+void splice_list<T, Allocator, Index>::assign(It b, It e)
 {
 	clear();
 	helper_assign(b, e);
 }
 
-template<typename T>
-void splice_list<T>::assign(std::size_t n, const T& val)
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::assign(std::size_t n, const T& val)
 {
 	clear();
 	helper_assign(n, val);
 }
 
-template<typename T>
-void splice_list<T>::assign(const splice_list& other)
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::assign(const splice_list& other)
 {
 	assign(other.begin(), other.end());
 }
 
-template<typename T>
-void splice_list<T>::assign(splice_list&& other)
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::assign(splice_list&& other)
 {
 	swap(other);
 }
 
-template<typename T>
-void splice_list<T>::swap(splice_list& other) noexcept
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::swap(splice_list& other) noexcept
 {
 	using std::swap;
+	swap(alloc, other.alloc);
 	swap(sentinel, other.sentinel);
+	swap(count, other.count);
+	swap(count_stale, other.count_stale);
 }
 
-template<typename T>
-void splice_list<T>::swap(splice_list&& other) noexcept
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::swap(splice_list&& other) noexcept
 {
 	swap(other);
 }
 
-template<typename T>
-void splice_list<T>::clear()
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::clear()
 {
-	while (!empty())
-		pop_back();
+	NodeP p = sentinel->next;
+	while (p != sentinel)
+	{
+		NodeP n = p->next;
+		helper_freenode(p);
+		p = n;
+	}
+	link(sentinel, sentinel);
+	Ix::reset(sentinel);
+	count       = 0;
+	count_stale = false;
 }
 
 /// <summary>
-/// size is O(n) due to splice being O(1)
+/// size is O(1), except after an uncounted range splice
+/// between lists, where it is recounted once in O(n)
 /// </summary>
-template<typename T>
-std::size_t splice_list<T>::size() const noexcept
+template<typename T, typename Allocator, typename Index>
+std::size_t splice_list<T, Allocator, Index>::size() const noexcept
 {
-	NodeP       p  = sentinel->next;
-	std::size_t sz = 0;
-	while (p != sentinel)
+	if (count_stale)
 	{
-		p = p->next;
-		++sz;
+		NodeP       p  = sentinel->next;
+		std::size_t sz = 0;
+		while (p != sentinel)
+		{
+			p = p->next;
+			++sz;
+		}
+		count       = sz;
+		count_stale = false;
 	}
-	return sz;
+	return count;
 }
 
-template<typename T>
-bool splice_list<T>::empty() const noexcept
+template<typename T, typename Allocator, typename Index>
+bool splice_list<T, Allocator, Index>::empty() const noexcept
 {
 	return sentinel->next == sentinel;
 }
 
-template<typename T>
+template<typename T, typename Allocator, typename Index>
 template<typename... Args>
-auto splice_list<T>::helper_makenode(Args&&... args) -> NodeP
+auto splice_list<T, Allocator, Index>::helper_makenode(Args&&... args) -> NodeP
 {
-	NodeP p = new Node(std::forward<Args>(args)...);
+	NodeP p = NodeTraits::allocate(alloc, 1);
+	try
+	{
+		NodeTraits::construct(alloc, p, std::forward<Args>(args)...);
+	}
+	catch (...)
+	{
+		NodeTraits::deallocate(alloc, p, 1);
+		throw;
+	}
+	try
+	{
+		Ix::make_tower(p, alloc);
+	}
+	catch (...)
+	{
+		helper_freenode(p);
+		throw;
+	}
 	return p;
 }
 
-template<typename T>
-void splice_list<T>::push_back(const T& t)
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::helper_freenode(NodeP p)
+{
+	Ix::free_tower(p, alloc);
+	NodeTraits::destroy(alloc, p);
+	NodeTraits::deallocate(alloc, p, 1);
+}
+
+template<typename T, typename Allocator, typename Index>
+auto splice_list<T, Allocator, Index>::helper_makesentinel() -> NodeP
+{
+	SentryAlloc sa(alloc);
+	Sentry*     s = SentryTraits::allocate(sa, 1);
+	SentryTraits::construct(sa, s);
+	NodeP p = (NodeP)s;
+	try
+	{
+		Ix::init(p, alloc);
+	}
+	catch (...)
+	{
+		SentryTraits::destroy(sa, s);
+		SentryTraits::deallocate(sa, s, 1);
+		throw;
+	}
+	link(p, p);
+	return p;
+}
+
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::helper_freesentinel()
+{
+	SentryAlloc sa(alloc);
+	Sentry*     s = (Sentry*)sentinel;
+	Ix::release(sentinel, alloc);
+	SentryTraits::destroy(sa, s);
+	SentryTraits::deallocate(sa, s, 1);
+}
+
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::helper_link_before(NodeP where, NodeP p)
+{
+	link(where->prev, p);
+	link(p, where);
+	++count;
+	Ix::inserted(sentinel, p, count);
+}
+
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::helper_unlink(NodeP p)
+{
+	Ix::erased(sentinel, p, count);
+	link(p->prev, p->next);
+	--count;
+}
+
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::push_back(const T& t)
 {
 	NodeP p = helper_makenode(t);
-	link(sentinel->prev, p);
-	link(p, sentinel);
+	helper_link_before(sentinel, p);
 }
 
-template<typename T>
-void splice_list<T>::push_back(T&& t)
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::push_back(T&& t)
 {
 	NodeP p = helper_makenode(std::move(t));
-	link(sentinel->prev, p);
-	link(p, sentinel);
+	helper_link_before(sentinel, p);
 }
 
-template<typename T>
-void splice_list<T>::push_front(const T& t)
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::push_front(const T& t)
 {
 	NodeP p = helper_makenode(t);
-	link(p, sentinel->next);
-	link(sentinel, p);
+	helper_link_before(sentinel->next, p);
 }
 
-template<typename T>
-void splice_list<T>::push_front(T&& t)
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::push_front(T&& t)
 {
 	NodeP p = helper_makenode(std::move(t));
-	link(p, sentinel->next);
-	link(sentinel, p);
+	helper_link_before(sentinel->next, p);
 }
 
-template<typename T>
+template<typename T, typename Allocator, typename Index>
 template<typename... Args>
-void splice_list<T>::emplace_back(Args&&... args)
+void splice_list<T, Allocator, Index>::emplace_back(Args&&... args)
 {
 	NodeP p = helper_makenode(std::forward<Args>(args)...);
-	link(sentinel->prev, p);
-	link(p, sentinel);
+	helper_link_before(sentinel, p);
 }
 
-template<typename T>
+template<typename T, typename Allocator, typename Index>
 template<typename... Args>
-void splice_list<T>::emplace_front(Args&&... args)
+void splice_list<T, Allocator, Index>::emplace_front(Args&&... args)
 {
 	NodeP p = helper_makenode(std::forward<Args>(args)...);
-	link(p, sentinel->next);
-	link(sentinel, p);
+	helper_link_before(sentinel->next, p);
 }
 
-template<typename T>
-void splice_list<T>::pop_back()
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::pop_back()
 {
 	NodeP p = sentinel->prev;
-	link(p->prev, p->next);
-	delete p;
+	helper_unlink(p);
+	helper_freenode(p);
 }
 
-template<typename T>
-void splice_list<T>::pop_front()
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::pop_front()
 {
 	NodeP p = sentinel->next;
-	link(p->prev, p->next);
-	delete p;
+	helper_unlink(p);
+	helper_freenode(p);
 }
 
-template<typename T>
-auto splice_list<T>::insert(iterator where, const T& item) -> iterator
+template<typename T, typename Allocator, typename Index>
+auto splice_list<T, Allocator, Index>::insert(iterator where, const T& item) -> iterator
 {
 	NodeP p = helper_makenode(item);
-	link(where.node->prev, p);
-	link(p, where.node);
+	helper_link_before(where.node, p);
 	return {p};
 }
 
-template<typename T>
-auto splice_list<T>::insert(iterator where, T&& item) -> iterator
+template<typename T, typename Allocator, typename Index>
+auto splice_list<T, Allocator, Index>::insert(iterator where, T&& item) -> iterator
 {
 	NodeP p = helper_makenode(std::move(item));
-	link(where.node->prev, p);
-	link(p, where.node);
+	helper_link_before(where.node, p);
 	return {p};
 }
 
-template<typename T>
+template<typename T, typename Allocator, typename Index>
 template<typename... Args>
-auto splice_list<T>::emplace(iterator where, Args&&... args) -> iterator
+auto splice_list<T, Allocator, Index>::emplace(iterator where, Args&&... args) -> iterator
 {
 	NodeP p = helper_makenode(std::forward<Args>(args)...);
-	link(where.node->prev, p);
-	link(p, where.node);
+	helper_link_before(where.node, p);
 	return {p};
 }
 
-template<typename T>
-auto splice_list<T>::erase(iterator what) -> iterator
+template<typename T, typename Allocator, typename Index>
+auto splice_list<T, Allocator, Index>::erase(iterator what) -> iterator
 {
 	NodeP p = what.node;
 	NodeP n = p->next;
-	link(p->prev, p->next);
-	delete p;
+	helper_unlink(p);
+	helper_freenode(p);
 	return {n};
 }
 
-template<typename T>
-auto splice_list<T>::erase(iterator b, iterator e) -> iterator
+template<typename T, typename Allocator, typename Index>
+auto splice_list<T, Allocator, Index>::erase(iterator b, iterator e) -> iterator
 {
 	while (b != e)
 		b = erase(b);
 	return b;
 }
 
-template<typename T>
-void splice_list<T>::link(NodeP n1, NodeP n2)
+template<typename T, typename Allocator, typename Index>
+auto splice_list<T, Allocator, Index>::nth(std::size_t idx) -> iterator
+{
+	if constexpr (Index::indexed)
+	{
+		if (idx >= count)
+			return end();
+		return {Ix::nth(sentinel, idx)};
+	}
+	else
+	{
+		NodeP p = sentinel->next;
+		while (idx-- && p != sentinel)
+			p = p->next;
+		return {p};
+	}
+}
+
+template<typename T, typename Allocator, typename Index>
+auto splice_list<T, Allocator, Index>::nth(std::size_t idx) const -> const_iterator
+{
+	return const_cast<splice_list*>(this)->nth(idx);
+}
+
+template<typename T, typename Allocator, typename Index>
+std::size_t splice_list<T, Allocator, Index>::index_of(const_iterator it) const
+{
+	if constexpr (Index::indexed)
+	{
+		return Ix::rank(sentinel, it.node, count);
+	}
+	else
+	{
+		std::size_t idx = 0;
+		for (NodeP p = sentinel->next; p != it.node; p = p->next)
+			++idx;
+		return idx;
+	}
+}
+
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::link(NodeP n1, NodeP n2)
 {
 	n1->next = n2;
 	n2->prev = n1;
 }
 
-template<typename T>
-void splice_list<T>::splice(iterator pos, splice_list& other)
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::splice(iterator pos, splice_list& other)
 {
+	assert(alloc == other.alloc);
 	if (other.empty())
 		return;
+	Ix::moved(other.sentinel, 0, other.count, sentinel, Ix::rank(sentinel, pos.node, count));
 	link(pos.node->prev, other.sentinel->next);
 	link(other.sentinel->prev, pos.node);
 	link(other.sentinel, other.sentinel);
+	count += other.count;
+	count_stale       = count_stale || other.count_stale;
+	other.count       = 0;
+	other.count_stale = false;
 }
 
-template<typename T>
-void splice_list<T>::splice(iterator pos, splice_list&& other)
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::splice(iterator pos, splice_list&& other)
 {
 	splice(pos, other);
 }
 
-template<typename T>
-void splice_list<T>::splice(iterator pos, iterator it)
+/// <summary>
+/// relink [first,last) of src before pos. with an Index the ranks are taken before the
+/// relinking, and the length of the range comes out of them for free (0 without)
+/// </summary>
+template<typename T, typename Allocator, typename Index>
+std::size_t splice_list<T, Allocator, Index>::helper_splice(splice_list& src, NodeP pos, NodeP first, NodeP last)
 {
-	link(it.node->prev, it.node->next);
-	link(pos.node->prev, it.node);
-	link(it.node, pos.node);
+	assert(alloc == src.alloc);
+	if (first == last || pos == first || pos == last)
+		return 0;
+	std::size_t n = 0;
+	if constexpr (Index::indexed)
+	{
+		std::size_t rf = Ix::rank(src.sentinel, first, src.count);
+		std::size_t rl = Ix::rank(src.sentinel, last, src.count);
+		std::size_t rp = Ix::rank(sentinel, pos, count);
+		// pos inside the range is not allowed, it is a no-op for the index at least
+		if (&src != this || rp < rf || rp > rl)
+			Ix::moved(src.sentinel, rf, rl, sentinel, rp);
+		n = rl - rf;
+	}
+	NodeP l = last->prev;
+	link(first->prev, last);
+	link(pos->prev, first);
+	link(l, pos);
+	return n;
 }
 
-template<typename T>
-void splice_list<T>::splice(iterator pos, iterator first, iterator last)
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::splice(iterator pos, iterator it)
 {
-	if (first == last)
-		return;
-	NodeP f = first.node;
-	NodeP l = last.node->prev;
-	link(f->prev, l->next);
-	link(pos.node->prev, f);
-	link(l, pos.node);
+	helper_splice(*this, pos.node, it.node, it.node->next);
 }
 
-template<typename T>
-template<typename Op>
-void splice_list<T>::sort(Op op)
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::splice(iterator pos, iterator first, iterator last)
 {
-	helper_sort(*(Sentry*)sentinel, op);
+	helper_splice(*this, pos.node, first.node, last.node);
 }
 
-template<typename T>
-void splice_list<T>::experimental_merge_sort()
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::splice(iterator pos, splice_list& other, iterator it)
 {
-	NodeP leaveof = (Sentry*)sentinel;
+	helper_splice(other, pos.node, it.node, it.node->next);
+	if (&other != this)
+	{
+		++count;
+		--other.count;
+	}
+}
 
-	int sz = size();
-	if (sz <= 1)
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::splice(iterator pos, splice_list& other, iterator first, iterator last)
+{
+	if (first == last)
 		return;
-
-	struct sub_merge_t
+	std::size_t n = helper_splice(other, pos.node, first.node, last.node);
+	if (&other == this)
+		return;
+	if constexpr (Index::indexed)
 	{
-		NodeP& leaveof;
-		void   operator()(NodeP, NodeP, NodeP, NodeP, NodeP&, NodeP&) {}
-	} sub_merge(leaveof);
+		count += n;
+		other.count -= n;
+	}
+	else
+	{
+		count_stale = other.count_stale = true;
+	}
+}
 
-	struct sub_sort_t
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::splice(iterator pos, splice_list& other, iterator first, iterator last, std::size_t n)
+{
+	helper_splice(other, pos.node, first.node, last.node);
+	if (&other != this)
 	{
-		NodeP& leaveof;
-		void   operator()(int n, NodeP& b, NodeP& e)
-		{
-			if (n <= 2)
-			{
-				// later
-			}
-			else
-			{
-				NodeP ab, ae, bb, be;
-				(*this)(sz / n, ab, ae);
-				(*this)(sz - sz / n, ab, ae);
-				sub_merge(ab, ae, bb, be, b, e);
-			}
-		}
-	} sub_sort(leaveof);
+		count += n;
+		other.count -= n;
+	}
+}
 
-	NodeP ab, ae, bb, be, cb, ce;
-	sub_sort(sz / 2, ab, ae);
-	sub_sort(sz - sz / 2, ab, ae);
-	sub_merge(ab, ae, bb, be, cb, ce);
-	link(sentinel->next, cb);
-	link(sentinel->prev, ce);
+template<typename T, typename Allocator, typename Index>
+template<typename Op>
+void splice_list<T, Allocator, Index>::sort(Op op)
+{
+	splice_algo::sort(sentinel, value_of, op);
+	Ix::rebuild(sentinel);
 }
 
-template<typename T>
+template<typename T, typename Allocator, typename Index>
 template<typename Op>
-void splice_list<T>::merge(splice_list& other, Op op)
+void splice_list<T, Allocator, Index>::merge(splice_list& other, Op op)
 {
+	assert(alloc == other.alloc);
 	if (other.empty())
 		return;
 	if (empty())
 		return swap(other);
-	helper_merge(*(Sentry*)sentinel, *(Sentry*)sentinel, *(Sentry*)other.sentinel, op);
-	link(other.sentinel, other.sentinel);
+	splice_algo::merge(sentinel, other.sentinel, value_of, op);
+	Ix::rebuild(sentinel);
+	Ix::reset(other.sentinel);
+	count += other.count;
+	count_stale       = count_stale || other.count_stale;
+	other.count       = 0;
+	other.count_stale = false;
 }
 
-template<typename T>
+template<typename T, typename Allocator, typename Index>
 template<typename Stream>
-auto splice_list<T>::helper_print(Stream& out, Sentry& s) -> Stream&
+auto splice_list<T, Allocator, Index>::helper_print(Stream& out, Sentry& s) -> Stream&
 {
 	out << "[";
 	NodeP p     = s.next;
@@ -689,111 +906,9 @@ auto splice_list<T>::helper_print(Stream& out, Sentry& s) -> Stream&
 	return out;
 }
 
-template<typename T>
-template<typename Op>
-void splice_list<T>::helper_merge(Sentry& dst, Sentry& s1, Sentry& s2, Op op)
-{
-	NodeP f1 = s1.next;
-	NodeP l1 = s1.prev;
-	NodeP f2 = s2.next;
-	NodeP l2 = s2.prev;
-	NodeP dp = (NodeP)&dst;
-
-	while (true)
-	{
-		if (f1 == (NodeP)&s1)
-		{
-			link(dp, f2);
-			link(l2, (NodeP)&dst);
-			break;
-		}
-		if (f2 == (NodeP)&s2)
-		{
-			link(dp, f1);
-			link(l1, (NodeP)&dst);
-			break;
-		}
-		if (op(f1->value, f2->value))
-		{
-			link(dp, f1);
-			f1 = f1->next;
-		}
-		else
-		{
-			link(dp, f2);
-			f2 = f2->next;
-		}
-		dp = dp->next;
-	}
-}
-
-template<typename T>
-void splice_list<T>::helper_split(Sentry& src, Sentry& d1, Sentry& d2)
-{
-
-	if (src.next == (NodeP)&src)
-	{
-		d1.next = d1.prev = (NodeP)&d1;
-		d2.next = d2.prev = (NodeP)&d2;
-		return;
-	}
-	if (src.next->next == (NodeP)&src)
-	{
-		link((NodeP)&d1, src.next);
-		link(src.next, (NodeP)&d1);
-		d2.next = d2.prev = (NodeP)&d2;
-		return;
-	}
-	if (src.next->next->next == (NodeP)&src)
-	{
-		link((NodeP)&d1, src.next);
-		link(src.next, (NodeP)&d1);
-		link((NodeP)&d2, src.prev);
-		link(src.prev, (NodeP)&d2);
-		return;
-	}
-
-	NodeP f = src.next;
-	NodeP l = src.prev;
-
-	while (true)
-	{
-		if (f == l)
-			break;
-		l = l->prev;
-		if (f == l)
-			break;
-		f = f->next;
-	}
-	NodeP m  = f;
-	NodeP m2 = f->next;
-	f        = src.next;
-	l        = src.prev;
-	link((NodeP)&d1, f);
-	link(m, (NodeP)&d1);
-	link((NodeP)&d2, m2);
-	link(l, (NodeP)&d2);
-}
-
-template<typename T>
-template<typename Op>
-void splice_list<T>::helper_sort(Sentry& src, Op op)
-{
-	if (src.next == (NodeP)&src)
-		return;
-	if (src.next->next == (NodeP)&src)
-		return;
-
-	Sentry lft, rgt;
-	helper_split(src, lft, rgt);
-	helper_sort(lft, op);
-	helper_sort(rgt, op);
-	helper_merge(src, lft, rgt, op);
-}
-
-template<typename T>
+template<typename T, typename Allocator, typename Index>
 template<class Eq>
-void splice_list<T>::unique(Eq eq)
+void splice_list<T, Allocator, Index>::unique(Eq eq)
 {
 	iterator i = begin();
 	if (i == end())
@@ -816,35 +931,24 @@ void splice_list<T>::unique(Eq eq)
 	}
 }
 
-template<typename T>
-void splice_list<T>::reverse()
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::reverse()
 {
-	if (empty())
-		return;
-	NodeP p1 = sentinel;
-	NodeP p2 = p1->next;
-	while (true)
-	{
-		NodeP p3 = p2->next;
-		link(p2, p1);
-		if (p2 == sentinel)
-			break;
-		p1 = p2;
-		p2 = p3;
-	}
+	splice_algo::reverse(sentinel);
+	Ix::rebuild(sentinel);
 }
 
-template<typename T>
-void splice_list<T>::remove(const T& val)
+template<typename T, typename Allocator, typename Index>
+void splice_list<T, Allocator, Index>::remove(const T& val)
 {
 	// using namespace std::placeholders;
 	// remove_if( std::bind( std::equal_to<T>(), _1, val ) );
 	remove_if([&val](const T& v) -> bool { return v == val; });
 }
 
-template<typename T>
+template<typename T, typename Allocator, typename Index>
 template<typename Pred>
-Pred splice_list<T>::remove_if(Pred pred)
+Pred splice_list<T, Allocator, Index>::remove_if(Pred pred)
 {
 	auto i = begin();
 	while (i != end())
@@ -857,8 +961,8 @@ Pred splice_list<T>::remove_if(Pred pred)
 	return pred;
 }
 
-template<typename T>
-int splice_list<T>::compare(const splice_list& other) const
+template<typename T, typename Allocator, typename Index>
+int splice_list<T, Allocator, Index>::compare(const splice_list& other) const
 {
 	auto me_iter = begin();
 	auto ot_iter = other.begin();
@@ -881,38 +985,52 @@ int splice_list<T>::compare(const splice_list& other) const
 	}
 }
 
-template<typename T>
-bool splice_list<T>::operator==(const splice_list& other) const
+template<typename T, typename Allocator, typename Index>
+bool splice_list<T, Allocator, Index>::operator==(const splice_list& other) const
 {
 	return compare(other) == 0;
 }
 
-template<typename T>
-bool splice_list<T>::operator!=(const splice_list& other) const
+template<typename T, typename Allocator, typename Index>
+bool splice_list<T, Allocator, Index>::operator!=(const splice_list& other) const
 {
 	return compare(other) != 0;
 }
 
-template<typename T>
-bool splice_list<T>::operator<(const splice_list& other) const
+template<typename T, typename Allocator, typename Index>
+bool splice_list<T, Allocator, Index>::operator<(const splice_list& other) const
 {
 	return compare(other) < 0;
 }
 
-template<typename T>
-bool splice_list<T>::operator<=(const splice_list& other) const
+template<typename T, typename Allocator, typename Index>
+bool splice_list<T, Allocator, Index>::operator<=(const splice_list& other) const
 {
 	return compare(other) <= 0;
 }
 
-template<typename T>
-bool splice_list<T>::operator>(const splice_list& other) const
+template<typename T, typename Allocator, typename Index>
+bool splice_list<T, Allocator, Index>::operator>(const splice_list& other) const
 {
 	return compare(other) > 0;
 }
 
-template<typename T>
-bool splice_list<T>::operator>=(const splice_list& other) const
+template<typename T, typename Allocator, typename Index>
+bool splice_list<T, Allocator, Index>::operator>=(const splice_list& other) const
 {
 	return compare(other) >= 0;
 }
+
+// -------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// splice_list recycling its erased nodes. lists built from copies of one allocator share a pool
+/// </summary>
+template<typename T>
+using pooled_splice_list = splice_list<T, pool_allocator<T>>;
+
+/// <summary>
+/// splice_list with a skip list index, nth() and index_of() in O(log n)
+/// </summary>
+template<typename T>
+using indexed_splice_list = splice_list<T, std::allocator<T>, splice_list_skip_index<>>;
@@ -0,0 +1,272 @@
+
+#pragma once
+
+// -------------------------------------------------------------------------------------------------------------
+
+#include <cstddef>
+#include <limits>
+#include <utility>
+
+// -------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// the linking algorithms of splice_list, over any circular doubly linked ring of L
+/// (a struct with L* prev, next) closed by a sentinel. val maps an L* to the value
+/// it holds, so the same code runs on splice_list nodes and on intrusive hooks
+/// </summary>
+namespace splice_algo
+{
+
+template<typename L>
+void link(L* n1, L* n2)
+{
+	n1->next = n2;
+	n2->prev = n1;
+}
+
+/// <summary>
+/// detach the longest run starting at p, a non descending one or a strictly descending
+/// one (reversed in place, strictness keeps the sort stable), and advance p past it.
+/// short runs are extended to min_run nodes by (stable) insertion, as in timsort.
+/// runs are singly linked (next only) and nullptr terminated
+/// </summary>
+template<typename L, typename Val, typename Op>
+L* take_run(L*& p, std::size_t& len, Val& val, Op& op)
+{
+	constexpr std::size_t min_run = 16;
+
+	L* first = p;
+	L* last  = p;
+	L* next  = p->next;
+	len      = 1;
+	if (next && op(val(next), val(last)))
+	{
+		while (next && op(val(next), val(last)))
+		{
+			last = next;
+			next = next->next;
+			++len;
+		}
+		L* rev = nullptr;
+		for (L* q = first; q != next;)
+		{
+			L* tmp  = q->next;
+			q->next = rev;
+			rev     = q;
+			q       = tmp;
+		}
+		std::swap(first, last);
+		first = rev;
+	}
+	else
+	{
+		while (next && !op(val(next), val(last)))
+		{
+			last = next;
+			next = next->next;
+			++len;
+		}
+	}
+	last->next = nullptr;
+
+	while (next && len < min_run)
+	{
+		L* q = next;
+		next = next->next;
+		if (!op(val(q), val(last)))
+		{
+			last->next = q;
+			last       = q;
+		}
+		else if (op(val(q), val(first)))
+		{
+			q->next = first;
+			first   = q;
+		}
+		else
+		{
+			L* pos = first;
+			while (!op(val(q), val(pos->next)))
+				pos = pos->next;
+			q->next   = pos->next;
+			pos->next = q;
+		}
+		++len;
+	}
+	last->next = nullptr;
+	p          = next;
+	return first;
+}
+
+/// <summary>
+/// stable merge of two runs, ties are taken from the first one
+/// </summary>
+template<typename L, typename Val, typename Op>
+L* merge_runs(L* a, L* b, Val& val, Op& op)
+{
+	L* head;
+	if (op(val(b), val(a)))
+	{
+		head = b;
+		b    = b->next;
+	}
+	else
+	{
+		head = a;
+		a    = a->next;
+	}
+	L* dp = head;
+	while (a && b)
+	{
+		if (op(val(b), val(a)))
+		{
+			dp->next = b;
+			b        = b->next;
+		}
+		else
+		{
+			dp->next = a;
+			a        = a->next;
+		}
+		dp = dp->next;
+	}
+	dp->next = a ? a : b;
+	return head;
+}
+
+/// <summary>
+/// timsort stack rules, only neighbouring runs are merged so it stays stable.
+/// with force, merge everything down to a single run
+/// </summary>
+template<typename L, typename Val, typename Op>
+void collapse_runs(L** runs, std::size_t* lens, int& n, bool force, Val& val, Op& op)
+{
+	while (n > 1)
+	{
+		int k = n - 2;
+		if ((k > 0 && lens[k - 1] <= lens[k] + lens[k + 1]) || (k > 1 && lens[k - 2] <= lens[k - 1] + lens[k]))
+		{
+			if (lens[k - 1] < lens[k + 1])
+				--k;
+		}
+		else if (force)
+		{
+			if (k > 0 && lens[k - 1] < lens[k + 1])
+				--k;
+		}
+		else if (lens[k] > lens[k + 1])
+		{
+			break;
+		}
+		runs[k] = merge_runs(runs[k], runs[k + 1], val, op);
+		lens[k] += lens[k + 1];
+		if (k + 2 < n)
+		{
+			runs[k + 1] = runs[k + 2];
+			lens[k + 1] = lens[k + 2];
+		}
+		--n;
+	}
+}
+
+/// <summary>
+/// bottom-up natural merge sort of the ring, stable, O(n) on sorted, reversed or nearly
+/// sorted input. no split walks and no recursion, the prev links are rebuilt at the end
+/// </summary>
+template<typename L, typename Val, typename Op>
+void sort(L* sentinel, Val val, Op op)
+{
+	if (sentinel->next == sentinel || sentinel->next->next == sentinel)
+		return;
+
+	// run lengths grow at least like fibonacci numbers, so this is plenty
+	constexpr int max_runs = 2 * std::numeric_limits<std::size_t>::digits;
+	L*            runs[max_runs];
+	std::size_t   lens[max_runs];
+	int           n = 0;
+
+	L* p                 = sentinel->next;
+	sentinel->prev->next = nullptr;
+	while (p)
+	{
+		runs[n] = take_run(p, lens[n], val, op);
+		++n;
+		collapse_runs(runs, lens, n, false, val, op);
+	}
+	collapse_runs(runs, lens, n, true, val, op);
+
+	L* prev = sentinel;
+	for (p = runs[0]; p; p = p->next)
+	{
+		p->prev = prev;
+		prev    = p;
+	}
+	sentinel->next = runs[0];
+	link(prev, sentinel);
+}
+
+/// <summary>
+/// stable merge of the (sorted) ring of s2 into the one of s1, s2 is left empty
+/// </summary>
+template<typename L, typename Val, typename Op>
+void merge(L* s1, L* s2, Val val, Op op)
+{
+	L* f1 = s1->next;
+	L* l1 = s1->prev;
+	L* f2 = s2->next;
+	L* l2 = s2->prev;
+	L* dp = s1;
+
+	link(s2, s2);
+	while (true)
+	{
+		if (f1 == s1)
+		{
+			if (f2 != s2)
+			{
+				link(dp, f2);
+				link(l2, s1);
+			}
+			else
+				link(dp, s1);
+			break;
+		}
+		if (f2 == s2)
+		{
+			link(dp, f1);
+			link(l1, s1);
+			break;
+		}
+		if (op(val(f2), val(f1)))
+		{
+			link(dp, f2);
+			f2 = f2->next;
+		}
+		else
+		{
+			link(dp, f1);
+			f1 = f1->next;
+		}
+		dp = dp->next;
+	}
+}
+
+template<typename L>
+void reverse(L* sentinel)
+{
+	if (sentinel->next == sentinel)
+		return;
+	L* p1 = sentinel;
+	L* p2 = p1->next;
+	while (true)
+	{
+		L* p3 = p2->next;
+		link(p2, p1);
+		if (p2 == sentinel)
+			break;
+		p1 = p2;
+		p2 = p3;
+	}
+}
+
+} // namespace splice_algo
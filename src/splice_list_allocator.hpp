@@ -0,0 +1,207 @@
+
+#pragma once
+
+// -------------------------------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// -------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// free lists of small fixed size blocks, one per size class, carved from chunks
+/// that are only given back when the pool dies. freed blocks are recycled, so
+/// steady erase / insert churn does not touch the global heap.
+/// not thread safe. big or over aligned requests go straight to (aligned) operator new
+/// </summary>
+class node_pool
+{
+public:
+	node_pool() = default;
+	node_pool(const node_pool&) = delete;
+	node_pool& operator=(const node_pool&) = delete;
+	~node_pool();
+
+	void* allocate(std::size_t sz, std::size_t al);
+	void  deallocate(void* p, std::size_t sz, std::size_t al) noexcept;
+
+	// blocks carved from chunks, and how many of those are currently free
+	std::size_t capacity() const noexcept { return carved; }
+	std::size_t available() const noexcept { return carved - used; }
+
+private:
+	constexpr static std::size_t granule     = alignof(std::max_align_t);
+	constexpr static std::size_t classes     = 16;
+	constexpr static std::size_t first_chunk = 16;
+	constexpr static std::size_t max_chunk   = 4096;
+
+	struct Free
+	{
+		Free* next;
+	};
+
+	static std::size_t size_class(std::size_t sz, std::size_t al) noexcept;
+
+	void grow(std::size_t cls);
+
+	Free*              free_list[classes]    = {};
+	std::size_t        chunk_blocks[classes] = {};
+	std::size_t        carved                = 0;
+	std::size_t        used                  = 0;
+	std::vector<void*> chunks;
+};
+
+// -------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// the pool of the default constructed allocators of this thread. a list handed to
+/// another thread should bring a pool of its own, the pool is not thread safe
+/// </summary>
+inline const std::shared_ptr<node_pool>& default_node_pool()
+{
+	thread_local std::shared_ptr<node_pool> pool = std::make_shared<node_pool>();
+	return pool;
+}
+
+// -------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// allocator drawing from a node_pool. copies (and rebinds) share the pool, so every
+/// container built from the same allocator recycles the same nodes, and nodes spliced
+/// between them stay in that pool. default constructed allocators share default_node_pool(),
+/// so they compare equal and their lists can splice too
+/// </summary>
+template<typename T>
+class pool_allocator
+{
+public:
+	typedef T value_type;
+
+	typedef std::true_type propagate_on_container_copy_assignment;
+	typedef std::true_type propagate_on_container_move_assignment;
+	typedef std::true_type propagate_on_container_swap;
+
+	pool_allocator() : pool(default_node_pool()) {}
+	explicit pool_allocator(std::shared_ptr<node_pool> p) : pool(std::move(p)) {}
+	pool_allocator(const pool_allocator&) = default;
+	template<typename U>
+	pool_allocator(const pool_allocator<U>& other) noexcept : pool(other.pool)
+	{
+	}
+
+	T*   allocate(std::size_t n);
+	void deallocate(T* p, std::size_t n) noexcept;
+
+	const std::shared_ptr<node_pool>& get_pool() const noexcept { return pool; }
+
+	template<typename U>
+	bool operator==(const pool_allocator<U>& other) const noexcept
+	{
+		return pool == other.pool;
+	}
+	template<typename U>
+	bool operator!=(const pool_allocator<U>& other) const noexcept
+	{
+		return pool != other.pool;
+	}
+
+private:
+	template<typename U>
+	friend class pool_allocator;
+
+	std::shared_ptr<node_pool> pool;
+};
+
+// -------------------------------------------------------------------------------------------------------------
+
+inline node_pool::~node_pool()
+{
+	for (void* c : chunks)
+		::operator delete(c);
+}
+
+/// <summary>
+/// 1-based size class, 0 when the request is not served from the free lists
+/// </summary>
+inline std::size_t node_pool::size_class(std::size_t sz, std::size_t al) noexcept
+{
+	if (al > granule || sz == 0)
+		return 0;
+	std::size_t cls = (sz + granule - 1) / granule;
+	return (cls <= classes) ? cls : 0;
+}
+
+/// <summary>
+/// carve a new chunk for a size class, each one twice the size of the last
+/// </summary>
+inline void node_pool::grow(std::size_t cls)
+{
+	std::size_t& n = chunk_blocks[cls - 1];
+	n              = n ? std::min(n * 2, max_chunk) : first_chunk;
+
+	std::size_t bs = cls * granule;
+	chunks.reserve(chunks.size() + 1);
+	char* c = (char*)::operator new(n * bs);
+	chunks.push_back(c);
+
+	Free*& head = free_list[cls - 1];
+	for (std::size_t i = n; i--;)
+	{
+		Free* f = (Free*)(c + i * bs);
+		f->next = head;
+		head    = f;
+	}
+	carved += n;
+}
+
+inline void* node_pool::allocate(std::size_t sz, std::size_t al)
+{
+	std::size_t cls = size_class(sz, al);
+	if (!cls)
+	{
+		if (al > granule)
+			return ::operator new(sz, std::align_val_t(al));
+		return ::operator new(sz);
+	}
+	if (!free_list[cls - 1])
+		grow(cls);
+	Free* f            = free_list[cls - 1];
+	free_list[cls - 1] = f->next;
+	++used;
+	return f;
+}
+
+inline void node_pool::deallocate(void* p, std::size_t sz, std::size_t al) noexcept
+{
+	std::size_t cls = size_class(sz, al);
+	if (!cls)
+	{
+		if (al > granule)
+			return ::operator delete(p, std::align_val_t(al));
+		return ::operator delete(p);
+	}
+	Free* f            = (Free*)p;
+	f->next            = free_list[cls - 1];
+	free_list[cls - 1] = f;
+	--used;
+}
+
+// -------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+T* pool_allocator<T>::allocate(std::size_t n)
+{
+	if (n > std::size_t(-1) / sizeof(T))
+		throw std::bad_alloc{};
+	return (T*)pool->allocate(n * sizeof(T), alignof(T));
+}
+
+template<typename T>
+void pool_allocator<T>::deallocate(T* p, std::size_t n) noexcept
+{
+	pool->deallocate(p, n * sizeof(T), alignof(T));
+}
@@ -0,0 +1,399 @@
+
+#pragma once
+
+// -------------------------------------------------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// -------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// index policies for splice_list. a policy gives the node a base (node_base) and the list
+/// a set of static hooks (ops) that are called as nodes are linked, unlinked and moved.
+/// splice_list_no_index is empty on both counts, so the plain list pays nothing
+/// </summary>
+struct splice_list_no_index
+{
+	constexpr static bool indexed = false;
+
+	template<typename Node>
+	struct node_base
+	{
+	};
+
+	template<typename Node>
+	struct ops
+	{
+		typedef Node* NodeP;
+
+		template<typename A>
+		static void init(NodeP, A&)
+		{
+		}
+		template<typename A>
+		static void release(NodeP, A&)
+		{
+		}
+		template<typename A>
+		static void make_tower(NodeP, A&)
+		{
+		}
+		template<typename A>
+		static void free_tower(NodeP, A&)
+		{
+		}
+
+		static void reset(NodeP) {}
+		static void rebuild(NodeP) {}
+
+		static std::size_t rank(NodeP, NodeP, std::size_t) { return 0; }
+
+		static void inserted(NodeP, NodeP, std::size_t) {}
+		static void erased(NodeP, NodeP, std::size_t) {}
+		static void moved(NodeP, std::size_t, std::size_t, NodeP, std::size_t) {}
+	};
+};
+
+// -------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// skip list with span counts over the nodes of a splice_list, for O(log n) nth() and
+/// index_of(). about one node in four carries a tower of forward links (p = 1/4), each
+/// link knowing how many nodes it jumps. the height of a node is a hash of its address,
+/// so it is deterministic and needs no generator state. the sentinel holds the head
+/// tower, Levels high. insert and erase are O(log n), a range splice moves whole tower
+/// segments in O(log n) (only the links crossing the cut points change), and sort,
+/// merge and reverse relink the towers in one O(n) pass
+/// </summary>
+template<std::size_t Levels = 16>
+struct splice_list_skip_index
+{
+	static_assert(Levels >= 2 && Levels < 32, "Levels out of range");
+
+	constexpr static bool indexed = true;
+
+	template<typename Node>
+	struct node_base
+	{
+		struct Link
+		{
+			Node*       next;
+			std::size_t span;
+		};
+		// links[0].span is the height h, links[1..h] the levels. nullptr for height 0
+		Link* links = nullptr;
+	};
+
+	template<typename Node>
+	struct ops
+	{
+		typedef Node*                          NodeP;
+		typedef typename node_base<Node>::Link Link;
+
+		template<typename A>
+		static void init(NodeP s, A& a);
+		template<typename A>
+		static void release(NodeP s, A& a)
+		{
+			free_tower(s, a);
+		}
+		template<typename A>
+		static void make_tower(NodeP p, A& a);
+		template<typename A>
+		static void free_tower(NodeP p, A& a);
+
+		// empty list, all head levels end at the sentinel
+		static void reset(NodeP s);
+		// relink all towers in list order, O(n)
+		static void rebuild(NodeP s);
+
+		// 0-based index of p in a list of n, n for the sentinel
+		static std::size_t rank(NodeP s, NodeP p, std::size_t n);
+		static NodeP       nth(NodeP s, std::size_t i);
+
+		// p was just linked into a list of (now) n
+		static void inserted(NodeP s, NodeP p, std::size_t n);
+		// p, in a list of n, is about to be unlinked
+		static void erased(NodeP s, NodeP p, std::size_t n);
+		// [rf,rl) of src moves before index rp of dst (ranks from before the move)
+		static void moved(NodeP src, std::size_t rf, std::size_t rl, NodeP dst, std::size_t rp);
+
+	private:
+		static std::size_t height(NodeP p) { return p->links ? p->links[0].span : 0; }
+		static Link&       lvl(NodeP p, std::size_t l) { return p->links[l + 1]; }
+		static std::size_t height_for(NodeP p);
+
+		// per level, the last node at 1-based position <= r, and that position
+		static void find(NodeP s, std::size_t r, NodeP* upd, std::size_t* pos);
+
+		template<typename A>
+		using LinkAlloc = typename std::allocator_traits<A>::template rebind_alloc<Link>;
+	};
+};
+
+// -------------------------------------------------------------------------------------------------------------
+
+template<std::size_t Levels>
+template<typename Node>
+template<typename A>
+void splice_list_skip_index<Levels>::ops<Node>::init(NodeP s, A& a)
+{
+	LinkAlloc<A> la(a);
+	s->links         = std::allocator_traits<LinkAlloc<A>>::allocate(la, Levels + 1);
+	s->links[0].span = Levels;
+	reset(s);
+}
+
+/// <summary>
+/// splitmix64 of the address, then two bits per level
+/// </summary>
+template<std::size_t Levels>
+template<typename Node>
+std::size_t splice_list_skip_index<Levels>::ops<Node>::height_for(NodeP p)
+{
+	std::uint64_t z = (std::uint64_t)(std::uintptr_t)p + 0x9E3779B97F4A7C15ull;
+	z               = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z               = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	z               = z ^ (z >> 31);
+
+	std::size_t h = 0;
+	while (h < Levels - 1 && (z & 3) == 0)
+	{
+		++h;
+		z >>= 2;
+	}
+	return h;
+}
+
+template<std::size_t Levels>
+template<typename Node>
+template<typename A>
+void splice_list_skip_index<Levels>::ops<Node>::make_tower(NodeP p, A& a)
+{
+	std::size_t h = height_for(p);
+	if (!h)
+		return;
+	LinkAlloc<A> la(a);
+	p->links         = std::allocator_traits<LinkAlloc<A>>::allocate(la, h + 1);
+	p->links[0].span = h;
+}
+
+template<std::size_t Levels>
+template<typename Node>
+template<typename A>
+void splice_list_skip_index<Levels>::ops<Node>::free_tower(NodeP p, A& a)
+{
+	if (!p->links)
+		return;
+	LinkAlloc<A> la(a);
+	std::allocator_traits<LinkAlloc<A>>::deallocate(la, p->links, p->links[0].span + 1);
+	p->links = nullptr;
+}
+
+template<std::size_t Levels>
+template<typename Node>
+void splice_list_skip_index<Levels>::ops<Node>::reset(NodeP s)
+{
+	for (std::size_t l = 0; l < Levels; ++l)
+		lvl(s, l) = {s, 1};
+}
+
+template<std::size_t Levels>
+template<typename Node>
+void splice_list_skip_index<Levels>::ops<Node>::rebuild(NodeP s)
+{
+	NodeP       last[Levels];
+	std::size_t lastpos[Levels];
+	for (std::size_t l = 0; l < Levels; ++l)
+	{
+		last[l]    = s;
+		lastpos[l] = 0;
+	}
+	std::size_t pos = 0;
+	for (NodeP p = s->next; p != s; p = p->next)
+	{
+		++pos;
+		std::size_t h = height(p);
+		for (std::size_t l = 0; l < h; ++l)
+		{
+			lvl(last[l], l) = {p, pos - lastpos[l]};
+			last[l]         = p;
+			lastpos[l]      = pos;
+		}
+	}
+	++pos;
+	for (std::size_t l = 0; l < Levels; ++l)
+		lvl(last[l], l) = {s, pos - lastpos[l]};
+}
+
+/// <summary>
+/// walk forward to the sentinel, always on the top level of the current node
+/// (each tower met is at least as high as the last), counting the distance
+/// </summary>
+template<std::size_t Levels>
+template<typename Node>
+std::size_t splice_list_skip_index<Levels>::ops<Node>::rank(NodeP s, NodeP p, std::size_t n)
+{
+	std::size_t d = 0;
+	while (p != s)
+	{
+		std::size_t h = height(p);
+		if (h)
+		{
+			d += lvl(p, h - 1).span;
+			p = lvl(p, h - 1).next;
+		}
+		else
+		{
+			++d;
+			p = p->next;
+		}
+	}
+	return n - d;
+}
+
+template<std::size_t Levels>
+template<typename Node>
+void splice_list_skip_index<Levels>::ops<Node>::find(NodeP s, std::size_t r, NodeP* upd, std::size_t* pos)
+{
+	NodeP       x = s;
+	std::size_t p = 0;
+	for (std::size_t l = Levels; l-- > 0;)
+	{
+		while (lvl(x, l).next != s && p + lvl(x, l).span <= r)
+		{
+			p += lvl(x, l).span;
+			x = lvl(x, l).next;
+		}
+		upd[l] = x;
+		pos[l] = p;
+	}
+}
+
+template<std::size_t Levels>
+template<typename Node>
+auto splice_list_skip_index<Levels>::ops<Node>::nth(NodeP s, std::size_t i) -> NodeP
+{
+	NodeP       x = s;
+	std::size_t p = 0;
+	for (std::size_t l = Levels; l-- > 0;)
+	{
+		while (lvl(x, l).next != s && p + lvl(x, l).span <= i + 1)
+		{
+			p += lvl(x, l).span;
+			x = lvl(x, l).next;
+		}
+	}
+	for (; p < i + 1; ++p)
+		x = x->next;
+	return x;
+}
+
+/// <summary>
+/// links crossing the new node on its levels are split in two,
+/// the ones above it just get one longer
+/// </summary>
+template<std::size_t Levels>
+template<typename Node>
+void splice_list_skip_index<Levels>::ops<Node>::inserted(NodeP s, NodeP p, std::size_t n)
+{
+	NodeP       upd[Levels];
+	std::size_t pos[Levels];
+	// p has no links yet, start from its successor
+	std::size_t r = rank(s, p->next, n) - 1;
+	find(s, r, upd, pos);
+	std::size_t h = height(p);
+	for (std::size_t l = 0; l < Levels; ++l)
+	{
+		Link& u = lvl(upd[l], l);
+		if (l < h)
+		{
+			lvl(p, l) = {u.next, pos[l] + u.span - r};
+			u         = {p, r + 1 - pos[l]};
+		}
+		else
+		{
+			++u.span;
+		}
+	}
+}
+
+template<std::size_t Levels>
+template<typename Node>
+void splice_list_skip_index<Levels>::ops<Node>::erased(NodeP s, NodeP p, std::size_t n)
+{
+	NodeP       upd[Levels];
+	std::size_t pos[Levels];
+	find(s, rank(s, p, n), upd, pos);
+	std::size_t h = height(p);
+	for (std::size_t l = 0; l < Levels; ++l)
+	{
+		Link& u = lvl(upd[l], l);
+		if (l < h)
+		{
+			u.span += lvl(p, l).span - 1;
+			u.next = lvl(p, l).next;
+		}
+		else
+		{
+			--u.span;
+		}
+	}
+}
+
+/// <summary>
+/// cut the tower segment of [rf,rl) out of src, closing each level over the gap,
+/// then open dst at rp and put the segment in. levels with no tower in the range
+/// only change the length of the link crossing the cut
+/// </summary>
+template<std::size_t Levels>
+template<typename Node>
+void splice_list_skip_index<Levels>::ops<Node>::moved(
+	NodeP src, std::size_t rf, std::size_t rl, NodeP dst, std::size_t rp)
+{
+	if (rf == rl)
+		return;
+	std::size_t len = rl - rf;
+
+	NodeP       a[Levels], b[Levels], c[Levels];
+	std::size_t apos[Levels], bpos[Levels], cpos[Levels];
+	NodeP       first[Levels];
+	std::size_t first_off[Levels], last_off[Levels];
+
+	find(src, rf, a, apos);
+	find(src, rl, b, bpos);
+	for (std::size_t l = 0; l < Levels; ++l)
+	{
+		Link& al = lvl(a[l], l);
+		if (a[l] == b[l])
+		{
+			first[l] = nullptr;
+			al.span -= len;
+			continue;
+		}
+		Link& bl     = lvl(b[l], l);
+		first[l]     = al.next;
+		first_off[l] = apos[l] + al.span - rf - 1;
+		last_off[l]  = bpos[l] - rf - 1;
+		al           = {bl.next, bpos[l] + bl.span - len - apos[l]};
+	}
+
+	if (src == dst && rp > rf)
+		rp -= len;
+	find(dst, rp, c, cpos);
+	for (std::size_t l = 0; l < Levels; ++l)
+	{
+		Link& cl = lvl(c[l], l);
+		if (!first[l])
+		{
+			cl.span += len;
+			continue;
+		}
+		NodeP       x    = cl.next;
+		std::size_t xpos = cpos[l] + cl.span + len;
+		cl               = {first[l], rp + 1 + first_off[l] - cpos[l]};
+		lvl(b[l], l)     = {x, xpos - (rp + 1 + last_off[l])};
+	}
+}
@@ -1,12 +1,26 @@
 
+#define SUPRESS_MAIN
+
 #include "avl_array/avl_array.hpp"
 #include "avl_vector.hpp"
+#include "debug_container.hpp"
+#include "inline_flat_map.hpp"
 #include "inline_vector.hpp"
+#include "intrusive_splice_list.hpp"
+#include "polymorphic_container.hpp"
 #include "splice_list.hpp"
 #include "test_item.hpp"
+#include "unrolled_splice_list.hpp"
 
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 #include <list>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <typeinfo>
+#include <unordered_map>
 #include <vector>
 
 constexpr std::size_t REP = 15;
@@ -17,6 +31,125 @@ using namespace std::literals;
 constexpr std::size_t SML = (SZ * 3) / 2;
 constexpr std::size_t BIG = SZ * 3;
 
+// 64 bytes of plain old data, moved around with memmove
+struct pod64
+{
+	int v[16];
+	pod64() = default;
+	pod64(int i) : v{i} {}
+};
+
+// a small hierarchy for the polymorphic containers, three sizes of derived type.
+// final, so calls through the derived types are direct
+struct poly_base
+{
+	virtual ~poly_base() = default;
+	virtual int get() const = 0;
+};
+struct poly_int final : poly_base
+{
+	int i;
+	poly_int(int i) : i(i) {}
+	int get() const override { return i; }
+};
+struct poly_pair final : poly_base
+{
+	float a, b;
+	poly_pair(int i) : a((float)i), b(0.5f) {}
+	int get() const override { return (int)(a + b); }
+};
+struct poly_big final : poly_base
+{
+	int v[12];
+	poly_big(int i) : v{i} {}
+	int get() const override { return v[0]; }
+};
+
+// inline capacity for the oscillating workload
+constexpr std::size_t OSC = 16;
+
+// keeps count of the spill bytes Base hands out
+template<typename Base>
+struct counted_spill : Base
+{
+	static inline std::size_t live = 0;
+	static inline std::size_t peak = 0;
+
+	template<typename T>
+	static T* allocate(std::size_t n)
+	{
+		T* p = Base::template allocate<T>(n);
+		live += n * sizeof(T);
+		peak = std::max(peak, live);
+		return p;
+	}
+	template<typename T>
+	static void deallocate(T* p, std::size_t n)
+	{
+		live -= n * sizeof(T);
+		Base::template deallocate<T>(p, n);
+	}
+};
+
+// stays on the heap once spilled, until emptied
+struct keep_spill : inline_vector_policy
+{
+	static std::size_t shrink_to(std::size_t) { return 0; }
+};
+
+spill_arena& osc_arena()
+{
+	static spill_arena a;
+	return a;
+}
+
+typedef counted_spill<inline_vector_policy>   osc_default;
+typedef counted_spill<keep_spill>             osc_keep;
+typedef counted_spill<arena_spill<osc_arena>> osc_arena_spill;
+
+// std::allocator counting the calls to allocate, all types together
+template<typename T>
+struct counting_allocator : std::allocator<T>
+{
+	static inline std::size_t calls = 0;
+
+	counting_allocator() = default;
+	template<typename U>
+	counting_allocator(const counting_allocator<U>&) noexcept
+	{
+	}
+
+	template<typename U>
+	struct rebind
+	{
+		typedef counting_allocator<U> other;
+	};
+
+	T* allocate(std::size_t n)
+	{
+		++counting_allocator<void*>::calls;
+		return std::allocator<T>::allocate(n);
+	}
+};
+
+// calls to the global operator new so far, see new_count.cpp
+extern std::size_t new_calls();
+
+// reports a failed check of a testsuit, returns ok
+static bool check(bool ok, const std::string& what)
+{
+	if (!ok)
+		std::cout << what << " test failed" << std::endl;
+	return ok;
+}
+
+typedef ext::polymorphic_container<poly_base, std::vector, counting_allocator> poly_counted;
+typedef ext::polymorphic_container<poly_base, std::vector, counting_allocator, ext::no_slot, ext::monotonic_arena>
+	poly_arena;
+typedef ext::polymorphic_container<poly_base, std::vector, counting_allocator, ext::inline_slot<16>,
+								   ext::monotonic_arena>
+	poly_slot_arena;
+
 namespace CT
 {
 std::string nameof(std::vector<int>)
@@ -36,6 +169,19 @@ std::string nameof(avl::vector<test_item>)
 {
 	return "avl::vector<test_item>"s;
 }
+std::string nameof(std::list<int>)
+{
+	return "std::list<int>"s;
+}
+std::string nameof(splice_list<int>)
+{
+	return "splice_list<int>"s;
+}
+std::string nameof(pooled_splice_list<int>)
+{
+	return "pooled_splice_list<int>"s;
+}
+
 std::string nameof(std::list<test_item>)
 {
 	return "std::list<test_item>"s;
@@ -44,7 +190,27 @@ std::string nameof(splice_list<test_item>)
 {
 	return "splice_list<test_item>"s;
 }
+std::string nameof(indexed_splice_list<test_item>)
+{
+	return "indexed_splice_list<test_item>"s;
+}
+std::string nameof(unrolled_splice_list<test_item>)
+{
+	return "unrolled_splice_list<test_item>"s;
+}
 
+std::string nameof(std::vector<pod64>)
+{
+	return "std::vector<pod64>"s;
+}
+std::string nameof(inline_vector<int, SML>)
+{
+	return "inline_vector<int," + std::to_string(SML) + ">"s;
+}
+std::string nameof(inline_vector<pod64, SML>)
+{
+	return "inline_vector<pod64," + std::to_string(SML) + ">"s;
+}
 std::string nameof(inline_vector<test_item, SML>)
 {
 	return "inline_vector<test_item," + std::to_string(SML) + ">"s;
@@ -54,6 +220,108 @@ std::string nameof(inline_vector<test_item, BIG>)
 	return "inline_vector<test_item," + std::to_string(BIG) + ">"s;
 }
 
+std::string nameof(inline_vector<int, OSC, osc_default>)
+{
+	return "inline_vector<int," + std::to_string(OSC) + ",default>"s;
+}
+std::string nameof(inline_vector<int, OSC, osc_keep>)
+{
+	return "inline_vector<int," + std::to_string(OSC) + ",keep_spill>"s;
+}
+std::string nameof(inline_vector<int, OSC, osc_arena_spill>)
+{
+	return "inline_vector<int," + std::to_string(OSC) + ",arena_spill>"s;
+}
+
+std::string nameof(std::vector<char>)
+{
+	return "std::vector<char>"s;
+}
+std::string nameof(inline_vector<char, 15>)
+{
+	return "inline_vector<char,15>"s;
+}
+std::string nameof(inline_vector<char, 23>)
+{
+	return "inline_vector<char,23>"s;
+}
+
+std::string nameof(std::map<int, int>)
+{
+	return "std::map<int,int>"s;
+}
+std::string nameof(std::unordered_map<int, int>)
+{
+	return "std::unordered_map<int,int>"s;
+}
+std::string nameof(inline_flat_map<int, int, 16>)
+{
+	return "inline_flat_map<int,int,16>"s;
+}
+std::string nameof(std::set<int>)
+{
+	return "std::set<int>"s;
+}
+std::string nameof(inline_flat_set<int, 16>)
+{
+	return "inline_flat_set<int,16>"s;
+}
+
+std::string nameof(ext::polymorphic_container<poly_base>)
+{
+	return "polymorphic_container<poly_base>"s;
+}
+std::string nameof(ext::polymorphic_container<poly_base, std::vector, std::allocator, ext::inline_slot<16>>)
+{
+	return "polymorphic_container<poly_base,inline_slot<16>>"s;
+}
+std::string nameof(poly_counted)
+{
+	return "polymorphic_container<poly_base,counting_allocator>"s;
+}
+std::string nameof(poly_arena)
+{
+	return "polymorphic_container<poly_base,counting_allocator,monotonic_arena>"s;
+}
+std::string nameof(poly_slot_arena)
+{
+	return "polymorphic_container<poly_base,counting_allocator,inline_slot<16>,monotonic_arena>"s;
+}
+std::string nameof(ext::segregated_container<poly_base>)
+{
+	return "segregated_container<poly_base>"s;
+}
+// taken by reference, the sweep names its containers while they are full
+std::string nameof(const ext::polymorphic_container<test_item>&)
+{
+	return "polymorphic_container<test_item>"s;
+}
+std::string nameof(const ext::polymorphic_container<test_item, avl::vector>&)
+{
+	return "polymorphic_container<test_item,avl::vector>"s;
+}
+std::string nameof(const ext::polymorphic_container<test_item, splice_list>&)
+{
+	return "polymorphic_container<test_item,splice_list>"s;
+}
+std::string nameof(const ext::polymorphic_container<test_item, mkr::avl_array>&)
+{
+	return "polymorphic_container<test_item,mkr::avl_array>"s;
+}
+
+std::string nameof(debug_container<int>)
+{
+	return "debug_container<int>"s;
+}
+std::string nameof(debug_container<int, std::allocator<int>, sampled_checking<16>>)
+{
+	return "debug_container<int,sampled_checking<16>>"s;
+}
+std::string nameof(debug_container<int, std::allocator<int>, sampled_checking<256>>)
+{
+	return "debug_container<int,sampled_checking<256>>"s;
+}
+
 std::string nameof(mkr::avl_array<int>)
 {
 	return "mkr::avl_array<int>"s;
@@ -72,6 +340,10 @@ void testsuit_performance()
 	using namespace std;
 	using namespace CT;
 
+	clear_times();
+	problem_size    = SZ;
+	timing.counters = true;
+
 	vector<int> vi;
 	{
 		bool ok = true;
@@ -79,14 +351,21 @@ void testsuit_performance()
 		{
 			cout << "\r" << i << "   " << flush;
 			vi.clear();
-			vector<test_item>             vti;
-			list<test_item>               lti;
-			inline_vector<test_item, SML> ivtis;
-			inline_vector<test_item, BIG> ivtib;
-			splice_list<test_item>        slti;
-			avl::vector<test_item>        avti;
-
-#define ALL vi, vti, lti, ivtis, ivtib, slti, avti
+			vector<test_item>               vti;
+			list<test_item>                 lti;
+			inline_vector<test_item, SML>   ivtis;
+			inline_vector<test_item, BIG>   ivtib;
+			splice_list<test_item>          slti;
+			indexed_splice_list<test_item>  islti;
+			unrolled_splice_list<test_item> uslti;
+			avl::vector<test_item>          avti;
+
+			ext::polymorphic_container<test_item>                  pvti;
+			ext::polymorphic_container<test_item, avl::vector>     pavti;
+			ext::polymorphic_container<test_item, splice_list>     pslti;
+			ext::polymorphic_container<test_item, mkr::avl_array> paati;
+
+#define ALL vi, vti, lti, ivtis, ivtib, slti, islti, uslti, avti, pvti, pavti, pslti, paati
 			//#define ALL vi, vti, lti, avti
 
 			fillup<>{}(SZ, ALL);
@@ -110,6 +389,9 @@ void testsuit_performance()
 			if (ok) CT::sort<>{}(ALL);
 			if (ok) ok = CT::integrity<>{}(ALL) && compare<>{}(ALL);
 
+			if (ok) CT::move_back<>{}(ALL);
+			if (ok) ok = CT::integrity<>{}(ALL) && compare<>{}(ALL);
+
 			if (ok) CT::unique<>{}(ALL);
 			if (ok) ok = CT::integrity<>{}(ALL) && compare<>{}(ALL);
 
@@ -153,4 +435,1375 @@ void testsuit_performance()
 	cout << endl;
 	report_times<decltype(vi)>();
 	// report_times(1000.0, "ms");
+	timing.counters = false;
+}
+
+void testsuit_avl_sort()
+{
+	using namespace std;
+	using namespace CT;
+
+	clear_times();
+	problem_size = SZ * 100;
+
+	vector<int> vi;
+	fillup<>{}(SZ * 100, vi);
+
+	for (size_t i = 0; i < REP; ++i)
+	{
+		cout << "\r" << i << "   " << flush;
+
+		// tree insertion sort (what stable_sort used to do, with m_oldpos per node)
+		mkr::avl_array<int> aas(vi.begin(), vi.end());
+		start_clock();
+		aas.sort();
+		time_data[nameof(aas)]["sort"] += stop_clock();
+
+		// list merge sort + rebuild, no per node storage
+		mkr::avl_array<int> aass(vi.begin(), vi.end());
+		start_clock();
+		aass.stable_sort();
+		time_data[nameof(aass)]["stable_sort"] += stop_clock();
+
+		vector<int> vis = vi;
+		start_clock();
+		std::stable_sort(vis.begin(), vis.end());
+		time_data[nameof(vis)]["stable_sort"] += stop_clock();
+
+		if (!compare<>{}(vis, aas, aass))
+		{
+			cout << "sort compare failed" << endl;
+			break;
+		}
+	}
+
+	// ints can't show instability: sort (key, seq) by key only, with many equal keys
+	typedef pair<int, int> keyed;
+	mkr::avl_array<keyed>  ak;
+	for (size_t i = 0; i < SZ * 100; ++i)
+		ak.push_back(keyed(rand() % 16, int(i)));
+	ak.stable_sort([](const keyed& a, const keyed& b) { return a.first < b.first; });
+	for (auto it = ak.begin(), prev = it++; it != ak.end(); prev = it++)
+		if (prev->first > it->first || (prev->first == it->first && prev->second > it->second))
+		{
+			cout << "stable_sort kept no order between equals" << endl;
+			break;
+		}
+
+	cout << "\r";
+	report_times<>();
+}
+
+void testsuit_list_sort()
+{
+	using namespace std;
+	using namespace CT;
+
+	clear_times();
+	problem_size = SZ * 100;
+
+	vector<int> vi;
+	fillup<>{}(SZ * 100, vi);
+
+	vector<int> sorted = vi;
+	std::sort(sorted.begin(), sorted.end());
+	vector<int> reversed(sorted.rbegin(), sorted.rend());
+	vector<int> nearly = sorted;
+	for (size_t i = 0; i < nearly.size() / 100; ++i)
+		swap(nearly[rand() % nearly.size()], nearly[rand() % nearly.size()]);
+
+	const pair<string, const vector<int>*> inputs[] = {
+		{"random", &vi}, {"sorted", &sorted}, {"reversed", &reversed}, {"nearly_sorted", &nearly}};
+
+	for (size_t i = 0; i < REP; ++i)
+	{
+		cout << "\r" << i << "   " << flush;
+
+		for (auto&& in : inputs)
+		{
+			splice_list<int> sl(in.second->begin(), in.second->end());
+			start_clock();
+			sl.sort();
+			time_data[nameof(sl)]["sort_" + in.first] += stop_clock();
+
+			list<int> li(in.second->begin(), in.second->end());
+			start_clock();
+			li.sort();
+			time_data[nameof(li)]["sort_" + in.first] += stop_clock();
+
+			if (!compare<>{}(sorted, sl, li))
+			{
+				cout << "sort compare failed" << endl;
+				return;
+			}
+		}
+	}
+
+	cout << "\r";
+	report_times<>();
+}
+
+template<typename L>
+static void list_churn(L& lst, std::size_t n)
+{
+	using namespace CT;
+
+	start_clock();
+	for (std::size_t i = 0; i < n; ++i)
+		lst.push_back((int)i);
+	time_data[nameof(lst)]["fill"] += stop_clock();
+
+	// erase every other element and put a new one back in its place, four times over
+	start_clock();
+	for (int r = 0; r < 4; ++r)
+	{
+		auto it = lst.begin();
+		while (it != lst.end())
+		{
+			it = lst.erase(it);
+			it = lst.insert(it, r);
+			++it;
+			if (it != lst.end())
+				++it;
+		}
+	}
+	time_data[nameof(lst)]["churn"] += stop_clock();
+
+	start_clock();
+	lst.clear();
+	time_data[nameof(lst)]["clear"] += stop_clock();
+}
+
+void testsuit_list_alloc()
+{
+	using namespace std;
+	using namespace CT;
+
+	clear_times();
+
+	const size_t n = SZ * 100;
+	problem_size   = n;
+
+	for (size_t i = 0; i < REP; ++i)
+	{
+		cout << "\r" << i << "   " << flush;
+
+		list<int> li;
+		list_churn(li, n);
+
+		splice_list<int> sl;
+		list_churn(sl, n);
+
+		pooled_splice_list<int> psl;
+		list_churn(psl, n);
+		// second round on the same list, all nodes come from the warm pool
+		list_churn(psl, n);
+
+		// two lists on one pool, nodes move between them and are freed by the other one
+		pool_allocator<int>     pa;
+		pooled_splice_list<int> src(pa), dst(pa);
+		for (size_t j = 0; j < n; ++j)
+			src.push_back((int)j);
+		start_clock();
+		for (size_t j = 0; j < n; ++j)
+		{
+			dst.splice(dst.end(), src, src.begin());
+			dst.pop_front();
+			src.push_back((int)j);
+		}
+		time_data[nameof(dst)]["shared_pool"] += stop_clock();
+	}
+
+	cout << "\r";
+	report_times<>();
+}
+
+template<typename V>
+static void vector_mid_insert(V& v, std::size_t n)
+{
+	using namespace CT;
+	typedef typename V::value_type T;
+
+	start_clock();
+	for (std::size_t i = 0; i < n; ++i)
+		v.insert(v.begin() + v.size() / 2, T((int)i));
+	time_data[nameof(v)]["mid_insert"] += stop_clock();
+
+	start_clock();
+	while (!v.empty())
+		v.erase(v.begin() + v.size() / 2);
+	time_data[nameof(v)]["mid_erase"] += stop_clock();
+}
+
+void testsuit_inline_vector_insert()
+{
+	using namespace std;
+	using namespace CT;
+
+	clear_times();
+
+	// more than SML, so the inline vectors spill to the heap halfway through
+	const size_t n = SZ * 2;
+	problem_size   = n;
+
+	for (size_t i = 0; i < REP; ++i)
+	{
+		cout << "\r" << i << "   " << flush;
+
+		vector<int>             vi;
+		inline_vector<int, SML> ivi;
+		vector_mid_insert(vi, n);
+		vector_mid_insert(ivi, n);
+
+		vector<pod64>             vp;
+		inline_vector<pod64, SML> ivp;
+		vector_mid_insert(vp, n);
+		vector_mid_insert(ivp, n);
+
+		vector<test_item>             vti;
+		inline_vector<test_item, SML> ivti;
+		vector_mid_insert(vti, n);
+		vector_mid_insert(ivti, n);
+	}
+
+	cout << "\r";
+	report_times<>();
+}
+
+/// <summary>
+/// a crowd of small vectors going above their inline capacity and back down, round after
+/// round, with the spill bytes kept at the end of each phase
+/// </summary>
+template<typename P>
+static void vector_oscillate(std::size_t count, std::size_t rounds)
+{
+	using namespace CT;
+	typedef inline_vector<int, OSC, P> V;
+
+	std::vector<V> vs(count);
+	std::size_t    high = 0, low = 0;
+	for (std::size_t r = 0; r < rounds; ++r)
+	{
+		start_clock();
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			V&          v = vs[i];
+			std::size_t k = OSC * 2 + (i + r) % (OSC * 2);
+			while (v.size() < k)
+				v.push_back((int)v.size());
+		}
+		time_data[nameof(V{})]["grow"] += stop_clock();
+		high += P::live;
+
+		start_clock();
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			V&          v = vs[i];
+			std::size_t k = (i + r) % (OSC / 2);
+			while (v.size() > k)
+				v.pop_back();
+		}
+		time_data[nameof(V{})]["shrink"] += stop_clock();
+		low += P::live;
+	}
+	std::cout << nameof(V{}) << " spill KiB, grown: " << high / rounds / 1024 << " shrunk: " << low / rounds / 1024
+			  << " peak: " << P::peak / 1024 << "\n";
+}
+
+void testsuit_inline_vector_oscillate()
+{
+	using namespace std;
+	using namespace CT;
+
+	clear_times();
+
+	const size_t count  = SZ * 8;
+	const size_t rounds = REP * 4;
+	problem_size        = count;
+
+	vector_oscillate<osc_default>(count, rounds);
+	vector_oscillate<osc_keep>(count, rounds);
+	vector_oscillate<osc_arena_spill>(count, rounds);
+	cout << "spill_arena KiB reserved: " << osc_arena().reserved() / 1024 << "\n";
+
+	report_times<>();
+}
+
+// keeps the scans from being optimised away
+static volatile std::size_t scan_sink;
+
+/// <summary>
+/// lots of short strings of chars kept in an array of vectors, most of them short enough to
+/// stay inline. reports the bytes taken (array plus spill buffers) next to the fill and scan time
+/// </summary>
+template<typename V>
+static void vector_population(std::size_t count, std::size_t rounds)
+{
+	using namespace CT;
+	typedef typename V::value_type T;
+
+	std::size_t bytes = 0;
+	for (std::size_t r = 0; r < rounds; ++r)
+	{
+		srand(11);
+		std::vector<V> vs(count);
+
+		start_clock();
+		for (V& v : vs)
+		{
+			// 0..31, the long ones rarer
+			std::size_t k = (rand() % 32) & (rand() % 32);
+			for (std::size_t i = 0; i < k; ++i)
+				v.push_back((T)('a' + i));
+		}
+		time_data[nameof(V{})]["fill"] += stop_clock();
+
+		start_clock();
+		std::size_t sum = 0;
+		for (const V& v : vs)
+			for (T c : v)
+				sum += c;
+		time_data[nameof(V{})]["scan"] += stop_clock();
+
+		// heap bytes, for the vectors whose data is not in the vector itself
+		bytes = sizeof(V) * count;
+		for (const V& v : vs)
+		{
+			const char* d = (const char*)v.data();
+			if (v.capacity() && (d < (const char*)&v || d >= (const char*)(&v + 1)))
+				bytes += v.capacity() * sizeof(T);
+		}
+		scan_sink = sum;
+	}
+	std::cout << nameof(V{}) << " sizeof " << sizeof(V) << ", KiB for " << count << ": " << bytes / 1024 << "\n";
+}
+
+void testsuit_inline_vector_memory()
+{
+	using namespace std;
+	using namespace CT;
+
+	clear_times();
+
+	const size_t count  = SZ * 400;
+	const size_t rounds = REP;
+	problem_size        = count;
+
+	vector_population<vector<char>>(count, rounds);
+	vector_population<inline_vector<char, 15>>(count, rounds);
+	vector_population<inline_vector<char, 23>>(count, rounds);
+
+	report_times<>();
+}
+
+template<typename M, typename = void>
+struct has_mapped : std::false_type
+{
+};
+template<typename M>
+struct has_mapped<M, std::void_t<typename M::mapped_type>> : std::true_type
+{
+};
+
+// what goes into a map or a set for key k
+template<typename M>
+static auto lookup_entry(int k)
+{
+	if constexpr (has_mapped<M>::value)
+		return std::pair<int, int>(k, 1);
+	else
+		return k;
+}
+
+// a sorted range in one go, the flat ones merge it
+template<typename M, typename It>
+static void lookup_insert_sorted(M& m, It b, It e)
+{
+	m.insert(b, e);
+}
+template<typename It>
+static void lookup_insert_sorted(inline_flat_map<int, int, 16>& m, It b, It e)
+{
+	m.insert_sorted_range(b, e);
+}
+template<typename It>
+static void lookup_insert_sorted(inline_flat_set<int, 16>& m, It b, It e)
+{
+	m.insert_sorted_range(b, e);
+}
+
+/// <summary>
+/// a crowd of maps (or sets) of sz entries each, built one key at a time, then probed with
+/// keys of which about half are in. then the even keys, sorted, go in one range at a time:
+/// into empty ones (bulk) and into the crowd (merge). ops are named by sz, so the sizes line up
+/// </summary>
+template<typename M>
+static void map_lookup(std::size_t sz, std::size_t count, std::size_t probes)
+{
+	using namespace CT;
+
+	std::string tag  = (sz < 10 ? " 0" : " ") + std::to_string(sz);
+	int         keys = (int)sz * 2;
+
+	srand(5);
+	std::vector<M> ms(count);
+	start_clock();
+	for (M& m : ms)
+		while (m.size() < sz)
+			m.insert(lookup_entry<M>(rand() % keys));
+	time_data[nameof(M{})]["build" + tag] += stop_clock();
+
+	std::vector<int> ks(probes);
+	for (int& k : ks)
+		k = rand() % keys;
+	std::size_t hits = 0;
+	bench(nameof(M{}), "find" + tag, [&] {
+		for (const M& m : ms)
+			for (int k : ks)
+				hits += m.find(k) != m.end();
+	});
+	scan_sink = hits;
+
+	std::vector<decltype(lookup_entry<M>(0))> evens;
+	for (int k = 0; k < keys; k += 2)
+		evens.push_back(lookup_entry<M>(k));
+
+	std::vector<M> bulk(count);
+	start_clock();
+	for (M& m : bulk)
+		lookup_insert_sorted(m, evens.begin(), evens.end());
+	time_data[nameof(M{})]["bulk" + tag] += stop_clock();
+
+	start_clock();
+	for (M& m : ms)
+		lookup_insert_sorted(m, evens.begin(), evens.end());
+	time_data[nameof(M{})]["merge" + tag] += stop_clock();
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		bool ok = bulk[i].size() == sz;
+		for (int k = 0; k < keys; ++k)
+			ok = ok && bulk[i].count(k) == (k % 2 == 0) && (k % 2 != 0 || ms[i].count(k));
+		if (!ok)
+		{
+			std::cout << nameof(M{}) << " sorted range insert failed" << std::endl;
+			break;
+		}
+	}
+}
+
+void testsuit_inline_flat_map()
+{
+	using namespace std;
+	using namespace CT;
+
+	clear_times();
+	auto saved    = timing;
+	timing.repeat = 5;
+
+	const size_t count  = SZ * 2;
+	const size_t probes = 64;
+	problem_size        = count;
+
+	for (size_t i = 0; i < REP; ++i)
+	{
+		cout << "\r" << i << "   " << flush;
+		for (size_t sz = 1; sz <= 64; sz *= 2)
+		{
+			map_lookup<map<int, int>>(sz, count, probes);
+			map_lookup<unordered_map<int, int>>(sz, count, probes);
+			map_lookup<inline_flat_map<int, int, 16>>(sz, count, probes);
+			map_lookup<set<int>>(sz, count, probes);
+			map_lookup<inline_flat_set<int, 16>>(sz, count, probes);
+		}
+	}
+	timing = saved;
+
+	cout << "\r";
+	report_times<>();
+}
+
+// the types in turn, or at random when mixed
+template<typename PC>
+static void polymorphic_fill(PC& pc, std::size_t n, bool mixed = false)
+{
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		switch (mixed ? rand() % 3 : i % 3)
+		{
+		case 0: pc.template emplace_back<poly_int>((int)i); break;
+		case 1: pc.template emplace_back<poly_pair>((int)i); break;
+		case 2: pc.template emplace_back<poly_big>((int)i); break;
+		}
+	}
+}
+
+/// <summary>
+/// insert, erase from the back and clear of a big mix of small derived types
+/// </summary>
+template<typename PC>
+static void polymorphic_churn(std::size_t n)
+{
+	using namespace CT;
+
+	PC pc;
+	start_clock();
+	polymorphic_fill(pc, n);
+	time_data[nameof(PC{})]["insert"] += stop_clock();
+
+	start_clock();
+	for (std::size_t i = 0; i < n / 2; ++i)
+		pc.pop_back();
+	time_data[nameof(PC{})]["erase"] += stop_clock();
+
+	start_clock();
+	pc.clear();
+	time_data[nameof(PC{})]["clear"] += stop_clock();
+}
+
+void testsuit_polymorphic()
+{
+	using namespace std;
+	using namespace CT;
+
+	clear_times();
+
+	const size_t n = 10'000'000;
+	problem_size   = n;
+
+	for (size_t i = 0; i < 3; ++i)
+	{
+		cout << "\r" << i << "   " << flush;
+		polymorphic_churn<ext::polymorphic_container<poly_base>>(n);
+		polymorphic_churn<ext::polymorphic_container<poly_base, std::vector, std::allocator, ext::inline_slot<16>>>(n);
+	}
+
+	cout << "\r";
+	report_times<>();
+}
+
+/// <summary>
+/// a container filled, read, copied to a snapshot and cleared again each tick, the elements
+/// allocated one by one or from the arena of the container. calls to allocate per tick: the
+/// arena only has the growing item vectors left, as the blocks go to operator new
+/// </summary>
+template<typename PC>
+static void polymorphic_ticks(PC& pc, std::size_t n, std::size_t ticks)
+{
+	using namespace CT;
+
+	std::size_t calls = counting_allocator<void*>::calls;
+	long long   sum   = 0;
+	PC          snapshot;
+	for (std::size_t t = 0; t < ticks; ++t)
+	{
+		start_clock();
+		polymorphic_fill(pc, n, true);
+		time_data[nameof(PC{})]["fill"] += stop_clock();
+
+		start_clock();
+		for (auto& x : pc)
+			sum += x.get();
+		time_data[nameof(PC{})]["visit"] += stop_clock();
+
+		start_clock();
+		snapshot = pc;
+		time_data[nameof(PC{})]["snapshot"] += stop_clock();
+		sum += snapshot.back().get();
+
+		start_clock();
+		pc.clear();
+		time_data[nameof(PC{})]["clear"] += stop_clock();
+	}
+	scan_sink = (std::size_t)sum;
+	std::cout << nameof(PC{}) << " allocate calls per tick: " << (counting_allocator<void*>::calls - calls) / ticks
+			  << "\n";
+}
+
+void testsuit_polymorphic_alloc()
+{
+	using namespace std;
+	using namespace CT;
+
+	clear_times();
+
+	const size_t n = SZ * 400;
+	problem_size   = n;
+
+	poly_counted pc;
+	srand(3);
+	polymorphic_ticks(pc, n, REP);
+
+	poly_arena pa;
+	srand(3);
+	polymorphic_ticks(pa, n, REP);
+
+	poly_slot_arena ps;
+	srand(3);
+	polymorphic_ticks(ps, n, REP);
+
+	report_times<>();
+}
+
+// the elements of b copied from those of a: the same values and dynamic types, objects of their own
+template<typename PC>
+static bool polymorphic_same(const PC& a, const PC& b)
+{
+	if (a.size() != b.size())
+		return false;
+	auto j = b.begin();
+	for (auto i = a.begin(); i != a.end(); ++i, ++j)
+		if (i->get() != j->get() || typeid(*i) != typeid(*j) || &*i == &*j)
+			return false;
+	return true;
+}
+
+template<typename PC>
+static bool polymorphic_copies()
+{
+	bool ok = true;
+
+	// the growing item vector relocates the elements in slots
+	PC a;
+	polymorphic_fill(a, 1000, true);
+	int k = 0;
+	for (auto& x : a)
+		if (x.get() != k++)
+			ok = check(false, "polymorphic relocation");
+
+	PC b(a);
+	ok = check(polymorphic_same(a, b), "polymorphic copy") && ok;
+
+	PC c;
+	polymorphic_fill(c, 300, true);
+	c = a;
+	ok = check(polymorphic_same(a, c), "polymorphic copy assignment") && ok;
+
+	PC one;
+	one.template emplace_back<poly_int>(7);
+	PC one_copy(one);
+	ok = check(polymorphic_same(one, one_copy), "polymorphic copy of one") && ok;
+
+	// the elements go along with the arena they live in
+	PC m(std::move(c));
+	ok = check(c.empty() && polymorphic_same(a, m), "polymorphic move") && ok;
+	m = std::move(b);
+	ok = check(polymorphic_same(a, m), "polymorphic move assignment") && ok;
+	m.clear();
+	polymorphic_fill(m, 100);
+	k = 0;
+	for (auto& x : m)
+		if (x.get() != k++)
+			ok = check(false, "polymorphic refill");
+
+	// an element inserted by pointer has no copy, the ones before it are copied
+	PC p;
+	p.template emplace_back<poly_int>(1);
+	p.push_back(static_cast<poly_base*>(new poly_pair(2)));
+	PC q;
+	bool thrown = false;
+	try
+	{
+		q = p;
+	}
+	catch (const std::logic_error&)
+	{
+		thrown = true;
+	}
+	ok = check(thrown && q.size() == 1 && q.front().get() == 1, "polymorphic copy by pointer") && ok;
+
+	return ok;
+}
+
+void testsuit_polymorphic_copy()
+{
+	using namespace std;
+
+	bool ok = check(polymorphic_copies<poly_counted>(), "copies");
+	ok      = check(polymorphic_copies<poly_arena>(), "arena copies") && ok;
+	ok      = check(polymorphic_copies<poly_slot_arena>(), "slot arena copies") && ok;
+
+	cout << "polymorphic copy: " << (ok ? "passed" : "FAILED") << endl;
+}
+
+/// <summary>
+/// a virtual call on each of a random mix of types, in the item vector (with and
+/// without inline slots) and in the pools by type: with the types named (direct
+/// calls), through the base, and in insertion order through the index
+/// </summary>
+void testsuit_polymorphic_visit()
+{
+	using namespace std;
+	using namespace CT;
+	using namespace ext;
+
+	clear_times();
+
+	const size_t n = SZ * 800;
+	problem_size   = n;
+
+	typedef polymorphic_container<poly_base>                                            PC;
+	typedef polymorphic_container<poly_base, std::vector, std::allocator, inline_slot<16>> PS;
+	typedef segregated_container<poly_base>                                             SC;
+
+	PC pc;
+	PS ps;
+	SC sc;
+
+	srand(9);
+	start_clock();
+	polymorphic_fill(pc, n, true);
+	time_data[nameof(PC{})]["fill"] += stop_clock();
+
+	srand(9);
+	start_clock();
+	polymorphic_fill(ps, n, true);
+	time_data[nameof(PS{})]["fill"] += stop_clock();
+
+	srand(9);
+	start_clock();
+	polymorphic_fill(sc, n, true);
+	time_data[nameof(SC{})]["fill"] += stop_clock();
+
+	long long sum = 0;
+	auto      get = [&sum](auto& x) { sum += x.get(); };
+	for (size_t i = 0; i < REP; ++i)
+	{
+		cout << "\r" << i << "   " << flush;
+
+		start_clock();
+		for (auto& x : pc)
+			get(x);
+		time_data[nameof(PC{})]["visit"] += stop_clock();
+
+		start_clock();
+		for (auto& x : ps)
+			get(x);
+		time_data[nameof(PS{})]["visit"] += stop_clock();
+
+		start_clock();
+		sc.visit_all<poly_int, poly_pair, poly_big>(get);
+		time_data[nameof(SC{})]["visit"] += stop_clock();
+
+		start_clock();
+		sc.visit_all([&sum](poly_base& x) { sum += x.get(); });
+		time_data[nameof(SC{})]["visit_base"] += stop_clock();
+
+		start_clock();
+		for (auto& x : sc)
+			get(x);
+		time_data[nameof(SC{})]["ordered"] += stop_clock();
+	}
+	scan_sink = (size_t)sum;
+
+	cout << "\r";
+	report_times<>();
+}
+
+template<typename C>
+static void debug_overhead(std::size_t n, std::size_t churn)
+{
+	using namespace CT;
+
+	C c;
+	start_clock();
+	for (std::size_t i = 0; i < n; ++i)
+		c.push_back((int)i);
+	time_data[nameof(C{})]["fill"] += stop_clock();
+
+	long long sum = 0;
+	start_clock();
+	for (auto it = c.begin(), e = c.end(); it != e; ++it)
+		sum += *it;
+	time_data[nameof(C{})]["scan"] += stop_clock();
+
+	// short lived iterators, as loops around erase and insert make them
+	start_clock();
+	for (std::size_t i = 0; i < churn; ++i)
+	{
+		auto it = c.end();
+		--it;
+		it = c.erase(it);
+		c.insert(it, (int)i);
+	}
+	time_data[nameof(C{})]["churn"] += stop_clock();
+
+	start_clock();
+	c.clear();
+	time_data[nameof(C{})]["clear"] += stop_clock();
+	scan_sink = (size_t)sum;
+}
+
+/// <summary>
+/// cost of debug_container checking every iterator, one in 16 and one in 256,
+/// against a plain std::vector
+/// </summary>
+void testsuit_debug_container()
+{
+	using namespace std;
+	using namespace CT;
+
+	clear_times();
+
+	const size_t n     = SZ * 100;
+	const size_t churn = SZ * 100;
+	problem_size       = n;
+
+	for (size_t i = 0; i < REP; ++i)
+	{
+		cout << "\r" << i << "   " << flush;
+		debug_overhead<vector<int>>(n, churn);
+		debug_overhead<debug_container<int>>(n, churn);
+		debug_overhead<debug_container<int, allocator<int>, sampled_checking<16>>>(n, churn);
+		debug_overhead<debug_container<int, allocator<int>, sampled_checking<256>>>(n, churn);
+	}
+
+	cout << "\r";
+	report_times<>();
+}
+
+// in two intrusive lists at once, through a hook each
+struct hooked
+{
+	int              v;
+	splice_list_hook by_a, by_b;
+	bool             operator<(const hooked& o) const { return v < o.v; }
+	bool             operator==(const hooked& o) const { return v == o.v; }
+};
+
+template<typename L>
+static std::vector<int> values_of(const L& l)
+{
+	std::vector<int> vs;
+	for (auto&& x : l)
+		vs.push_back(x.v);
+	return vs;
+}
+
+/// <summary>
+/// intrusive_splice_list against a std::vector of the values: single, range and self
+/// splices in and between lists, an object in two lists through two hooks, and inserts
+/// that must not allocate
+/// </summary>
+void testsuit_intrusive_list()
+{
+	using namespace std;
+
+	typedef intrusive_splice_list<hooked, member_hook<hooked, &hooked::by_a>> LA;
+	typedef intrusive_splice_list<hooked, member_hook<hooked, &hooked::by_b>> LB;
+
+	const int      n = 10;
+	vector<hooked> items(n);
+	vector<int>    ref, ref_b;
+	for (int i = 0; i < n; ++i)
+		items[i].v = i;
+
+	bool ok = true;
+	{
+		LA a, other;
+		LB b;
+
+		size_t calls = new_calls();
+		for (auto& x : items)
+		{
+			a.push_back(x);
+			b.push_front(x);
+		}
+		calls = new_calls() - calls;
+		ok    = check(calls == 0, "intrusive insert allocation") && ok;
+		for (auto& x : items)
+		{
+			ref.push_back(x.v);
+			ref_b.insert(ref_b.begin(), x.v);
+		}
+		ok = check(values_of(a) == ref && values_of(b) == ref_b && a.size() == n, "intrusive insert") && ok;
+
+		// single: the 4th to the front
+		a.splice(a.begin(), next(a.begin(), 3));
+		rotate(ref.begin(), ref.begin() + 3, ref.begin() + 4);
+		ok = check(values_of(a) == ref, "intrusive single splice") && ok;
+
+		// self: before itself and before its successor, nothing moves
+		auto it = next(a.begin(), 5);
+		a.splice(it, it);
+		a.splice(next(it), it);
+		a.splice(a.begin(), a.begin(), next(a.begin(), 2));
+		a.splice(next(a.begin(), 2), a.begin(), next(a.begin(), 2));
+		ok = check(values_of(a) == ref && a.size() == n, "intrusive self splice") && ok;
+
+		// range: [1,4) to the end
+		a.splice(a.end(), next(a.begin()), next(a.begin(), 4));
+		rotate(ref.begin() + 1, ref.begin() + 4, ref.end());
+		ok = check(values_of(a) == ref, "intrusive range splice") && ok;
+
+		// between lists: one, a counted range and an uncounted one
+		other.splice(other.end(), a, a.begin());
+		other.splice(other.end(), a, a.begin(), next(a.begin(), 2), 2);
+		other.splice(other.begin(), a, a.begin(), next(a.begin(), 3));
+		vector<int> ref_o(ref.begin() + 3, ref.begin() + 6);
+		ref_o.insert(ref_o.end(), ref.begin(), ref.begin() + 3);
+		ref.erase(ref.begin(), ref.begin() + 6);
+		ok = check(values_of(a) == ref && a.size() == ref.size(), "intrusive splice out") && ok;
+		ok = check(values_of(other) == ref_o && other.size() == ref_o.size(), "intrusive splice in") && ok;
+
+		a.splice(a.begin(), other);
+		ref.insert(ref.begin(), ref_o.begin(), ref_o.end());
+		ok = check(values_of(a) == ref && other.empty() && a.size() == n, "intrusive splice all") && ok;
+
+		// the other hook never moved
+		ok = check(values_of(b) == ref_b && b.size() == n, "intrusive second hook") && ok;
+
+		a.erase(a.begin());
+		ok = check(!items[ref.front()].by_a.is_linked() && items[ref.front()].by_b.is_linked(),
+				   "intrusive erase one hook") && ok;
+		ref.erase(ref.begin());
+
+		a.sort();
+		sort(ref.begin(), ref.end());
+		ok = check(values_of(a) == ref && values_of(b) == ref_b, "intrusive sort") && ok;
+
+		// a copy of a linked object is in no list, and can join one
+		hooked copy = items[ref.back()];
+		ok          = check(!copy.by_a.is_linked() && !copy.by_b.is_linked(), "intrusive copy unlinked") && ok;
+		a.push_back(copy);
+		copy.v = -1;
+		ref.push_back(-1);
+		ok = check(values_of(a) == ref && values_of(b) == ref_b, "intrusive copy insert") && ok;
+
+		// assignment copies the value, each side keeps its own links
+		items[ref.front()] = items[ref[1]];
+		ok = check(values_of(a).size() == ref.size() && items[ref[1]].by_a.is_linked(), "intrusive assign") && ok;
+
+		a.clear();
+		b.clear();
+	}
+	for (auto& x : items)
+		ok = check(!x.by_a.is_linked() && !x.by_b.is_linked(), "intrusive clear") && ok;
+
+	cout << "intrusive_splice_list: " << (ok ? "passed" : "FAILED") << endl;
+}
+
+typedef mkr::avl_array<int, std::allocator<int>, int> npsv_array;
+
+// the index against npsv_at_pos() and npsv_pos_of(), at every position and one past both ends
+static bool npsv_index_matches(npsv_array& a, npsv_array::npsv_index_t& idx)
+{
+	if (idx.size() != a.size() || idx.width() != a.npsv_width())
+		return false;
+	for (int pos = -1; pos <= a.npsv_width() + 1; ++pos)
+		if (idx.at_pos(pos) != a.npsv_at_pos(pos))
+			return false;
+	size_t i = 0;
+	for (auto it = a.begin(); it != a.end(); ++it, ++i)
+		if (idx.pos_of(i) != a.npsv_pos_of(it))
+			return false;
+	return true;
+}
+
+void testsuit_npsv_index()
+{
+	using namespace std;
+
+	srand(5);
+	const int n = 200;
+
+	npsv_array a;
+	for (int i = 0; i < n; ++i)
+		a.push_back(i);
+	for (auto it = a.begin(); it != a.end(); ++it)
+		a.npsv_set_width(it, rand() % 4); // zero widths included
+
+	npsv_array::npsv_index_t idx(a);
+	bool                     ok = check(npsv_index_matches(a, idx), "npsv index build");
+
+	for (int i = 0; i < n / 4; ++i)
+	{
+		// same size after the pair, the index must still notice
+		a.erase(a.begin() + rand() % a.size());
+		a.npsv_set_width(a.insert(a.begin() + rand() % (a.size() + 1), n + i), 1 + rand() % 3);
+		if (!npsv_index_matches(a, idx))
+			ok = check(false, "npsv index insert/erase");
+	}
+
+	for (int i = 0; i < n / 4; ++i)
+	{
+		size_t j = rand() % a.size();
+		int    w = rand() % 4;
+		if (i % 2)
+			idx.set_width(j, w);
+		else
+			a.npsv_set_width(a.begin() + j, w, i % 4 == 0);
+		if (!npsv_index_matches(a, idx))
+			ok = check(false, "npsv index set_width");
+	}
+
+	npsv_array::move(a.begin(), a.begin() + a.size() / 2);
+	ok = check(npsv_index_matches(a, idx), "npsv index move") && ok;
+
+	auto first = a.begin(), last = a.end() - 1;
+	a.npsv_set_width(first, 5);
+	a.npsv_set_width(last, 6);
+	npsv_array::swap(first, last);
+	ok = check(npsv_index_matches(a, idx), "npsv index swap") && ok;
+
+	// equal widths: no sum changes, only the order
+	a.npsv_set_width(first, 4);
+	a.npsv_set_width(last, 4);
+	ok = check(npsv_index_matches(a, idx), "npsv index set_width") && ok;
+	npsv_array::swap(first, last);
+	ok = check(npsv_index_matches(a, idx), "npsv index equal width swap") && ok;
+	a.npsv_set_width(a.begin(), 4);
+	a.npsv_set_width(a.begin() + 1, 4);
+	ok = check(npsv_index_matches(a, idx), "npsv index set_width") && ok;
+	npsv_array::move(a.begin(), 1);
+	ok = check(npsv_index_matches(a, idx), "npsv index equal width step") && ok;
+
+	a.reverse();
+	ok = check(npsv_index_matches(a, idx), "npsv index reverse") && ok;
+
+	a.sort();
+	ok = check(npsv_index_matches(a, idx), "npsv index sort") && ok;
+
+	npsv_array b;
+	b.push_back(-1);
+	a.swap(b);
+	ok = check(npsv_index_matches(a, idx), "npsv index array swap") && ok;
+
+	a.clear();
+	ok = check(npsv_index_matches(a, idx), "npsv index clear") && ok;
+
+	cout << "npsv_index: " << (ok ? "passed" : "FAILED") << endl;
+}
+
+void testsuit_avl_batch()
+{
+	using namespace std;
+
+	srand(7);
+	const int n = 300;
+
+	mkr::avl_array<int> a;
+	vector<int>         ref;
+	for (int i = 0; i < n; ++i)
+	{
+		a.push_back(i);
+		ref.push_back(i);
+	}
+
+	bool ok   = true;
+	int  next = n;
+	for (int round = 0; round < 60; ++round)
+	{
+		// few edits go one by one, many rebuild the tree
+		size_t edits = (round % 2) ? 3 : ref.size();
+
+		vector<pair<size_t, int>> inserts; // position, value, in the order buffered
+		vector<bool>              erased(ref.size(), false);
+		{
+			mkr::avl_array<int>::batch tx = a.begin_batch();
+			for (size_t e = 0; e < edits; ++e)
+			{
+				size_t k = rand() % (ref.size() + 1);
+				if (rand() % 2 || k == ref.size() || erased[k])
+				{
+					// also before an element erased in the same batch
+					tx.insert(a.begin() + k, next);
+					inserts.emplace_back(k, next++);
+				}
+				else
+				{
+					tx.erase(a.begin() + k);
+					erased[k] = true;
+				}
+			}
+			ok = check(tx.size() == edits, "batch size") && ok;
+
+			if (round % 3 == 1)
+				tx.abort();
+			if (round % 3 != 0)
+				continue; // aborted, or dropped without a commit
+			tx.commit();
+			ok = check(tx.empty(), "batch empty after commit") && ok;
+		}
+
+		vector<int> exp;
+		for (size_t k = 0; k <= ref.size(); ++k)
+		{
+			for (auto& ins : inserts)
+				if (ins.first == k)
+					exp.push_back(ins.second);
+			if (k < ref.size() && !erased[k])
+				exp.push_back(ref[k]);
+		}
+		ref.swap(exp);
+		if (!(a.size() == ref.size() && equal(a.begin(), a.end(), ref.begin())))
+			ok = check(false, "batch commit");
+	}
+
+	// whatever was aborted left the array as it was
+	ok = check(a.size() == ref.size() && equal(a.begin(), a.end(), ref.begin()), "batch abort") && ok;
+
+	cout << "avl_array batch: " << (ok ? "passed" : "FAILED") << endl;
+}
+
+void testsuit_npsv_queries()
+{
+	using namespace std;
+
+	srand(11);
+	const int n = 300;
+
+	npsv_array a;
+	for (int i = 0; i < n; ++i)
+		a.push_back(i);
+	int i = 0;
+	for (auto it = a.begin(); it != a.end(); ++it, ++i)
+		a.npsv_set_width(it, rand() % 4, i % 2); // zero widths, and sums left out of date
+
+	const npsv_array& ca = a;
+	bool              ok = true;
+	for (int round = 0; round < 20; ++round)
+	{
+		// sorted, with repeats, both ends and past the end
+		vector<int> pos = {0, a.npsv_width(), a.npsv_width() + 2};
+		for (int k = 0; k < 50; ++k)
+			pos.push_back(rand() % (a.npsv_width() + 1));
+		sort(pos.begin(), pos.end());
+
+		vector<npsv_array::iterator>       got;
+		vector<npsv_array::const_iterator> cgot;
+		a.npsv_at_pos_range(pos.begin(), pos.end(), back_inserter(got));
+		ca.npsv_at_pos_range(pos.begin(), pos.end(), back_inserter(cgot));
+
+		auto cur  = a.npsv_cursor(pos.front());
+		auto ccur = ca.npsv_cursor(pos.front());
+		for (size_t k = 0; k < pos.size(); ++k)
+		{
+			auto want = a.npsv_at_pos(pos[k]);
+			if (got[k] != want || cgot[k] != ca.npsv_at_pos(pos[k]))
+				ok = check(false, "npsv_at_pos_range");
+			if (cur.seek(pos[k]) != want || ccur.seek(pos[k]) != ca.npsv_at_pos(pos[k]))
+				ok = check(false, "npsv cursor seek");
+			if (want != a.end() && cur.start() != a.npsv_pos_of(want))
+				ok = check(false, "npsv cursor start");
+		}
+
+		// next() walks the elements one by one from wherever seek() left it
+		auto walk = a.npsv_cursor(pos[pos.size() / 2]);
+		for (auto it = walk.current(); it != a.end(); it = walk.next())
+			if (walk.start() != a.npsv_pos_of(it))
+				ok = check(false, "npsv cursor next");
+
+		auto it = a.begin() + rand() % a.size();
+		a.npsv_set_width(it, rand() % 4, round % 2);
+	}
+
+	cout << "npsv queries: " << (ok ? "passed" : "FAILED") << endl;
+}
+
+void testsuit_pool_splice()
+{
+	using namespace std;
+
+	bool ok = true;
+
+	// nodes spliced out of a list that dies stay in a pool that lives on
+	pooled_splice_list<int> a;
+	vector<int>             ref;
+	for (int round = 0; round < 20; ++round)
+	{
+		pooled_splice_list<int> b;
+		ok = check(a.get_allocator() == b.get_allocator(), "default pools") && ok;
+		for (int i = 0; i < 50; ++i)
+		{
+			b.push_back(round * 100 + i);
+			ref.push_back(round * 100 + i);
+		}
+		if (round % 2)
+			a.splice(a.end(), b);
+		else
+			a.merge(b);
+		b.push_back(-1);
+	}
+	vector<int> got(a.begin(), a.end());
+	ok = check(got == ref && a.size() == ref.size(), "pool splice") && ok;
+
+	cout << "pool splice: " << (ok ? "passed" : "FAILED") << endl;
+}
+
+// the iterators say random access, but only step
+template<typename It>
+static It debug_nth(It it, std::size_t n)
+{
+	while (n--)
+		++it;
+	return it;
+}
+
+// iterators to elements that stay must stay usable after erase, whatever the checking
+template<typename Checking>
+static bool debug_iterators_survive()
+{
+	typedef debug_container<int, std::allocator<int>, Checking> C;
+
+	bool ok = true;
+	C    c;
+	for (int i = 0; i < 100; ++i)
+		c.push_back(i);
+	// a few fresh ones per element, so that some of them are checked
+	std::vector<std::vector<typename C::iterator>> its(c.size());
+	for (std::size_t i = 0; i < its.size(); ++i)
+		for (int k = 0; k < 6; ++k)
+			its[i].push_back(debug_nth(c.begin(), i));
+
+	// the even ones go through their own iterators, and the ones after them
+	for (std::size_t i = 0; i < its.size(); i += 2)
+		ok = *c.erase(its[i][0]) == (int)i + 1 && ok;
+	for (std::size_t i = 1; i < its.size(); i += 2)
+		for (auto it : its[i])
+			ok = *it == (int)i && *--++it == (int)i && ok;
+	ok = c.size() == 50 && ok;
+	its.clear();
+
+	// an erased element is destroyed at once, even with an iterator still on it
+	typedef std::shared_ptr<int> sptr;
+	debug_container<sptr, std::allocator<sptr>, Checking> p;
+	sptr                                                  sp = std::make_shared<int>(1);
+	for (int i = 0; i < 8; ++i)
+		p.push_back(sp);
+	std::vector<decltype(p.begin())> pits;
+	for (int k = 0; k < 6; ++k)
+		pits.push_back(debug_nth(p.begin(), 3));
+	p.erase(pits[0]);
+	ok = sp.use_count() == 8 && p.size() == 7 && ok;
+
+	// iterators that outlive their container, on erased elements and on live ones
+	auto*                             d = new C(c);
+	std::vector<typename C::iterator> left;
+	for (int k = 0; k < 6; ++k)
+	{
+		left.push_back(d->begin());
+		left.push_back(debug_nth(d->begin(), 5));
+	}
+	d->erase(left[0]);
+	delete d;
+	return ok;
+}
+
+void testsuit_debug_iterators()
+{
+	using namespace std;
+
+	bool ok = check(debug_iterators_survive<full_checking>(), "full checking");
+	ok      = check(debug_iterators_survive<sampled_checking<2>>(), "sampled checking") && ok;
+	ok      = check(debug_iterators_survive<sampled_checking<3>>(), "sampled checking") && ok;
+
+	cout << "debug iterators: " << (ok ? "passed" : "FAILED") << endl;
+}
+
+template<typename L>
+static std::vector<int> unrolled_values(const L& l)
+{
+	std::vector<int> v;
+	for (auto&& x : l)
+		v.push_back(x.first);
+	return v;
+}
+
+void testsuit_unrolled_list()
+{
+	using namespace std;
+	typedef pair<int, int> keyed;
+	typedef unrolled_splice_list<keyed, 8> ulist;
+
+	bool ok  = true;
+	auto key = [](const keyed& a, const keyed& b) { return a.first < b.first; };
+
+	// range erases anywhere, against a vector
+	ulist         u;
+	vector<keyed> ref;
+	for (int i = 0; i < 2000; ++i)
+	{
+		u.push_back(keyed(i, i));
+		ref.push_back(keyed(i, i));
+	}
+	while (ref.size() > 10)
+	{
+		size_t b = rand() % ref.size();
+		size_t e = b + rand() % min<size_t>(ref.size() - b, 20) + 1;
+		auto   r = u.erase(u.nth(b), u.nth(e));
+		ref.erase(ref.begin() + b, ref.begin() + e);
+		if (r != u.nth(b))
+			ok = check(false, "range erase result");
+	}
+	ok = check(u.integrity() && vector<keyed>(u.begin(), u.end()) == ref, "range erase") && ok;
+
+	// sort keeps equal keys in order
+	ulist s;
+	for (int i = 0; i < 5000; ++i)
+		s.push_back(keyed(rand() % 16, i));
+	vector<keyed> want(s.begin(), s.end());
+	stable_sort(want.begin(), want.end(), key);
+	s.sort(key);
+	ok = check(s.integrity() && vector<keyed>(s.begin(), s.end()) == want, "stable sort") && ok;
+
+	// a comparison that throws leaves every element in place, in some order
+	for (int at : {1, 100, 3000, 20000})
+	{
+		ulist t;
+		for (int i = 0; i < 1000; ++i)
+			t.push_back(keyed(rand() % 100, i));
+		vector<int> all = unrolled_values(t);
+		int         n   = 0;
+		try
+		{
+			t.sort([&](const keyed& a, const keyed& b) {
+				if (++n == at)
+					throw n;
+				return a.first < b.first;
+			});
+		}
+		catch (int)
+		{
+		}
+		vector<int> got = unrolled_values(t);
+		std::sort(all.begin(), all.end());
+		std::sort(got.begin(), got.end());
+		ok = check(t.integrity() && got == all, "sort exception") && ok;
+	}
+
+	// and in merge, the elements stay split between the two lists
+	for (int at : {1, 50, 150})
+	{
+		ulist a, b;
+		for (int i = 0; i < 100; ++i)
+		{
+			a.push_back(keyed(2 * i, i));
+			b.push_back(keyed(2 * i + 1, i));
+		}
+		vector<int> all = unrolled_values(a);
+		for (int x : unrolled_values(b))
+			all.push_back(x);
+		int n = 0;
+		try
+		{
+			a.merge(b, [&](const keyed& x, const keyed& y) {
+				if (++n == at)
+					throw n;
+				return x.first < y.first;
+			});
+		}
+		catch (int)
+		{
+		}
+		vector<int> got = unrolled_values(a);
+		for (int x : unrolled_values(b))
+			got.push_back(x);
+		std::sort(all.begin(), all.end());
+		std::sort(got.begin(), got.end());
+		ok = check(a.integrity() && b.integrity() && got == all, "merge exception") && ok;
+		ok = check(is_sorted(a.begin(), a.end(), key), "merge exception order") && ok;
+	}
+
+	cout << "unrolled list: " << (ok ? "passed" : "FAILED") << endl;
 }
@@ -0,0 +1,1227 @@
+
+#pragma once
+
+// -------------------------------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// -------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// splice_list whose nodes (chunks) hold up to K elements each, so a scan takes one
+/// cache miss per chunk instead of one per element.
+/// insert and erase at an iterator only touch one chunk (split when full, merged with
+/// a neighbour when it gets small), whole list splice is O(1) and range splice is
+/// chunk granular: O(K) at the ends, the chunks in between are only relinked.
+/// elements move between slots, so unlike splice_list, insert, erase and splice
+/// invalidate iterators and references into the chunks they touch
+/// </summary>
+template<typename T, std::size_t K = 16>
+class unrolled_splice_list
+{
+	static_assert(K >= 2, "chunks must hold at least two elements");
+
+	struct ChunkHead
+	{
+		ChunkHead*  prev;
+		ChunkHead*  next;
+		std::size_t n;
+	};
+	struct Chunk : ChunkHead
+	{
+		union {
+			T data[K];
+		};
+		Chunk() {}
+		~Chunk() {}
+	};
+	typedef ChunkHead* HeadP;
+	typedef Chunk*     ChunkP;
+
+public:
+	typedef T              value_type;
+	typedef T&             reference;
+	typedef T*             pointer;
+	typedef const T&       const_reference;
+	typedef const T*       const_pointer;
+	typedef std::size_t    size_type;
+	typedef std::ptrdiff_t difference_type;
+	struct iterator;
+	struct const_iterator;
+
+	constexpr static std::size_t chunk_size = K;
+
+	unrolled_splice_list();
+	unrolled_splice_list(const unrolled_splice_list&);
+	unrolled_splice_list(unrolled_splice_list&&);
+	unrolled_splice_list& operator=(const unrolled_splice_list&);
+	unrolled_splice_list& operator=(unrolled_splice_list&&) noexcept;
+	~unrolled_splice_list();
+
+	unrolled_splice_list(std::initializer_list<T> il);
+	unrolled_splice_list& operator=(std::initializer_list<T> il);
+
+	template<typename It, typename = typename std::iterator_traits<It>::iterator_category>
+	unrolled_splice_list(It b, It e);
+
+	unrolled_splice_list(std::size_t n, const T& val);
+
+	template<typename It, typename = typename std::iterator_traits<It>::iterator_category>
+	void assign(It b, It e);
+
+	void assign(std::size_t n, const T& val);
+	void assign(std::initializer_list<T> il);
+	void assign(const unrolled_splice_list& other);
+	void assign(unrolled_splice_list&& other);
+
+	void swap(unrolled_splice_list&) noexcept;
+	void swap(unrolled_splice_list&& other) noexcept;
+
+	void clear();
+
+	std::size_t size() const noexcept { return count; }
+	bool        empty() const noexcept { return count == 0; }
+
+	constexpr static std::size_t max_size() { return std::numeric_limits<std::size_t>::max(); }
+
+	void push_back(const T& t) { emplace(end(), t); }
+	void push_back(T&& t) { emplace(end(), std::move(t)); }
+	void push_front(const T& t) { emplace(begin(), t); }
+	void push_front(T&& t) { emplace(begin(), std::move(t)); }
+	void pop_back() { erase(std::prev(end())); }
+	void pop_front() { erase(begin()); }
+
+	template<typename... Args>
+	void emplace_back(Args&&... args)
+	{
+		emplace(end(), std::forward<Args>(args)...);
+	}
+	template<typename... Args>
+	void emplace_front(Args&&... args)
+	{
+		emplace(begin(), std::forward<Args>(args)...);
+	}
+
+	struct iterator : std::iterator<std::bidirectional_iterator_tag, T>
+	{
+		iterator() = default;
+		iterator& operator++()
+		{
+			if (++idx == chunk->n)
+			{
+				chunk = chunk->next;
+				idx   = 0;
+			}
+			return *this;
+		}
+		iterator& operator--()
+		{
+			if (idx == 0)
+			{
+				chunk = chunk->prev;
+				idx   = chunk->n;
+			}
+			--idx;
+			return *this;
+		}
+		iterator operator++(int)
+		{
+			iterator tmp = *this;
+			++*this;
+			return tmp;
+		}
+		iterator operator--(int)
+		{
+			iterator tmp = *this;
+			--*this;
+			return tmp;
+		}
+		T&   operator*() const { return static_cast<ChunkP>(chunk)->data[idx]; }
+		T*   operator->() const { return std::addressof(static_cast<ChunkP>(chunk)->data[idx]); }
+		bool operator==(iterator rhs) const { return chunk == rhs.chunk && idx == rhs.idx; }
+		bool operator!=(iterator rhs) const { return chunk != rhs.chunk || idx != rhs.idx; }
+		friend class unrolled_splice_list;
+		friend struct const_iterator;
+
+	private:
+		iterator(HeadP c, std::size_t i) : chunk(c), idx(i) {}
+		HeadP       chunk = nullptr;
+		std::size_t idx   = 0;
+	};
+	struct const_iterator : std::iterator<std::bidirectional_iterator_tag, const T>
+	{
+		const_iterator() = default;
+		const_iterator(typename unrolled_splice_list::iterator other) : chunk(other.chunk), idx(other.idx) {}
+		const_iterator& operator++()
+		{
+			if (++idx == chunk->n)
+			{
+				chunk = chunk->next;
+				idx   = 0;
+			}
+			return *this;
+		}
+		const_iterator& operator--()
+		{
+			if (idx == 0)
+			{
+				chunk = chunk->prev;
+				idx   = chunk->n;
+			}
+			--idx;
+			return *this;
+		}
+		const_iterator operator++(int)
+		{
+			const_iterator tmp = *this;
+			++*this;
+			return tmp;
+		}
+		const_iterator operator--(int)
+		{
+			const_iterator tmp = *this;
+			--*this;
+			return tmp;
+		}
+		const T& operator*() const { return static_cast<ChunkP>(chunk)->data[idx]; }
+		const T* operator->() const { return std::addressof(static_cast<ChunkP>(chunk)->data[idx]); }
+		bool     operator==(const_iterator rhs) const { return chunk == rhs.chunk && idx == rhs.idx; }
+		bool     operator!=(const_iterator rhs) const { return chunk != rhs.chunk || idx != rhs.idx; }
+		friend class unrolled_splice_list;
+
+	private:
+		const_iterator(HeadP c, std::size_t i) : chunk(c), idx(i) {}
+		HeadP       chunk = nullptr;
+		std::size_t idx   = 0;
+	};
+
+	typedef std::reverse_iterator<iterator>       reverse_iterator;
+	typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+	iterator               begin() { return {sentinel->next, 0}; }
+	iterator               end() { return {sentinel, 0}; }
+	const_iterator         begin() const { return {sentinel->next, 0}; }
+	const_iterator         end() const { return {sentinel, 0}; }
+	const_iterator         cbegin() const { return {sentinel->next, 0}; }
+	const_iterator         cend() const { return {sentinel, 0}; }
+	reverse_iterator       rbegin() { return reverse_iterator{end()}; }
+	reverse_iterator       rend() { return reverse_iterator{begin()}; }
+	const_reverse_iterator rbegin() const { return const_reverse_iterator{end()}; }
+	const_reverse_iterator rend() const { return const_reverse_iterator{begin()}; }
+	const_reverse_iterator crbegin() const { return const_reverse_iterator{end()}; }
+	const_reverse_iterator crend() const { return const_reverse_iterator{begin()}; }
+
+	// skips whole chunks, O(n/K)
+	iterator nth(std::size_t idx);
+
+	iterator insert(iterator itr, const T& t) { return emplace(itr, t); }
+	iterator insert(iterator itr, T&& t) { return emplace(itr, std::move(t)); }
+	template<typename It>
+	iterator insert(iterator itr, It b, It e)
+	{
+		if (b == e)
+			return itr;
+		while (true)
+		{
+			itr = insert(itr, *b);
+			++b;
+			if (b == e)
+				break;
+			++itr;
+		}
+		return itr;
+	}
+	template<typename... Args>
+	iterator emplace(iterator, Args&&... args);
+	iterator erase(iterator);
+	iterator erase(iterator, iterator);
+
+	void splice(iterator pos, unrolled_splice_list& other);
+	void splice(iterator pos, unrolled_splice_list&& other) { splice(pos, other); }
+
+	// pos, it, first and last all in this list
+	void splice(iterator pos, iterator it) { splice(pos, it, std::next(it)); }
+	void splice(iterator pos, iterator first, iterator last);
+
+	void splice(iterator pos, unrolled_splice_list& other, iterator it);
+	void splice(iterator pos, unrolled_splice_list&& other, iterator it) { splice(pos, other, it); }
+
+	// between lists, the chunks in [first,last) are walked to count the elements, O(n/K)
+	void splice(iterator pos, unrolled_splice_list& other, iterator first, iterator last);
+	void splice(iterator pos, unrolled_splice_list&& other, iterator first, iterator last)
+	{
+		splice(pos, other, first, last);
+	}
+
+	// n must be std::distance(first,last)
+	void splice(iterator pos, unrolled_splice_list& other, iterator first, iterator last, std::size_t n);
+	void splice(iterator pos, unrolled_splice_list&& other, iterator first, iterator last, std::size_t n)
+	{
+		splice(pos, other, first, last, n);
+	}
+
+	// default sort is stable
+	void sort() { sort(std::less<T>{}); }
+	template<typename Op>
+	void sort(Op op);
+
+	void merge(unrolled_splice_list& other) { merge(other, std::less<T>{}); }
+	void merge(unrolled_splice_list&& other) { merge(other); }
+	template<typename Op>
+	void merge(unrolled_splice_list& other, Op op);
+	template<typename Op>
+	void merge(unrolled_splice_list&& other, Op op)
+	{
+		merge(other, op);
+	}
+
+	void unique() { unique(std::equal_to<T>{}); }
+	template<class Eq>
+	void unique(Eq eq);
+
+	void reverse();
+
+	void remove(const T& val);
+	template<typename Pred>
+	Pred remove_if(Pred pred);
+
+	// links, chunk fill and element count are consistent
+	bool integrity() const;
+
+	template<typename Stream>
+	friend Stream& operator<<(Stream& out, const unrolled_splice_list& lst)
+	{
+		out << "[";
+		bool first = true;
+		for (auto&& x : lst)
+		{
+			if (!first)
+				out << ", ";
+			out << x;
+			first = false;
+		}
+		out << "]";
+		return out;
+	}
+
+	int compare(const unrolled_splice_list& other) const;
+
+	bool operator==(const unrolled_splice_list& other) const;
+	bool operator!=(const unrolled_splice_list& other) const;
+	bool operator<(const unrolled_splice_list& other) const;
+	bool operator<=(const unrolled_splice_list& other) const;
+	bool operator>(const unrolled_splice_list& other) const;
+	bool operator>=(const unrolled_splice_list& other) const;
+
+private:
+	template<typename It, typename = typename std::iterator_traits<It>::iterator_category>
+	void helper_assign(It b, It e);
+
+	void helper_assign(std::size_t n, const T& val);
+
+	static T* data(HeadP c) { return static_cast<ChunkP>(c)->data; }
+
+	// move construct into dst, destroy src
+	static void relocate(T* dst, T* src);
+
+	static ChunkP helper_makechunk();
+	static void   helper_freechunk(HeadP);
+
+	iterator helper_normalize(HeadP, std::size_t) const;
+
+	iterator helper_make_gap(iterator);
+	void     helper_close_gap(iterator);
+	template<typename... Args>
+	iterator helper_emplace(iterator, Args&&...);
+
+	static HeadP helper_split(HeadP, std::size_t);
+	static void  helper_adjust(iterator&, HeadP, std::size_t, HeadP);
+	bool         helper_try_merge(HeadP);
+	void         helper_merge_seams(HeadP*, int);
+
+	static std::size_t helper_count(HeadP, HeadP);
+
+	void helper_unlink(HeadP c) { link(c->prev, c->next); }
+
+	HeadP       sentinel;
+	std::size_t count = 0;
+	static void link(HeadP, HeadP);
+};
+
+// -------------------------------------------------------------------------------------------------------------
+
+template<typename T, std::size_t K>
+unrolled_splice_list<T, K>::unrolled_splice_list(std::initializer_list<T> il)
+	: unrolled_splice_list(il.begin(), il.end())
+{
+}
+
+template<typename T, std::size_t K>
+auto unrolled_splice_list<T, K>::operator=(std::initializer_list<T> il) -> unrolled_splice_list&
+{
+	assign(il.begin(), il.end());
+	return *this;
+}
+
+template<typename T, std::size_t K>
+void unrolled_splice_list<T, K>::assign(std::initializer_list<T> il)
+{
+	assign(il.begin(), il.end());
+}
+
+template<typename T, std::size_t K>
+unrolled_splice_list<T, K>::unrolled_splice_list()
+{
+	sentinel    = new ChunkHead;
+	sentinel->n = 0;
+	link(sentinel, sentinel);
+}
+
+template<typename T, std::size_t K>
+unrolled_splice_list<T, K>::unrolled_splice_list(const unrolled_splice_list& other) : unrolled_splice_list()
+{
+	helper_assign(other.begin(), other.end());
+}
+
+template<typename T, std::size_t K>
+unrolled_splice_list<T, K>::unrolled_splice_list(unrolled_splice_list&& other) : unrolled_splice_list()
+{
+	swap(other);
+}
+
+template<typename T, std::size_t K>
+auto unrolled_splice_list<T, K>::operator=(const unrolled_splice_list& other) -> unrolled_splice_list&
+{
+	if (this != &other)
+		assign(other);
+	return *this;
+}
+
+template<typename T, std::size_t K>
+auto unrolled_splice_list<T, K>::operator=(unrolled_splice_list&& other) noexcept -> unrolled_splice_list&
+{
+	swap(other);
+	return *this;
+}
+
+template<typename T, std::size_t K>
+unrolled_splice_list<T, K>::~unrolled_splice_list()
+{
+	clear();
+	delete sentinel;
+}
+
+template<typename T, std::size_t K>
+template<typename It, typename>
+unrolled_splice_list<T, K>::unrolled_splice_list(It b, It e) : unrolled_splice_list()
+{
+	helper_assign(b, e);
+}
+
+template<typename T, std::size_t K>
+unrolled_splice_list<T, K>::unrolled_splice_list(std::size_t n, const T& val) : unrolled_splice_list()
+{
+	helper_assign(n, val);
+}
+
+template<typename T, std::size_t K>
+template<typename It, typename>
+void unrolled_splice_list<T, K>::helper_assign(It b, It e)
+{
+	while (b != e)
+	{
+		push_back(*b);
+		++b;
+	}
+}
+
+template<typename T, std::size_t K>
+void unrolled_splice_list<T, K>::helper_assign(std::size_t n, const T& val)
+{
+	while (n--)
+		push_back(val);
+}
+
+template<typename T, std::size_t K>
+template<typename It, typename>
+void unrolled_splice_list<T, K>::assign(It b, It e)
+{
+	clear();
+	helper_assign(b, e);
+}
+
+template<typename T, std::size_t K>
+void unrolled_splice_list<T, K>::assign(std::size_t n, const T& val)
+{
+	clear();
+	helper_assign(n, val);
+}
+
+template<typename T, std::size_t K>
+void unrolled_splice_list<T, K>::assign(const unrolled_splice_list& other)
+{
+	assign(other.begin(), other.end());
+}
+
+template<typename T, std::size_t K>
+void unrolled_splice_list<T, K>::assign(unrolled_splice_list&& other)
+{
+	swap(other);
+}
+
+template<typename T, std::size_t K>
+void unrolled_splice_list<T, K>::swap(unrolled_splice_list& other) noexcept
+{
+	using std::swap;
+	swap(sentinel, other.sentinel);
+	swap(count, other.count);
+}
+
+template<typename T, std::size_t K>
+void unrolled_splice_list<T, K>::swap(unrolled_splice_list&& other) noexcept
+{
+	swap(other);
+}
+
+template<typename T, std::size_t K>
+void unrolled_splice_list<T, K>::clear()
+{
+	HeadP c = sentinel->next;
+	while (c != sentinel)
+	{
+		HeadP nx = c->next;
+		helper_freechunk(c);
+		c = nx;
+	}
+	link(sentinel, sentinel);
+	count = 0;
+}
+
+template<typename T, std::size_t K>
+void unrolled_splice_list<T, K>::link(HeadP c1, HeadP c2)
+{
+	c1->next = c2;
+	c2->prev = c1;
+}
+
+template<typename T, std::size_t K>
+void unrolled_splice_list<T, K>::relocate(T* dst, T* src)
+{
+	::new ((void*)dst) T(std::move(*src));
+	src->~T();
+}
+
+template<typename T, std::size_t K>
+auto unrolled_splice_list<T, K>::helper_makechunk() -> ChunkP
+{
+	ChunkP c = new Chunk;
+	c->n     = 0;
+	return c;
+}
+
+template<typename T, std::size_t K>
+void unrolled_splice_list<T, K>::helper_freechunk(HeadP c)
+{
+	T* d = data(c);
+	for (std::size_t i = 0; i < c->n; ++i)
+		d[i].~T();
+	delete static_cast<ChunkP>(c);
+}
+
+/// <summary>
+/// iterator to slot i of chunk c, where i == c->n means the start of the next chunk
+/// </summary>
+template<typename T, std::size_t K>
+auto unrolled_splice_list<T, K>::helper_normalize(HeadP c, std::size_t i) const -> iterator
+{
+	if (c != sentinel && i == c->n)
+		return {c->next, 0};
+	return {c, i};
+}
+
+template<typename T, std::size_t K>
+auto unrolled_splice_list<T, K>::nth(std::size_t idx) -> iterator
+{
+	HeadP c = sentinel->next;
+	while (c != sentinel && idx >= c->n)
+	{
+		idx -= c->n;
+		c = c->next;
+	}
+	return {c, (c == sentinel) ? 0 : idx};
+}
+
+/// <summary>
+/// open an unconstructed slot just before where, and return it.
+/// at the start of a chunk, the previous chunk is appended to if it has room.
+/// a full chunk is split in two halves first
+/// </summary>
+template<typename T, std::size_t K>
+auto unrolled_splice_list<T, K>::helper_make_gap(iterator where) -> iterator
+{
+	HeadP       c = where.chunk;
+	std::size_t i = where.idx;
+
+	if (i == 0 && c->prev != sentinel && c->prev->n < K)
+	{
+		c = c->prev;
+		return {c, c->n++};
+	}
+	if (c == sentinel)
+	{
+		HeadP nc = helper_makechunk();
+		link(sentinel->prev, nc);
+		link(nc, sentinel);
+		nc->n = 1;
+		return {nc, 0};
+	}
+	if (c->n == K)
+	{
+		HeadP nc = helper_split(c, K / 2);
+		if (i > K / 2)
+		{
+			c = nc;
+			i -= K / 2;
+		}
+	}
+	T* d = data(c);
+	for (std::size_t j = c->n; j > i; --j)
+		relocate(d + j, d + j - 1);
+	++c->n;
+	return {c, i};
+}
+
+/// <summary>
+/// undo helper_make_gap, when constructing into the slot threw
+/// </summary>
+template<typename T, std::size_t K>
+void unrolled_splice_list<T, K>::helper_close_gap(iterator slot)
+{
+	HeadP c = slot.chunk;
+	T*    d = data(c);
+	for (std::size_t j = slot.idx; j + 1 < c->n; ++j)
+		relocate(d + j, d + j + 1);
+	if (--c->n == 0)
+	{
+		helper_unlink(c);
+		helper_freechunk(c);
+	}
+}
+
+template<typename T, std::size_t K>
+template<typename... Args>
+auto unrolled_splice_list<T, K>::emplace(iterator where, Args&&... args) -> iterator
+{
+	// appending moves nothing, otherwise args may refer to an element the gap moves
+	if (where == end())
+		return helper_emplace(where, std::forward<Args>(args)...);
+	T tmp(std::forward<Args>(args)...);
+	return helper_emplace(where, std::move(tmp));
+}
+
+/// <summary>
+/// construct an element from args in a gap opened before where
+/// </summary>
+template<typename T, std::size_t K>
+template<typename... Args>
+auto unrolled_splice_list<T, K>::helper_emplace(iterator where, Args&&... args) -> iterator
+{
+	iterator slot = helper_make_gap(where);
+	try
+	{
+		::new ((void*)std::addressof(*slot)) T(std::forward<Args>(args)...);
+	}
+	catch (...)
+	{
+		helper_close_gap(slot);
+		throw;
+	}
+	++count;
+	return slot;
+}
+
+template<typename T, std::size_t K>
+auto unrolled_splice_list<T, K>::erase(iterator what) -> iterator
+{
+	HeadP       c = what.chunk;
+	std::size_t i = what.idx;
+	T*          d = data(c);
+
+	d[i].~T();
+	for (std::size_t j = i; j + 1 < c->n; ++j)
+		relocate(d + j, d + j + 1);
+	--c->n;
+	--count;
+
+	if (c->n == 0)
+	{
+		HeadP nx = c->next;
+		helper_unlink(c);
+		helper_freechunk(c);
+		return {nx, 0};
+	}
+	if (c->n <= K / 4 && !helper_try_merge(c))
+	{
+		HeadP       p  = c->prev;
+		std::size_t pn = p->n;
+		if (helper_try_merge(p))
+		{
+			c = p;
+			i += pn;
+		}
+	}
+	return helper_normalize(c, i);
+}
+
+template<typename T, std::size_t K>
+auto unrolled_splice_list<T, K>::erase(iterator b, iterator e) -> iterator
+{
+	if (b == e)
+		return e;
+
+	HeadP       c = b.chunk;
+	std::size_t i = b.idx;
+	while (c != e.chunk)
+	{
+		T* d = data(c);
+		for (std::size_t j = i; j < c->n; ++j)
+			d[j].~T();
+		count -= c->n - i;
+		c->n = i;
+		HeadP nx = c->next;
+		if (i == 0)
+		{
+			helper_unlink(c);
+			helper_freechunk(c);
+		}
+		c = nx;
+		i = 0;
+	}
+	if (i < e.idx)
+	{
+		T*          d = data(c);
+		std::size_t k = e.idx - i;
+		for (std::size_t j = i; j < e.idx; ++j)
+			d[j].~T();
+		for (std::size_t j = e.idx; j < c->n; ++j)
+			relocate(d + j - k, d + j);
+		c->n -= k;
+		count -= k;
+		if (c->n == 0)
+		{
+			HeadP nx = c->next;
+			helper_unlink(c);
+			helper_freechunk(c);
+			c = nx;
+		}
+	}
+
+	// the chunks on both sides of the gap may be left small, merged as in single erase
+	HeadP p = c->prev;
+	if (p != sentinel && p->n <= K / 4)
+	{
+		std::size_t pn = p->n;
+		if (helper_try_merge(p))
+		{
+			c = p;
+			i += pn;
+		}
+	}
+	if (c != sentinel && c->n <= K / 4 && !helper_try_merge(c))
+	{
+		p              = c->prev;
+		std::size_t pn = p->n;
+		if (helper_try_merge(p))
+		{
+			c = p;
+			i += pn;
+		}
+	}
+	return helper_normalize(c, i);
+}
+
+/// <summary>
+/// make position (c,i) the start of a chunk, moving [i,n) to a new chunk after c.
+/// returns the chunk starting there
+/// </summary>
+template<typename T, std::size_t K>
+auto unrolled_splice_list<T, K>::helper_split(HeadP c, std::size_t i) -> HeadP
+{
+	if (i == 0)
+		return c;
+	HeadP nc = helper_makechunk();
+	T*    d  = data(c);
+	T*    nd = data(nc);
+	for (std::size_t j = i; j < c->n; ++j)
+		relocate(nd + j - i, d + j);
+	nc->n = c->n - i;
+	c->n  = i;
+	link(nc, c->next);
+	link(c, nc);
+	return nc;
+}
+
+/// <summary>
+/// fix an iterator after (c,i) was split off into chunk nc
+/// </summary>
+template<typename T, std::size_t K>
+void unrolled_splice_list<T, K>::helper_adjust(iterator& it, HeadP c, std::size_t i, HeadP nc)
+{
+	if (it.chunk == c && it.idx >= i)
+	{
+		it.chunk = nc;
+		it.idx -= i;
+	}
+}
+
+/// <summary>
+/// move the elements of c->next into c, when they fit
+/// </summary>
+template<typename T, std::size_t K>
+bool unrolled_splice_list<T, K>::helper_try_merge(HeadP c)
+{
+	HeadP nx = c->next;
+	if (c == sentinel || nx == sentinel || c->n + nx->n > K)
+		return false;
+	T* d  = data(c);
+	T* nd = data(nx);
+	for (std::size_t j = 0; j < nx->n; ++j)
+		relocate(d + c->n + j, nd + j);
+	c->n += nx->n;
+	nx->n = 0;
+	helper_unlink(nx);
+	helper_freechunk(nx);
+	return true;
+}
+
+/// <summary>
+/// after relinking, merge the small chunks left on both sides of each seam.
+/// a seam whose left chunk gets merged away moves to the chunk that absorbed it
+/// </summary>
+template<typename T, std::size_t K>
+void unrolled_splice_list<T, K>::helper_merge_seams(HeadP* seams, int n)
+{
+	for (int k = 0; k < n; ++k)
+	{
+		HeadP c  = seams[k];
+		HeadP nx = c->next;
+		if (c == sentinel || nx == sentinel || c->n + nx->n > K)
+			continue;
+		for (int m = 0; m < n; ++m)
+			if (seams[m] == nx)
+				seams[m] = c;
+		helper_try_merge(c);
+	}
+}
+
+template<typename T, std::size_t K>
+std::size_t unrolled_splice_list<T, K>::helper_count(HeadP f, HeadP l)
+{
+	std::size_t n = 0;
+	for (; f != l; f = f->next)
+		n += f->n;
+	return n;
+}
+
+template<typename T, std::size_t K>
+void unrolled_splice_list<T, K>::splice(iterator pos, unrolled_splice_list& other)
+{
+	if (other.empty())
+		return;
+	HeadP p = helper_split(pos.chunk, pos.idx);
+	HeadP a = p->prev;
+	HeadP f = other.sentinel->next;
+	HeadP l = other.sentinel->prev;
+	link(a, f);
+	link(l, p);
+	link(other.sentinel, other.sentinel);
+	count += other.count;
+	other.count = 0;
+
+	HeadP seams[] = {a, l};
+	helper_merge_seams(seams, 2);
+}
+
+template<typename T, std::size_t K>
+void unrolled_splice_list<T, K>::splice(iterator pos, iterator first, iterator last)
+{
+	splice(pos, *this, first, last, 0);
+}
+
+template<typename T, std::size_t K>
+void unrolled_splice_list<T, K>::splice(iterator pos, unrolled_splice_list& other, iterator it)
+{
+	splice(pos, other, it, std::next(it), 1);
+}
+
+template<typename T, std::size_t K>
+void unrolled_splice_list<T, K>::splice(iterator pos, unrolled_splice_list& other, iterator first, iterator last)
+{
+	if (first == last)
+		return;
+	if (&other == this)
+		return splice(pos, *this, first, last, 0);
+	HeadP fc = first.chunk;
+	// count whole chunks, then correct for the partial ones at both ends
+	std::size_t n = helper_count(fc, last.chunk) - first.idx + last.idx;
+	splice(pos, other, first, last, n);
+}
+
+/// <summary>
+/// split at first, last and pos (fixing the iterators that pointed past each split),
+/// relink the chunks of [first,last) before pos, then merge small chunks at the seams
+/// </summary>
+template<typename T, std::size_t K>
+void unrolled_splice_list<T, K>::splice(iterator pos, unrolled_splice_list& other, iterator first, iterator last, std::size_t n)
+{
+	if (first == last || pos == first || pos == last)
+		return;
+
+	HeadP f = helper_split(first.chunk, first.idx);
+	helper_adjust(last, first.chunk, first.idx, f);
+	helper_adjust(pos, first.chunk, first.idx, f);
+	HeadP l = helper_split(last.chunk, last.idx);
+	helper_adjust(pos, last.chunk, last.idx, l);
+	HeadP p = helper_split(pos.chunk, pos.idx);
+
+	HeadP s  = f->prev;
+	HeadP lc = l->prev;
+	HeadP a  = p->prev;
+	if (p == l)
+	{
+		HeadP seams[] = {s, lc};
+		other.helper_merge_seams(seams, 2);
+		return;
+	}
+	link(s, l);
+	link(a, f);
+	link(lc, p);
+
+	if (&other == this)
+	{
+		HeadP seams[] = {a, lc, s};
+		helper_merge_seams(seams, 3);
+		return;
+	}
+	count += n;
+	other.count -= n;
+
+	HeadP seams[] = {a, lc};
+	helper_merge_seams(seams, 2);
+	HeadP src[] = {s};
+	other.helper_merge_seams(src, 1);
+}
+
+/// <summary>
+/// stable: each chunk is insertion sorted in place, then the chunks are merged as runs,
+/// bottom up through bins of doubling length as std::list does, with merge reusing the
+/// chunks. if op throws, every element is still in the list, in some order
+/// </summary>
+template<typename T, std::size_t K>
+template<typename Op>
+void unrolled_splice_list<T, K>::sort(Op op)
+{
+	if (count < 2)
+		return;
+
+	std::size_t chunks = 0;
+	for (HeadP c = sentinel->next; c != sentinel; c = c->next, ++chunks)
+	{
+		T* d = data(c);
+		for (std::size_t j = 1; j < c->n; ++j)
+			std::rotate(std::upper_bound(d, d + j, d[j], op), d + j, d + j + 1);
+	}
+	if (chunks == 1)
+		return;
+
+	std::size_t nbins = 1;
+	for (std::size_t n = chunks; n > 1; n >>= 1)
+		++nbins;
+	unrolled_splice_list              carry;
+	std::vector<unrolled_splice_list> bins(nbins);
+	std::size_t                       fill = 0;
+	try
+	{
+		while (!empty())
+		{
+			HeadP c = sentinel->next;
+			carry.splice(carry.end(), *this, begin(), iterator{c->next, 0}, c->n);
+			std::size_t k = 0;
+			for (; k < fill && !bins[k].empty(); ++k)
+			{
+				bins[k].merge(carry, op);
+				carry.swap(bins[k]);
+			}
+			carry.swap(bins[k]);
+			if (k == fill)
+				++fill;
+		}
+		for (std::size_t k = 1; k < fill; ++k)
+			bins[k].merge(bins[k - 1], op);
+		swap(bins[fill - 1]);
+	}
+	catch (...)
+	{
+		for (auto& b : bins)
+			splice(end(), b);
+		splice(end(), carry);
+		throw;
+	}
+}
+
+/// <summary>
+/// stable merge into full chunks. chunks are freed as they are used up, and reused
+/// for the output, the chunks left over in the tail of either list are only relinked.
+/// if op throws, the merged part and the rest of this stay here, the rest of other there
+/// </summary>
+template<typename T, std::size_t K>
+template<typename Op>
+void unrolled_splice_list<T, K>::merge(unrolled_splice_list& other, Op op)
+{
+	if (other.empty() || this == &other)
+		return;
+	if (empty())
+		return swap(other);
+
+	HeadP       a  = sentinel->next;
+	HeadP       b  = other.sentinel->next;
+	std::size_t ia = 0, ib = 0;
+	ChunkHead   out;
+	HeadP       o     = &out;
+	HeadP       spare = nullptr;
+	link(o, o);
+	o->n = K;
+
+	auto take = [&](HeadP& c, std::size_t& i) {
+		if (o->n == K)
+		{
+			HeadP nc = spare;
+			if (nc)
+				spare = spare->next;
+			else
+				nc = helper_makechunk();
+			nc->n = 0;
+			link(o, nc);
+			o = nc;
+		}
+		relocate(data(o) + o->n++, data(c) + i);
+		if (++i == c->n)
+		{
+			HeadP nx = c->next;
+			c->n     = 0;
+			c->next  = spare;
+			spare    = c;
+			c        = nx;
+			i        = 0;
+		}
+	};
+	auto free_spare = [&]() {
+		while (spare)
+		{
+			HeadP nx = spare->next;
+			helper_freechunk(spare);
+			spare = nx;
+		}
+	};
+
+	try
+	{
+		while (a != sentinel && b != other.sentinel)
+		{
+			if (op(data(b)[ib], data(a)[ia]))
+				take(b, ib);
+			else
+				take(a, ia);
+		}
+		bool         left = a != sentinel;
+		HeadP&       rest = left ? a : b;
+		std::size_t& ir   = left ? ia : ib;
+		while (ir != 0)
+			take(rest, ir);
+	}
+	catch (...)
+	{
+		// close the holes left at the front of the chunks being taken from
+		auto compact = [&](HeadP c, std::size_t i, HeadP end) {
+			if (c == end || i == 0)
+				return;
+			T* d = data(c);
+			for (std::size_t j = i; j < c->n; ++j)
+				relocate(d + j - i, d + j);
+			c->n -= i;
+		};
+		compact(a, ia, sentinel);
+		compact(b, ib, other.sentinel);
+		link(o, a);
+		link(sentinel, out.next);
+		link(other.sentinel, b);
+		std::size_t n = count + other.count;
+		count         = helper_count(sentinel->next, sentinel);
+		other.count   = n - count;
+		free_spare();
+		throw;
+	}
+
+	HeadP rest = (a != sentinel) ? a : b;
+	HeadP rend = (a != sentinel) ? sentinel : other.sentinel;
+	if (rest != rend)
+	{
+		link(o, rest);
+		o = rend->prev;
+	}
+
+	link(sentinel, out.next);
+	link(o, sentinel);
+	link(other.sentinel, other.sentinel);
+	count += other.count;
+	other.count = 0;
+	free_spare();
+}
+
+template<typename T, std::size_t K>
+template<class Eq>
+void unrolled_splice_list<T, K>::unique(Eq eq)
+{
+	iterator i = begin();
+	if (i == end())
+		return;
+	iterator w = i;
+	for (++i; i != end(); ++i)
+	{
+		if (!eq(*i, *w))
+		{
+			++w;
+			if (w != i)
+				*w = std::move(*i);
+		}
+	}
+	erase(++w, end());
+}
+
+/// <summary>
+/// reverse the ring of chunks, and the elements inside each one
+/// </summary>
+template<typename T, std::size_t K>
+void unrolled_splice_list<T, K>::reverse()
+{
+	HeadP c = sentinel;
+	do
+	{
+		std::swap(c->prev, c->next);
+		if (c != sentinel)
+			std::reverse(data(c), data(c) + c->n);
+		c = c->prev;
+	} while (c != sentinel);
+}
+
+template<typename T, std::size_t K>
+void unrolled_splice_list<T, K>::remove(const T& val)
+{
+	remove_if([&val](const T& v) -> bool { return v == val; });
+}
+
+template<typename T, std::size_t K>
+template<typename Pred>
+Pred unrolled_splice_list<T, K>::remove_if(Pred pred)
+{
+	iterator w = begin();
+	for (iterator i = begin(); i != end(); ++i)
+	{
+		if (!pred(*i))
+		{
+			if (w != i)
+				*w = std::move(*i);
+			++w;
+		}
+	}
+	erase(w, end());
+	return pred;
+}
+
+template<typename T, std::size_t K>
+bool unrolled_splice_list<T, K>::integrity() const
+{
+	std::size_t n = 0;
+	HeadP       c = sentinel;
+	do
+	{
+		if (c->next->prev != c)
+			return false;
+		if (c != sentinel && (c->n == 0 || c->n > K))
+			return false;
+		n += c->n;
+		if (n > count)
+			return false;
+		c = c->next;
+	} while (c != sentinel);
+	return n == count && sentinel->n == 0;
+}
+
+template<typename T, std::size_t K>
+int unrolled_splice_list<T, K>::compare(const unrolled_splice_list& other) const
+{
+	auto me_iter = begin();
+	auto ot_iter = other.begin();
+	while (true)
+	{
+		bool me_ate = (me_iter == end());
+		bool ot_ate = (ot_iter == other.end());
+		if (me_ate && ot_ate)
+			return 0;
+		if (me_ate)
+			return -1;
+		if (ot_ate)
+			return +1;
+		if ((*me_iter) < (*ot_iter))
+			return -1;
+		if ((*ot_iter) < (*me_iter))
+			return +1;
+		++me_iter;
+		++ot_iter;
+	}
+}
+
+template<typename T, std::size_t K>
+bool unrolled_splice_list<T, K>::operator==(const unrolled_splice_list& other) const
+{
+	return compare(other) == 0;
+}
+
+template<typename T, std::size_t K>
+bool unrolled_splice_list<T, K>::operator!=(const unrolled_splice_list& other) const
+{
+	return compare(other) != 0;
+}
+
+template<typename T, std::size_t K>
+bool unrolled_splice_list<T, K>::operator<(const unrolled_splice_list& other) const
+{
+	return compare(other) < 0;
+}
+
+template<typename T, std::size_t K>
+bool unrolled_splice_list<T, K>::operator<=(const unrolled_splice_list& other) const
+{
+	return compare(other) <= 0;
+}
+
+template<typename T, std::size_t K>
+bool unrolled_splice_list<T, K>::operator>(const unrolled_splice_list& other) const
+{
+	return compare(other) > 0;
+}
+
+template<typename T, std::size_t K>
+bool unrolled_splice_list<T, K>::operator>=(const unrolled_splice_list& other) const
+{
+	return compare(other) >= 0;
+}